@@ -0,0 +1,184 @@
+#include "bench.hpp"
+
+#include "decode_stats.hpp"
+#include "simd.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+
+
+namespace
+{
+
+	const char* simd_name(fill::detail::SimdLevel level) noexcept
+	{
+		switch (level)
+		{
+		case fill::detail::SimdLevel::SSE2:
+			return "sse2";
+		case fill::detail::SimdLevel::SSSE3:
+			return "ssse3";
+		case fill::detail::SimdLevel::AVX2:
+			return "avx2";
+		default:
+			return "scalar";
+		}
+	}
+
+	void write_string(std::ostream& out, const std::string& text)
+	{
+		out << '"';
+
+		for (const char c : text)
+		{
+			if (c == '"' || c == '\\')
+				out << '\\' << c;
+			else if (static_cast<unsigned char>(c) < 0x20)
+			{
+				char escaped[8];
+				std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+				out << escaped;
+			}
+			else
+				out << c;
+		}
+
+		out << '"';
+	}
+
+	// Fixed notation, JSON has no inf or nan
+	void write_number(std::ostream& out, double value)
+	{
+		char number[32];
+		std::snprintf(number, sizeof(number), "%.3f", std::isfinite(value) ? value : 0.0);
+		out << number;
+	}
+
+}
+
+
+std::uint64_t fill::bench::Result::percentile(double p) const noexcept
+{
+	if (samples_ns.empty())
+		return 0;
+
+	const size_t rank{ static_cast<size_t>(std::ceil(p / 100.0 * static_cast<double>(samples_ns.size()))) };
+
+	return samples_ns[std::clamp<size_t>(rank, 1, samples_ns.size()) - 1];
+}
+
+double fill::bench::Result::mean() const noexcept
+{
+	if (samples_ns.empty())
+		return 0.0;
+
+	return static_cast<double>(std::accumulate(samples_ns.begin(), samples_ns.end(), std::uint64_t{})) / static_cast<double>(samples_ns.size());
+}
+
+double fill::bench::Result::megabytes_per_second() const noexcept
+{
+	const std::uint64_t median{ percentile(50) };
+
+	return median ? static_cast<double>(bytes) * 1e3 / static_cast<double>(median) : 0.0; /*bytes per ns * 1e9 / 1e6*/
+}
+
+double fill::bench::Result::megapixels_per_second() const noexcept
+{
+	const std::uint64_t median{ percentile(50) };
+
+	return median ? static_cast<double>(pixels) * 1e3 / static_cast<double>(median) : 0.0;
+}
+
+
+fill::bench::Suite::Suite(const Settings& settings)
+	: settings{ settings }
+{
+	this->settings.samples = std::max<size_t>(this->settings.samples, 1);
+}
+
+
+bool fill::bench::Suite::selected(const std::string& group, const std::string& name) const
+{
+	return settings.filter.empty() || (group + '/' + name).find(settings.filter) != std::string::npos;
+}
+
+fill::bench::Result& fill::bench::Suite::add(Result&& result)
+{
+	std::sort(result.samples_ns.begin(), result.samples_ns.end());
+	results.push_back(std::move(result));
+
+	return results.back();
+}
+
+
+void fill::bench::Suite::print(std::ostream& out, const Result& result) const
+{
+	char line[256];
+	std::snprintf(line, sizeof(line), "%-6s %-44s p50 %10.3f ms  p90 %10.3f ms  p99 %10.3f ms  %9.1f MB/s  %8.1f MP/s",
+		result.group.c_str(), result.name.c_str(),
+		static_cast<double>(result.percentile(50)) / 1e6, static_cast<double>(result.percentile(90)) / 1e6, static_cast<double>(result.percentile(99)) / 1e6,
+		result.megabytes_per_second(), result.megapixels_per_second());
+
+	out << line << '\n';
+
+	for (const auto& [key, value] : result.extra)
+	{
+		std::snprintf(line, sizeof(line), "         %-22s %14.3f", key.c_str(), value);
+		out << line << '\n';
+	}
+}
+
+void fill::bench::Suite::writeJSON(std::ostream& out) const
+{
+	const auto now{ std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count() };
+
+	out << "{\n";
+	out << "\t\"format\": 1,\n";
+	out << "\t\"timestamp\": " << now << ",\n";
+	out << "\t\"simd\": \"" << simd_name(fill::detail::detect_simd_level()) << "\",\n";
+	out << "\t\"decode_stats\": " << (fill::decode_stats_enabled ? "true" : "false") << ",\n";
+	out << "\t\"samples\": " << settings.samples << ",\n";
+	out << "\t\"results\": [";
+
+	for (size_t i{}; i < results.size(); i++)
+	{
+		const Result& result{ results[i] };
+
+		out << (i ? ",\n" : "\n") << "\t\t{ \"group\": ";
+		write_string(out, result.group);
+		out << ", \"name\": ";
+		write_string(out, result.name);
+		out << ", \"bytes\": " << result.bytes << ", \"pixels\": " << result.pixels;
+
+		out << ", \"ns\": { \"min\": " << result.percentile(0) << ", \"p50\": " << result.percentile(50) << ", \"p90\": " << result.percentile(90)
+			<< ", \"p99\": " << result.percentile(99) << ", \"max\": " << result.percentile(100) << ", \"mean\": ";
+		write_number(out, result.mean());
+		out << " }";
+
+		out << ", \"mb_per_s\": ";
+		write_number(out, result.megabytes_per_second());
+		out << ", \"mpix_per_s\": ";
+		write_number(out, result.megapixels_per_second());
+
+		if (!result.extra.empty())
+		{
+			out << ", \"extra\": {";
+
+			for (size_t e{}; e < result.extra.size(); e++)
+			{
+				out << (e ? ", " : " ");
+				write_string(out, result.extra[e].first);
+				out << ": ";
+				write_number(out, result.extra[e].second);
+			}
+
+			out << " }";
+		}
+
+		out << " }";
+	}
+
+	out << "\n\t]\n}\n";
+}
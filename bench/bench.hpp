@@ -0,0 +1,132 @@
+#pragma once // bench.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// This file contains the timing harness of FILL_bench.
+//	- Each benchmark is run a few times to warm up, then timed over a number of samples.
+//	- Short benchmarks are repeated within a sample until it lasts long enough for the clock, and the sample is the mean of those runs.
+//	- Results give percentiles of the samples, and MB/s and megapixels/s at the median.
+//	- Results can be written as JSON, to compare builds and versions.
+// ===================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace fill::bench
+{
+
+	struct Result
+	{
+		std::string group; /*micro (one stage) or macro (end to end)*/
+		std::string name;
+
+		size_t bytes{};  /*processed by one run, see each benchmark*/
+		size_t pixels{}; /*processed by one run*/
+
+		std::vector<std::uint64_t> samples_ns{}; /*sorted*/
+
+		std::vector<std::pair<std::string, double>> extra{}; /*benchmark specific figures, e.g. decode stages*/
+
+
+		// Nearest rank, p in [0, 100]
+		std::uint64_t percentile(double p) const noexcept;
+
+		double mean() const noexcept;
+
+		double megabytes_per_second() const noexcept;
+		double megapixels_per_second() const noexcept;
+	};
+
+	struct Settings
+	{
+		size_t samples{ 15 };
+		size_t warmup{ 2 };
+
+		std::chrono::nanoseconds min_sample{ std::chrono::milliseconds{ 2 } }; /*shorter runs are repeated within a sample*/
+
+		std::string filter{}; /*only benchmarks whose group/name contains it are run*/
+	};
+
+
+	// Written by benchmarks so their work can't be optimized away
+	inline volatile std::uint64_t sink{};
+
+
+	class Suite
+	{
+	public:
+
+	// == Constructors
+
+		explicit Suite(const Settings& settings);
+
+
+	// == Actors
+
+		bool selected(const std::string& group, const std::string& name) const;
+
+		// Times run(), nothing happens if the benchmark isn't selected. Returns the result, or nullptr
+		template <typename Run>
+		Result* run(const std::string& group, const std::string& name, size_t bytes, size_t pixels, Run&& run)
+		{
+			if (!selected(group, name))
+				return nullptr;
+
+			using Clock = std::chrono::steady_clock;
+
+			for (size_t i{}; i < settings.warmup; i++)
+				run();
+
+			// Runs per sample, from how long one takes once warm
+			const Clock::time_point probe{ Clock::now() };
+			run();
+			const auto once{ std::max<std::chrono::nanoseconds::rep>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - probe).count(), 1) };
+			const size_t repeats{ static_cast<size_t>(std::max<std::chrono::nanoseconds::rep>(settings.min_sample.count() / once, 1)) };
+
+			Result result{ group, name, bytes, pixels };
+			result.samples_ns.reserve(settings.samples);
+
+			for (size_t s{}; s < settings.samples; s++)
+			{
+				const Clock::time_point start{ Clock::now() };
+				for (size_t r{}; r < repeats; r++)
+					run();
+				const auto elapsed{ std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count() };
+
+				result.samples_ns.push_back(static_cast<std::uint64_t>(elapsed) / repeats);
+			}
+
+			return &add(std::move(result));
+		}
+
+
+	// == Getters
+
+		const std::vector<Result>& getResults() const noexcept { return results; }
+
+		const Settings& getSettings() const noexcept { return settings; }
+
+
+	// == Output
+
+		// One line per result, as they come
+		void print(std::ostream& out, const Result& result) const;
+
+		void writeJSON(std::ostream& out) const;
+
+
+	private:
+		Result& add(Result&& result);
+
+
+		Settings settings;
+		std::vector<Result> results{};
+	};
+
+} // fill::bench
@@ -0,0 +1,574 @@
+// FILL_bench : decoding and transformation benchmarks.
+//
+// Macro benchmarks time whole loads (bundled samples and synthetic images), micro benchmarks one stage at a time:
+// walking the chunks, checking their CRCs, inflating, unfiltering, and the insert and resize transformations.
+// Loads and inflating are timed with zlib and with the builtin inflater, whose output is first checked against zlib's.
+// Loads are also timed checking every chunk's CRC and none, load_reused checking the critical ones (the default),
+// and from an uncompressed PAM copy of each sample, loaded into an image or only mapped (see pnm.hpp).
+// Usage: FILL_bench [--json <file>|-] [--samples <n>] [--warmup <n>] [--filter <text>] [--images <directory>]
+
+#include "bench.hpp"
+#include "synthetic.hpp"
+
+#include "image.hpp"
+#include "decoder.hpp"
+#include "probe.hpp"
+
+#include "crc32.hpp"
+#include "fast_inflater.hpp"
+#include "inflater.hpp"
+#include "mapped_file.hpp"
+#include "unfilter.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if !defined(FILE_PATH)
+	#define FILE_PATH ""
+#endif
+
+
+namespace
+{
+
+	using fill::bench::Suite;
+	using fill::bench::Result;
+
+
+	struct PngChunk
+	{
+		std::uint32_t type{};
+		std::span<const std::uint8_t> data{};
+	};
+
+	constexpr std::uint32_t chunk_type(const char (&name)[5]) noexcept
+	{
+		return static_cast<std::uint32_t>(static_cast<std::uint8_t>(name[0])) << 24 | static_cast<std::uint32_t>(static_cast<std::uint8_t>(name[1])) << 16 |
+			static_cast<std::uint32_t>(static_cast<std::uint8_t>(name[2])) << 8 | static_cast<std::uint32_t>(static_cast<std::uint8_t>(name[3]));
+	}
+
+	std::uint32_t read_uint32(const std::uint8_t* bytes) noexcept
+	{
+		return std::uint32_t{ bytes[0] } << 24 | std::uint32_t{ bytes[1] } << 16 | std::uint32_t{ bytes[2] } << 8 | std::uint32_t{ bytes[3] };
+	}
+
+	// Chunks after the signature up to IEND, payloads left in place
+	void walk_chunks(std::span<const std::uint8_t> png, std::vector<PngChunk>& chunks)
+	{
+		chunks.clear();
+
+		for (size_t offset{ 8 }; offset + 12 <= png.size();)
+		{
+			const std::uint32_t length{ read_uint32(png.data() + offset) };
+			const std::uint32_t type{ read_uint32(png.data() + offset + 4) };
+
+			if (length > png.size() - offset - 12)
+				throw std::runtime_error("ERROR::BENCH::Truncated chunk");
+
+			chunks.push_back({ type, png.subspan(offset + 8, length) });
+			offset += 12 + static_cast<size_t>(length);
+
+			if (type == chunk_type("IEND"))
+				break;
+		}
+	}
+
+	const char* channels_name(std::uint8_t channels) noexcept
+	{
+		constexpr const char* names[]{ "grey", "grey_alpha", "rgb", "rgba" };
+		return names[channels - 1];
+	}
+
+	const char* filter_name(fill::ResizeFilter filter) noexcept
+	{
+		constexpr const char* names[]{ "nearest", "bilinear", "box", "lanczos3", "kaiser" };
+		return names[static_cast<size_t>(filter)];
+	}
+
+	fill::Image to_image(const fill::bench::SyntheticImage& synthetic)
+	{
+		fill::Image image{ synthetic.width, synthetic.height, synthetic.channels };
+
+		for (std::uint32_t y{}; y < synthetic.height; y++)
+			std::memcpy(image.row(y), synthetic.pixels.data() + y * synthetic.rowBytes(), synthetic.rowBytes());
+
+		return image;
+	}
+
+	// Per image averages of what the decoder collected, in milliseconds for the stages
+	void add_decode_stats(Result& result, const fill::DecodeStats& stats)
+	{
+		if (!fill::decode_stats_enabled || stats.images == 0)
+			return;
+
+		const double images{ static_cast<double>(stats.images) };
+		const auto ms{ [images](std::uint64_t ns) { return static_cast<double>(ns) / images / 1e6; } };
+
+		result.extra.insert(result.extra.end(),
+		{
+			{ "map_ms", ms(stats.map_ns) },
+			{ "parse_ms", ms(stats.parse_ns) },
+			{ "read_ms", ms(stats.read_ns) },
+			{ "inflate_ms", ms(stats.inflate_ns) },
+			{ "unfilter_ms", ms(stats.unfilter_ns) },
+			{ "expand_ms", ms(stats.expand_ns) },
+			{ "wait_ms", ms(stats.wait_ns) },
+			{ "allocations", static_cast<double>(stats.allocations) / images }
+		});
+	}
+
+
+	// --- Bundled samples: whole loads, chunk walk and inflate
+
+	void bench_samples(Suite& suite, std::ostream& log, const std::vector<std::filesystem::path>& samples)
+	{
+		std::vector<PngChunk> chunks;
+
+		for (const std::filesystem::path& path : samples)
+		{
+			const std::string name{ path.filename().string() };
+			const fill::ImageInfo info{ fill::probe(path) };
+
+			const fill::Image reference{ path };
+			const size_t decoded_bytes{ static_cast<size_t>(reference.getWidth()) * reference.getHeight() * reference.getBytesPerPixel() };
+			const size_t pixels{ static_cast<size_t>(info.width) * info.height };
+
+			// Decoded bytes per second, everything set up from scratch each time
+			if (Result* result{ suite.run("macro", "load/" + name, decoded_bytes, pixels, [&]
+				{
+					fill::Image image{ path };
+					fill::bench::sink = fill::bench::sink + image.size();
+				}) })
+				suite.print(log, *result);
+
+			// Same with a warm decoder, and the image's buffer reused
+			{
+				fill::Decoder decoder{};
+				fill::Image image{};
+
+				if (Result* result{ suite.run("macro", "load_reused/" + name, decoded_bytes, pixels, [&]
+					{
+						image.loadFromFile(path, decoder);
+						fill::bench::sink = fill::bench::sink + image.size();
+					}) })
+				{
+					add_decode_stats(*result, decoder.getTotalStats());
+					suite.print(log, *result);
+				}
+			}
+
+			// Same, checking every chunk's CRC, then none: the cost of checking them, next to load_reused (the critical ones)
+			for (const fill::CrcCheck crc_check : { fill::CrcCheck::All, fill::CrcCheck::None })
+			{
+				fill::DecodeOptions options{};
+				options.crc_check = crc_check;
+
+				fill::Decoder decoder{ options };
+				fill::Image image{};
+
+				if (Result* result{ suite.run("macro", (crc_check == fill::CrcCheck::All ? "load_crc_all/" : "load_crc_none/") + name, decoded_bytes, pixels, [&]
+					{
+						image.loadFromFile(path, decoder);
+						fill::bench::sink = fill::bench::sink + image.size();
+					}) })
+				{
+					add_decode_stats(*result, decoder.getTotalStats());
+					suite.print(log, *result);
+				}
+			}
+
+			// Same, reading and inflating on their own threads, then with the builtin inflater
+			for (const bool pipelined : { true, false })
+			{
+				fill::DecodeOptions options{};
+				options.pipelined = pipelined;
+				options.pipeline_min_bytes = 0;
+				options.inflater = pipelined ? fill::InflateBackend::Zlib : fill::InflateBackend::Builtin;
+
+				fill::Decoder decoder{ options };
+				fill::Image image{};
+
+				if (Result* result{ suite.run("macro", (pipelined ? "load_pipelined/" : "load_builtin/") + name, decoded_bytes, pixels, [&]
+					{
+						image.loadFromFile(path, decoder);
+						fill::bench::sink = fill::bench::sink + image.size();
+					}) })
+				{
+					if (!std::equal(reference.getImage().begin(), reference.getImage().end(), image.getImage().begin(), image.getImage().end()))
+						throw std::runtime_error("ERROR::BENCH::" + name + " decoded differently than with the default options");
+
+					add_decode_stats(*result, decoder.getTotalStats());
+					suite.print(log, *result);
+				}
+			}
+
+			// The same pixels from a PAM copy: copied out of the mapping, then only mapped and read in place
+			if (suite.selected("macro", "load_pam/" + name) || suite.selected("macro", "map_pam/" + name))
+			{
+				const std::filesystem::path pam{ std::filesystem::temp_directory_path() / (path.stem().string() + "_FILL_bench.pam") };
+				reference.saveToFile(pam);
+
+				fill::Decoder decoder{};
+				fill::Image image{};
+
+				if (Result* result{ suite.run("macro", "load_pam/" + name, decoded_bytes, pixels, [&]
+					{
+						image.loadFromFile(pam, decoder);
+						fill::bench::sink = fill::bench::sink + image.size();
+					}) })
+				{
+					if (!std::equal(reference.getImage().begin(), reference.getImage().end(), image.getImage().begin(), image.getImage().end()))
+						throw std::runtime_error("ERROR::BENCH::" + name + " loaded differently from its PAM copy");
+
+					add_decode_stats(*result, decoder.getTotalStats());
+					suite.print(log, *result);
+				}
+
+				// Every page of the pixels is touched once, as the stage reading them would
+				if (Result* result{ suite.run("macro", "map_pam/" + name, decoded_bytes, pixels, [&]
+					{
+						const fill::MappedImage mapped{ pam };
+						const fill::ImageView view{ mapped.view() };
+
+						std::uint64_t sum{};
+						for (size_t offset{}; offset < view.getStride() * view.getHeight(); offset += 4096)
+							sum += view.data()[offset];
+
+						fill::bench::sink = fill::bench::sink + sum;
+					}) })
+					suite.print(log, *result);
+
+				std::filesystem::remove(pam);
+			}
+
+			// Mapping the file and walking its chunks, file bytes per second
+			const size_t file_bytes{ static_cast<size_t>(std::filesystem::file_size(path)) };
+
+			if (Result* result{ suite.run("micro", "chunks/" + name, file_bytes, pixels, [&]
+				{
+					const fill::detail::MappedFile file{ path };
+					walk_chunks(file.bytes(), chunks);
+					fill::bench::sink = fill::bench::sink + chunks.size();
+				}) })
+				suite.print(log, *result);
+
+			// CRC of every chunk (type and data) with FILL's kernel, then zlib's, file bytes per second
+			if (suite.selected("micro", "crc/" + name) || suite.selected("micro", "crc_zlib/" + name))
+			{
+				const fill::detail::MappedFile file{ path };
+				walk_chunks(file.bytes(), chunks);
+
+				if (Result* result{ suite.run("micro", "crc/" + name, file_bytes, pixels, [&]
+					{
+						for (const PngChunk& chunk : chunks)
+							fill::bench::sink = fill::bench::sink + fill::detail::crc32(0, chunk.data.data() - 4, chunk.data.size() + 4);
+					}) })
+					suite.print(log, *result);
+
+				if (Result* result{ suite.run("micro", "crc_zlib/" + name, file_bytes, pixels, [&]
+					{
+						for (const PngChunk& chunk : chunks)
+							fill::bench::sink = fill::bench::sink + crc32(0, chunk.data.data() - 4, static_cast<uInt>(chunk.data.size() + 4));
+					}) })
+					suite.print(log, *result);
+			}
+
+			// Inflating the image data alone, inflated bytes per second
+			if (!suite.selected("micro", "inflate/" + name) && !suite.selected("micro", "inflate_builtin/" + name))
+				continue;
+
+			const fill::detail::MappedFile file{ path };
+			walk_chunks(file.bytes(), chunks);
+
+			std::vector<std::span<const std::uint8_t>> payloads;
+			for (const PngChunk& chunk : chunks)
+				if (chunk.type == chunk_type("IDAT"))
+					payloads.push_back(chunk.data);
+
+			fill::detail::Inflater inflater{};
+			size_t next{};
+			const auto input{ [&]() -> std::span<const std::uint8_t> { return next < payloads.size() ? payloads[next++] : std::span<const std::uint8_t>{}; } };
+
+			// Size of the stream, found by inflating it once
+			std::vector<std::uint8_t> inflated(1 << 20);
+			size_t inflated_bytes{};
+
+			next = 0;
+			inflater.reset(input);
+			for (size_t got{}; (got = inflater.read(inflated.data(), inflated.size())) != 0;)
+				inflated_bytes += got;
+
+			inflated.resize(inflated_bytes);
+
+			if (Result* result{ suite.run("micro", "inflate/" + name, inflated_bytes, pixels, [&]
+				{
+					next = 0;
+					inflater.reset(input);
+					fill::bench::sink = fill::bench::sink + inflater.read(inflated.data(), inflated.size());
+					inflater.finish();
+				}) })
+				suite.print(log, *result);
+
+			// The builtin inflater, on the payloads put end to end as the decoder does. It must agree with zlib before it is timed
+			std::vector<std::uint8_t> stream;
+			for (const std::span<const std::uint8_t> payload : payloads)
+				stream.insert(stream.end(), payload.begin(), payload.end());
+
+			const auto fast_inflater{ std::make_unique<fill::detail::FastInflater>() }; /*its tables are too large for the stack*/
+			std::vector<std::uint8_t> fast_inflated(inflated_bytes);
+
+			const fill::detail::FastInflater::Result checked{ fast_inflater->inflate(stream, fast_inflated) };
+			if (checked.status != fill::detail::FastInflater::Status::Ended || checked.written != inflated_bytes || fast_inflated != inflated)
+				throw std::runtime_error("ERROR::BENCH::Builtin inflater disagrees with zlib on " + name);
+
+			if (Result* result{ suite.run("micro", "inflate_builtin/" + name, inflated_bytes, pixels, [&]
+				{
+					fill::bench::sink = fill::bench::sink + fast_inflater->inflate(stream, fast_inflated).written;
+				}) })
+				suite.print(log, *result);
+		}
+	}
+
+
+	// --- Synthetic images: whole loads and unfiltering, per filter mix and pixel size
+
+	void bench_synthetic(Suite& suite, std::ostream& log)
+	{
+		constexpr std::uint32_t size{ 1024 };
+		const fill::detail::SimdLevel simd{ fill::detail::detect_simd_level() };
+
+		for (std::uint8_t channels{ 1 }; channels <= 4; channels++)
+		{
+			for (const fill::bench::FilterMix& mix : fill::bench::filter_mixes)
+			{
+				const std::string name{ std::string{ mix.name } + '_' + channels_name(channels) };
+
+				if (!suite.selected("macro", "load_memory/" + name) && !suite.selected("macro", "load_memory_builtin/" + name) && !suite.selected("micro", "unfilter/" + name + "_scalar"))
+					continue; /*unfilter/name is part of unfilter/name_scalar*/
+
+				const fill::bench::SyntheticImage synthetic{ fill::bench::make_synthetic(size, size, channels, mix) };
+
+				const size_t row_bytes{ synthetic.rowBytes() };
+				const size_t pixels{ static_cast<size_t>(size) * size };
+
+				// zlib, then the builtin inflater
+				for (const fill::InflateBackend inflater : { fill::InflateBackend::Zlib, fill::InflateBackend::Builtin })
+				{
+					fill::DecodeOptions options{};
+					options.inflater = inflater;
+
+					fill::Decoder decoder{ options };
+					fill::Image image{};
+					const std::span<const std::byte> png{ std::as_bytes(std::span{ synthetic.png }) };
+					const std::string benchmark{ inflater == fill::InflateBackend::Zlib ? "load_memory/" : "load_memory_builtin/" };
+
+					if (Result* result{ suite.run("macro", benchmark + name, synthetic.pixels.size(), pixels, [&]
+						{
+							image.loadFromMemory(png, decoder);
+							fill::bench::sink = fill::bench::sink + image.size();
+						}) })
+					{
+						if (!std::equal(synthetic.pixels.begin(), synthetic.pixels.end(), image.getImage().begin(), image.getImage().end()))
+							throw std::runtime_error("ERROR::BENCH::Synthetic image " + name + " decoded wrong");
+
+						add_decode_stats(*result, decoder.getTotalStats());
+						suite.print(log, *result);
+					}
+				}
+
+				// Filtered bytes per second, from the rows exactly as the inflater hands them over
+				std::vector<std::uint8_t> unfiltered(synthetic.pixels.size());
+
+				const auto unfilter{ [&](const fill::detail::UnfilterKernels& kernels)
+				{
+					const std::uint8_t* prior{ nullptr };
+
+					for (std::uint32_t y{}; y < size; y++)
+					{
+						const std::uint8_t* filtered{ synthetic.filtered.data() + y * (row_bytes + 1) };
+						std::uint8_t* current{ unfiltered.data() + y * row_bytes };
+
+						fill::detail::unfilter_row(kernels, filtered[0], filtered + 1, prior, current, row_bytes, channels);
+						prior = current;
+					}
+
+					fill::bench::sink = fill::bench::sink + unfiltered[unfiltered.size() - 1];
+				} };
+
+				// The kernels picked for this machine, and the scalar ones they are measured against
+				std::vector<fill::detail::SimdLevel> levels{ simd };
+				if (simd != fill::detail::SimdLevel::Scalar)
+					levels.push_back(fill::detail::SimdLevel::Scalar);
+
+				for (const fill::detail::SimdLevel level : levels)
+				{
+					const std::string suffix{ level == simd ? "" : "_scalar" };
+
+					const fill::detail::UnfilterKernels kernels{ fill::detail::unfilter_kernels(level, channels) };
+
+					if (Result* result{ suite.run("micro", "unfilter/" + name + suffix, synthetic.filtered.size(), pixels, [&] { unfilter(kernels); }) })
+					{
+						if (unfiltered != synthetic.pixels)
+							throw std::runtime_error("ERROR::BENCH::Unfiltering " + name + suffix + " went wrong");
+
+						suite.print(log, *result);
+					}
+				}
+			}
+		}
+	}
+
+
+	// --- Transformations, output bytes and pixels per second
+
+	void bench_transforms(Suite& suite, std::ostream& log)
+	{
+		const fill::bench::FilterMix& mix{ fill::bench::filter_mixes.back() };
+
+		if (suite.selected("micro", "insert/1024x1024+768x512"))
+		{
+			fill::Image base{ to_image(fill::bench::make_synthetic(1024, 1024, 4, mix, 1)) };
+			fill::Image other{ to_image(fill::bench::make_synthetic(768, 512, 4, mix, 2)) };
+
+			if (Result* result{ suite.run("micro", "insert/1024x1024+768x512", size_t{ 1024 } * 1024 * 4, size_t{ 1024 } * 1024, [&]
+				{
+					const fill::Image inserted{ base.insert(other, 128) };
+					fill::bench::sink = fill::bench::sink + inserted.size();
+				}) })
+				suite.print(log, *result);
+		}
+
+		struct Scale
+		{
+			std::uint32_t from, to;
+		};
+
+		for (const Scale scale : { Scale{ 2048, 1024 }, Scale{ 1024, 2048 } })
+		{
+			const std::string sizes{ std::to_string(scale.from) + "_to_" + std::to_string(scale.to) };
+
+			const auto selected{ [&]
+			{
+				for (size_t f{}; f <= static_cast<size_t>(fill::ResizeFilter::Kaiser); f++)
+					if (suite.selected("micro", std::string{ "resize/" } + filter_name(static_cast<fill::ResizeFilter>(f)) + '_' + sizes))
+						return true;
+				return false;
+			} };
+
+			if (!selected())
+				continue;
+
+			const fill::Image source{ to_image(fill::bench::make_synthetic(scale.from, scale.from, 4, mix)) };
+			const size_t pixels{ static_cast<size_t>(scale.to) * scale.to };
+
+			for (size_t f{}; f <= static_cast<size_t>(fill::ResizeFilter::Kaiser); f++)
+			{
+				const fill::ResizeFilter filter{ static_cast<fill::ResizeFilter>(f) };
+
+				if (Result* result{ suite.run("micro", std::string{ "resize/" } + filter_name(filter) + '_' + sizes, pixels * 4, pixels, [&]
+					{
+						const fill::Image resized{ source.resize(scale.to, scale.to, filter) };
+						fill::bench::sink = fill::bench::sink + resized.size();
+					}) })
+					suite.print(log, *result);
+			}
+		}
+	}
+
+
+	void usage(std::ostream& out)
+	{
+		out << "Usage: FILL_bench [options]\n"
+			"  --json <file>        write the results as JSON, - for stdout (the table then goes to stderr)\n"
+			"  --samples <n>        timed samples per benchmark (15)\n"
+			"  --warmup <n>         untimed runs before them (2)\n"
+			"  --filter <text>      only run benchmarks whose group/name contains text, e.g. micro/unfilter\n"
+			"  --images <directory> PNG samples to load (" FILE_PATH ")\n";
+	}
+
+}
+
+
+int main(int argc, char** argv)
+{
+	fill::bench::Settings settings{};
+	std::string json_path{};
+	std::filesystem::path images{ FILE_PATH };
+
+	for (int i{ 1 }; i < argc; i++)
+	{
+		const std::string argument{ argv[i] };
+		const bool has_value{ i + 1 < argc };
+
+		if (argument == "--json" && has_value)
+			json_path = argv[++i];
+		else if (argument == "--samples" && has_value)
+			settings.samples = std::stoul(argv[++i]);
+		else if (argument == "--warmup" && has_value)
+			settings.warmup = std::stoul(argv[++i]);
+		else if (argument == "--filter" && has_value)
+			settings.filter = argv[++i];
+		else if (argument == "--images" && has_value)
+			images = argv[++i];
+		else
+		{
+			usage(argument == "--help" ? std::cout : std::cerr);
+			return argument == "--help" ? 0 : 1;
+		}
+	}
+
+	std::ostream& log{ json_path == "-" ? std::cerr : std::cout };
+
+	try
+	{
+		std::vector<std::filesystem::path> samples;
+
+		if (!images.empty() && std::filesystem::is_directory(images))
+		{
+			for (const auto& entry : std::filesystem::directory_iterator{ images })
+			{
+				std::string extension{ entry.path().extension().string() };
+				std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+				if (entry.is_regular_file() && extension == ".png")
+					samples.push_back(entry.path());
+			}
+
+			std::sort(samples.begin(), samples.end());
+		}
+		else
+			log << "No sample directory, only synthetic images are used\n";
+
+		Suite suite{ settings };
+
+		bench_samples(suite, log, samples);
+		bench_synthetic(suite, log);
+		bench_transforms(suite, log);
+
+		if (json_path == "-")
+			suite.writeJSON(std::cout);
+		else if (!json_path.empty())
+		{
+			std::ofstream file{ json_path };
+
+			if (!file)
+				throw std::runtime_error("ERROR::BENCH::Couldn't open " + json_path);
+
+			suite.writeJSON(file);
+		}
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << e.what() << '\n';
+		return 1;
+	}
+
+	return 0;
+}
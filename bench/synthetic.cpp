@@ -0,0 +1,133 @@
+#include "synthetic.hpp"
+
+#include "deflater.hpp"
+#include "filter.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+
+#include "zlib.h"
+
+
+namespace
+{
+
+	void write_uint32(std::vector<std::uint8_t>& png, std::uint32_t value)
+	{
+		png.push_back(static_cast<std::uint8_t>(value >> 24));
+		png.push_back(static_cast<std::uint8_t>(value >> 16));
+		png.push_back(static_cast<std::uint8_t>(value >> 8));
+		png.push_back(static_cast<std::uint8_t>(value));
+	}
+
+	void write_chunk(std::vector<std::uint8_t>& png, const char (&type)[5], std::span<const std::uint8_t> data)
+	{
+		write_uint32(png, static_cast<std::uint32_t>(data.size()));
+
+		const size_t type_offset{ png.size() };
+		png.insert(png.end(), type, type + 4);
+		png.insert(png.end(), data.begin(), data.end());
+
+		const uLong crc{ crc32(crc32(0L, Z_NULL, 0), png.data() + type_offset, static_cast<uInt>(4 + data.size())) };
+		write_uint32(png, static_cast<std::uint32_t>(crc));
+	}
+
+	constexpr std::uint8_t color_type(std::uint8_t channels)
+	{
+		switch (channels)
+		{
+		case 1:
+			return 0;
+		case 2:
+			return 4;
+		case 3:
+			return 2;
+		case 4:
+			return 6;
+		default:
+			throw std::runtime_error("ERROR::BENCH::Synthetic images have 1 to 4 channels");
+		}
+	}
+
+}
+
+
+fill::bench::SyntheticImage fill::bench::make_synthetic(std::uint32_t width, std::uint32_t height, std::uint8_t channels, const FilterMix& mix, std::uint32_t seed)
+{
+	SyntheticImage image{ width, height, channels };
+
+	const std::uint8_t type{ color_type(channels) };
+	const std::uint32_t total_weight{ std::accumulate(mix.weights.begin(), mix.weights.end(), std::uint32_t{}) };
+
+	if (total_weight == 0)
+		throw std::runtime_error("ERROR::BENCH::Filter mix has no weight");
+
+	const size_t row_bytes{ image.rowBytes() };
+
+	// Gradients, each channel its own way, plus 4 bits of noise (xorshift32)
+	image.pixels.resize(row_bytes * height);
+	std::uint32_t state{ seed ? seed : 1 };
+
+	for (std::uint32_t y{}; y < height; y++)
+	{
+		for (std::uint32_t x{}; x < width; x++)
+		{
+			for (std::uint32_t c{}; c < channels; c++)
+			{
+				state ^= state << 13;
+				state ^= state >> 17;
+				state ^= state << 5;
+
+				const std::uint32_t gradient{ (x * (c + 1) + y * (3 - c % 3)) / 4 + c * 64 };
+				image.pixels[y * row_bytes + static_cast<size_t>(x) * channels + c] = static_cast<std::uint8_t>(gradient + (state & 0x0F));
+			}
+		}
+	}
+
+	// Filter types follow the mix, spread evenly down the image (smooth weighted round robin)
+	const fill::detail::FilterKernels kernels{ fill::detail::filter_kernels() };
+
+	image.filtered.resize((row_bytes + 1) * height);
+	std::vector<std::uint8_t> zeros(row_bytes), scratch(row_bytes);
+	std::array<std::int64_t, 5> credit{};
+
+	for (std::uint32_t y{}; y < height; y++)
+	{
+		for (size_t f{}; f < credit.size(); f++)
+			credit[f] += mix.weights[f];
+
+		size_t filter{};
+		for (size_t f{ 1 }; f < credit.size(); f++)
+			if (credit[f] > credit[filter])
+				filter = f;
+
+		credit[filter] -= total_weight;
+
+		const std::uint8_t* row{ image.pixels.data() + y * row_bytes };
+		const std::uint8_t* prior{ y ? row - row_bytes : zeros.data() };
+
+		fill::detail::filter_row(kernels, static_cast<int>(filter), row, prior, image.filtered.data() + y * (row_bytes + 1), scratch.data(), row_bytes, channels);
+	}
+
+	// Split in several IDAT chunks, as most encoders do
+	const std::vector<std::uint8_t> compressed{ fill::detail::deflate_zlib(image.filtered, 6, 128 * 1024, nullptr) };
+
+	const std::uint8_t signature[8]{ 0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a };
+	image.png.assign(signature, signature + 8);
+
+	std::vector<std::uint8_t> ihdr;
+	write_uint32(ihdr, width);
+	write_uint32(ihdr, height);
+	ihdr.insert(ihdr.end(), { 8, type, 0, 0, 0 });
+	write_chunk(image.png, "IHDR", ihdr);
+
+	constexpr size_t idat_bytes{ 64 * 1024 };
+	for (size_t offset{}; offset < compressed.size(); offset += idat_bytes)
+		write_chunk(image.png, "IDAT", std::span<const std::uint8_t>{ compressed }.subspan(offset, std::min(idat_bytes, compressed.size() - offset)));
+
+	write_chunk(image.png, "IEND", {});
+
+	return image;
+}
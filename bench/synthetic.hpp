@@ -0,0 +1,53 @@
+#pragma once // synthetic.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// This file contains the synthetic images FILL_bench decodes, generated on the fly.
+//	- Rows are filtered with a controlled mix of filter types, so every unfilter kernel gets timed (the bundled samples mostly use Paeth and Up).
+//	- Pixels are smooth gradients with a little noise, compressing about as well as a photo does.
+//	- The same seed always gives the same image.
+// ===================================================
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace fill::bench
+{
+
+	struct FilterMix
+	{
+		std::string_view name;
+		std::array<std::uint32_t, 5> weights; /*relative share of rows per filter type: None, Sub, Up, Average, Paeth*/
+	};
+
+	inline constexpr std::array<FilterMix, 7> filter_mixes
+	{ {
+		{ "none",    { 1, 0, 0, 0, 0 } },
+		{ "sub",     { 0, 1, 0, 0, 0 } },
+		{ "up",      { 0, 0, 1, 0, 0 } },
+		{ "average", { 0, 0, 0, 1, 0 } },
+		{ "paeth",   { 0, 0, 0, 0, 1 } },
+		{ "uniform", { 1, 1, 1, 1, 1 } },
+		{ "photo",   { 1, 2, 3, 1, 5 } } /*roughly what adaptive filtering picks on photos*/
+	} };
+
+	struct SyntheticImage
+	{
+		std::uint32_t width{}, height{};
+		std::uint8_t channels{}; /*8 bit samples*/
+
+		std::vector<std::uint8_t> pixels{};   /*rows packed*/
+		std::vector<std::uint8_t> filtered{}; /*every row with its filter type byte first, as it comes out of the inflater*/
+		std::vector<std::uint8_t> png{};      /*the whole file*/
+
+		size_t rowBytes() const noexcept { return static_cast<size_t>(width) * channels; }
+	};
+
+
+	// channels is 1 (greyscale), 2 (greyscale and alpha), 3 (RGB) or 4 (RGBA)
+	SyntheticImage make_synthetic(std::uint32_t width, std::uint32_t height, std::uint8_t channels, const FilterMix& mix, std::uint32_t seed = 1);
+
+} // fill::bench
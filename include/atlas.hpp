@@ -0,0 +1,65 @@
+#pragma once // atlas.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// This file contains the texture atlas types used by fill::Image::merge_images.
+//	- Images are packed with a Skyline (bottom left) or a MaxRects (best short side fit) bin packer.
+//	- Padding is kept around every image, atlas borders included, and the atlas can be constrained to power of two sides.
+//	- The atlas comes back with one rectangle (in pixels and in UVs) per input image, in input order.
+//	- Pixels are copied one row (memcpy) at a time, spread over a fill::ThreadPool when one is given.
+//	- Each packed image can be viewed in place (Atlas::view), e.g. to encode it or resize it on its own.
+// ===================================================
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "image.hpp"
+
+namespace fill
+{
+
+	class ThreadPool;
+
+	struct AtlasOptions
+	{
+		enum class Packer
+			: std::uint8_t
+		{
+			Skyline, /*fastest, best with sprites of similar heights*/
+			MaxRects /*slower, best with very different sizes and aspect ratios*/
+		};
+
+		Packer packer{ Packer::Skyline };
+
+		std::uint32_t padding{ 1 }; /*empty pixels between images, and between images and the atlas border*/
+		bool power_of_two{ false };
+
+		std::uint32_t max_size{ 16384 }; /*per side*/
+
+		ThreadPool* pool{ nullptr }; /*copies run on the calling thread without one*/
+	};
+
+	struct AtlasRect
+	{
+		std::uint32_t x{}, y{};
+		std::uint32_t width{}, height{};
+
+		float u0{}, v0{}; /*top left*/
+		float u1{}, v1{}; /*bottom right*/
+	};
+
+	struct Atlas
+	{
+		Image image{};
+		std::vector<AtlasRect> rects{}; /*rects[i] is where images[i] went*/
+
+		// Pixels of images[index] inside the atlas, without copying them
+		ImageView view(size_t index) const
+		{
+			const AtlasRect& rect{ rects[index] };
+			return image.view().crop(Rect{ rect.x, rect.y, rect.width, rect.height });
+		}
+	};
+
+} // fill
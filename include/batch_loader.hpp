@@ -0,0 +1,69 @@
+#pragma once // batch_loader.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// This file contains a loader decoding many images in parallel (e.g. a whole directory before building an atlas).
+//	- Each image is one task on a work-stealing fill::ThreadPool.
+//	- Each worker decodes with its own fill::Decoder, so zlib state and scratch buffers are reused, and never shared.
+//	- Results come back either as futures (errors are rethrown by get()), or through a completion callback.
+// ===================================================
+
+#include <cstddef>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <span>
+#include <vector>
+
+#include "decoder.hpp"
+#include "image.hpp"
+#include "thread_pool.hpp"
+
+namespace fill
+{
+
+	class BatchLoader
+	{
+	public:
+		// Called on a worker thread once per input, in completion order. error is null on success
+		using Callback = std::function<void(size_t index, Image&& image, std::exception_ptr error)>;
+
+
+	// == Constructors
+
+		// 0 threads means one per hardware thread
+		explicit BatchLoader(unsigned thread_count = 0);
+
+
+	// == Actors
+
+		std::vector<std::future<Image>> load(std::span<const std::filesystem::path> paths);
+
+		// Buffers must stay alive until their image is done
+		std::vector<std::future<Image>> load(std::span<const std::span<const std::byte>> buffers);
+
+		// Returns immediately, call wait() to block until every callback has run
+		void load(std::span<const std::filesystem::path> paths, Callback on_complete);
+
+		void load(std::span<const std::span<const std::byte>> buffers, Callback on_complete);
+
+		// Rethrows the first exception a callback threw
+		void wait();
+
+
+	// == Getters
+
+		unsigned getThreadCount() const noexcept { return pool.size(); }
+
+
+	private:
+		Decoder& worker_decoder() noexcept { return decoders[pool.current_worker()]; }
+
+
+		std::vector<Decoder> decoders{}; /*one per worker, indexed by ThreadPool::current_worker()*/
+
+		ThreadPool pool; /*declared last: joined before the decoders are destroyed*/
+	};
+
+} // fill
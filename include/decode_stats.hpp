@@ -0,0 +1,85 @@
+#pragma once // decode_stats.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// This file contains the statistics a fill::Decoder can collect, to find where the time of a slow load goes.
+//	- Time per stage: file mapping, chunk parsing, reading image data, inflating, unfiltering, expanding.
+//	- Bytes read and inflated, chunk counts, buffer allocations, and how many rows use each filter type.
+//	- Collection is compiled in with the FILL_DECODE_STATS option (CMake), it costs nothing otherwise: every field stays 0.
+// Stats come per image and summed per decoder, and can be pushed to any telemetry from DecodeOptions::on_stats.
+// ===================================================
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace fill
+{
+
+#if defined(FILL_DECODE_STATS)
+	inline constexpr bool decode_stats_enabled{ true };
+#else
+	inline constexpr bool decode_stats_enabled{ false };
+#endif
+
+	struct DecodeStats
+	{
+		// Nanoseconds per stage. The stages don't overlap, unless the decode is pipelined: reading and inflating then run
+		// on their own threads, alongside the others, and wait_ns is how long unfiltering waited for them
+		std::uint64_t map_ns{};      /*opening and mapping the file, 0 when decoding from memory*/
+		std::uint64_t parse_ns{};    /*signature, IHDR, and the chunks before the image data*/
+		std::uint64_t read_ns{};     /*finding the next IDAT chunk, first touch of its pages included*/
+		std::uint64_t inflate_ns{};  /*zlib*/
+		std::uint64_t unfilter_ns{};
+		std::uint64_t expand_ns{};   /*format expansion, Adam7 scattering and region copies*/
+		std::uint64_t wait_ns{};
+		std::uint64_t total_ns{};    /*wall clock, callbacks excluded*/
+
+		std::uint64_t file_bytes{};     /*size of the PNG*/
+		std::uint64_t bytes_read{};     /*compressed bytes handed to zlib*/
+		std::uint64_t bytes_inflated{}; /*filter bytes included*/
+
+		std::uint64_t chunks{};      /*read, all types*/
+		std::uint64_t idat_chunks{};
+
+		std::uint64_t allocations{};     /*pixel buffer and decoder buffers that had to grow*/
+		std::uint64_t allocated_bytes{}; /*their new capacity*/
+
+		std::array<std::uint64_t, 5> filter_rows{}; /*rows per filter type: None, Sub, Up, Average, Paeth*/
+
+		std::uint64_t images{};    /*decoded, 1 for a single image*/
+		std::uint64_t pipelined{}; /*of them, decoded by DecodeOptions::pipelined*/
+
+
+		DecodeStats& operator+=(const DecodeStats& other) noexcept
+		{
+			map_ns += other.map_ns;
+			parse_ns += other.parse_ns;
+			read_ns += other.read_ns;
+			inflate_ns += other.inflate_ns;
+			unfilter_ns += other.unfilter_ns;
+			expand_ns += other.expand_ns;
+			wait_ns += other.wait_ns;
+			total_ns += other.total_ns;
+
+			file_bytes += other.file_bytes;
+			bytes_read += other.bytes_read;
+			bytes_inflated += other.bytes_inflated;
+
+			chunks += other.chunks;
+			idat_chunks += other.idat_chunks;
+
+			allocations += other.allocations;
+			allocated_bytes += other.allocated_bytes;
+
+			for (size_t i{}; i < filter_rows.size(); i++)
+				filter_rows[i] += other.filter_rows[i];
+
+			images += other.images;
+			pipelined += other.pipelined;
+
+			return *this;
+		}
+	};
+
+} // fill
@@ -0,0 +1,148 @@
+#pragma once // decoder.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// This file contains a reusable decoding context for fill::Image.
+// Loading many images through the same Decoder avoids setting everything up again for each of them:
+//	- zlib's inflate state is created once, and only reset between images (or FILL's own inflater, see InflateBackend).
+//	- Scratch buffers (e.g. the scanline window) keep their capacity.
+//	- Optionally, all of the above is allocated from a caller provided arena (std::pmr::memory_resource).
+// Once warmed up, the only allocation left per image is its pixel buffer -- none at all when loading into an Image of the same size.
+// It also holds the decoding options, such as the pixel format images come out in,
+// or which chunk CRCs are checked, or a callback showing interlaced (Adam7) images pass by pass while they load, or to decode large images on three threads.
+// Built with FILL_DECODE_STATS, it also times each stage of every decode (see decode_stats.hpp).
+// A Decoder is not thread safe: use one per thread.
+// ===================================================
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <span>
+
+#include "decode_stats.hpp"
+#include "pixel_buffer.hpp"
+
+namespace fill
+{
+
+	class Image;
+
+	// Pixel format of decoded images
+	enum class PixelFormat
+		: std::uint8_t
+	{
+		Native, /*closest to the file: 1/2/4 bit greyscale is scaled to 8 bits, palettes become RGB (RGBA with transparency), tRNS keys an alpha channel, 16 bit samples stay 16 bit (big endian)*/
+		RGBA8   /*always 4 channels of 8 bits, 16 bit samples keep their high byte*/
+	};
+
+	// What inflates the image data
+	enum class InflateBackend
+		: std::uint8_t
+	{
+		Zlib,   /*zlib, streaming: a scanline at a time, the least memory*/
+		Builtin /*FILL's own, table driven: the whole stream at once, into a buffer holding every scanline. Inflates 1.5 to 6 times as fast*/
+	};
+
+	// Chunks whose CRC is checked while decoding (see PNG spec, section 5.5)
+	enum class CrcCheck
+		: std::uint8_t
+	{
+		All,
+		Critical, /*IHDR, PLTE, IDAT and IEND (uppercase first letter): those the image is made of, as libpng does*/
+		None      /*for trusted files, e.g. written by the same program*/
+	};
+
+	// Default of DecodeOptions::inflater, chosen when building FILL (FILL_INFLATE_BACKEND)
+#if defined(FILL_INFLATE_BUILTIN)
+	inline constexpr InflateBackend default_inflate_backend{ InflateBackend::Builtin };
+#else
+	inline constexpr InflateBackend default_inflate_backend{ InflateBackend::Zlib };
+#endif
+
+	struct DecodeOptions
+	{
+		PixelFormat format{ PixelFormat::Native };
+
+		// Alignment, row pitch and memory of decoded pixels: rows are written padded, straight from the decoder
+		PixelLayout layout{};
+
+		// Called each time a pass of an interlaced image is complete (pass goes from 1 to 7), with the image decoded so far.
+		// Never called for non interlaced images, nor for empty passes (images under 8x8 have some). The image must not be modified, nor kept past the call.
+		std::function<void(const Image& image, std::uint32_t pass)> on_pass{};
+
+		// With on_pass: each pixel also fills the block later passes will refine, for a blocky preview of the whole image
+		// instead of scattered pixels over a blank one. Regions (see Image::loadRegion) are never replicated
+		bool replicate_pixels{ true };
+
+		// Reads, inflates and unfilters on three threads, so that unfiltering and expansion run while the next rows are inflated:
+		// a decode then takes about as long as inflating alone, given two free cores (one does most of the work, zlib being serial).
+		// Only for images whose inflated data is at least pipeline_min_bytes, down to the last row (see Image::loadRegion):
+		// two threads are started per image, which smaller ones don't make up for
+		bool pipelined{ false };
+		size_t pipeline_min_bytes{ 8 << 20 };
+
+		// Builtin decodes the same streams as zlib, reporting the same errors (worded its own way). Inflating at once, it is never pipelined
+		InflateBackend inflater{ default_inflate_backend };
+
+		// A mismatch throws. IDAT data is checked a slice at a time, just before it is inflated, so it is read from memory once:
+		// a wrong CRC is then only found once the slices before it have been decoded. Chunks after the image data are never read
+		CrcCheck crc_check{ CrcCheck::Critical };
+
+		// Called after each image is decoded, with its stats: the hook to export them. Never called without FILL_DECODE_STATS
+		std::function<void(const DecodeStats& stats)> on_stats{};
+	};
+
+	class Decoder
+	{
+	public:
+
+	// == Constructors
+
+		Decoder();
+
+		// The arena must outlive the decoder
+		explicit Decoder(std::pmr::memory_resource* arena);
+
+		explicit Decoder(const DecodeOptions& options, std::pmr::memory_resource* arena = nullptr);
+
+		Decoder(Decoder&&) noexcept;
+		Decoder& operator=(Decoder&&) noexcept;
+
+		~Decoder();
+
+
+	// == Actors
+
+		Image decode(const std::filesystem::path& path_to_file);
+
+		Image decode(std::span<const std::byte> file_bytes);
+
+
+	// == Getters
+
+		const DecodeOptions& getOptions() const noexcept;
+
+		// Stats of the last image decoded, and summed over every image since construction or resetStats. All 0 without FILL_DECODE_STATS
+		const DecodeStats& getLastStats() const noexcept;
+		const DecodeStats& getTotalStats() const noexcept;
+
+
+	// == Setters
+
+		void setOptions(const DecodeOptions& options);
+
+		void resetStats() noexcept;
+
+
+	private:
+		friend class Image;
+
+		struct State;
+
+		std::unique_ptr<State> state;
+	};
+
+} // fill
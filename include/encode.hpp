@@ -0,0 +1,41 @@
+#pragma once // encode.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// This file contains the options used by fill::Image when saving.
+//	- PNG rows are filtered one at a time, by default with the filter giving the minimum sum of absolute differences.
+//	- Filtered rows are compressed in strips, each strip on its own thread when a fill::ThreadPool is given,
+//	  and the strips are joined into a single zlib stream (as pigz does).
+// ===================================================
+
+#include <cstddef>
+#include <cstdint>
+
+namespace fill
+{
+
+	class ThreadPool;
+
+	struct EncodeOptions
+	{
+		enum class Filter
+			: std::int8_t
+		{
+			Adaptive = -1, /*cheapest of the five for every row*/
+			None,
+			Sub,
+			Up,
+			Average,
+			Paeth
+		};
+
+		Filter filter{ Filter::Adaptive };
+
+		int compression_level{ 6 }; /*0 (store) to 9 (smallest)*/
+
+		size_t strip_bytes{ 128 * 1024 }; /*filtered bytes per strip, strips only cost a few bytes each, but matches can't reach past the 32KB before them*/
+
+		ThreadPool* pool{ nullptr }; /*everything runs on the calling thread, in a single strip, without one*/
+	};
+
+} // fill
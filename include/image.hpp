@@ -5,32 +5,76 @@
 // This file contains a class containing an interface for my very own PNG loader.
 // Each image is treated as its own object for further modifications thereof.
 // This class is subject to modifications and change in its design:
-//	- Uses the library ZLIB for the DEFLATE algorithm.
-//	- Is only capable of reading the most primitive forms of PNG images (basic formats) -- non interlaced images.
-//	- Size of image cannot exceed 4GB.
-//	- If enabled, can concatenate two images to form a new one (e.g. creation of an atlas)
+//	- Uses the library ZLIB for the DEFLATE algorithm, or its own inflater (see DecodeOptions::inflater).
+//	- Reads every PNG color type and bit depth (palettes, tRNS transparency, 1 to 16 bits), interlaced (Adam7) or not.
+//	- Checks chunk CRCs, all of them, those of critical chunks only (by default) or none (see DecodeOptions::crc_check).
+//	- Interlaced images can be shown pass by pass while they load (see DecodeOptions::on_pass).
+//	- Can be decoded as stored or expanded to 8 bit RGBA (see DecodeOptions).
+//	- Size and format can be read from the header alone, without decoding (see probe.hpp).
+//	- A region can be decoded on its own, inflating only up to its last row.
+//	- Large images can be decoded pipelined, inflating on one thread while unfiltering on another (see DecodeOptions::pipelined).
+//	- Decoding can be timed stage by stage, built with FILL_DECODE_STATS (see decode_stats.hpp).
+//	- Can save to PNG, with adaptive filtering and multithreaded compression.
+//	- Loads and saves uncompressed PAM, PPM and PGM files, which can also be mapped and viewed in place (see pnm.hpp).
+//	- Width and height are 32 bit, the pixel buffer's size is only limited by memory.
+//	- Pixels are aligned (64 bytes by default), rows can be padded to any power of two pitch, at decode time too (see pixel_buffer.hpp).
+//	- Can pack many images into a single one, an atlas (see atlas.hpp).
+//	- Can copy any area of an image into another (blit), converting between 8 bit formats.
+//	- Can be viewed and cropped without copying (see image_view.hpp), views can be blitted, resized and encoded.
+//	- Can be resampled with nearest, bilinear, box, Lanczos3 or Kaiser filters, or reduced to a full mip chain.
 //
 // See: https://www.w3.org/TR/2003/REC-PNG-20031110
 // ===================================================
 
 
 // Reading files
-#include <fstream>
 #include <filesystem>
+#include <span>
 // Sorting data
 #include <string>
 #include <vector>
+#include <cstddef>
 #include <cstdint>
 
 #include <algorithm>
 #include <cctype>
 // DEFLATE algorithm
 #include "zlib.h"
+// Reusable decoding state
+#include "decoder.hpp"
+// Non-owning views, and areas of images
+#include "image_view.hpp"
+// Aligned, padded pixel storage
+#include "pixel_buffer.hpp"
+// Uncompressed files
+#include "pnm.hpp"
 
 struct Chunk;
 
 namespace fill
 {
+	struct Atlas;
+	struct AtlasOptions;
+	struct EncodeOptions;
+	struct Mipmaps;
+	struct MipmapOptions;
+	class ThreadPool;
+}
+
+namespace fill
+{
+
+	// Resampling filters, from fastest to sharpest
+	enum class ResizeFilter
+		: std::uint8_t
+	{
+		Nearest,
+		Bilinear,
+		Box, /*averages every covered pixel, the usual choice for downscaling by whole factors*/
+		Lanczos3,
+		Kaiser /*Kaiser windowed sinc, sharp with little ringing, the usual choice for mipmaps*/
+	};
+
 
 	class Image
 	{
@@ -40,22 +84,89 @@ namespace fill
 
 		Image(const std::filesystem::path& path_to_file);
 
+		// Decodes an image already in memory (e.g. extracted from an archive), the bytes are not copied
+		explicit Image(std::span<const std::byte> file_bytes);
+
 		Image(Image&&) noexcept = default;
 		Image& operator=(Image&&) noexcept = default;  
 
 		Image() noexcept = default;
 
+		// Blank (zeroed) image of the given format, rows laid out as layout says
+		Image(std::uint32_t width, std::uint32_t height, std::uint8_t color_channel, std::uint8_t bit_depth = 8, const PixelLayout& layout = {});
+
 
 	// == Actors 
 
+		// Format is picked from the extension: .png, or .pam, .ppm, .pgm and .pnm (see pnm.hpp)
 		void loadFromFile(const std::filesystem::path& path_to_file);
 
-		Image merge_images(const Image& image, bool merge_horizontaly=true);
+		// Format is recognized from the signature, the bytes only need to outlive the call
+		void loadFromMemory(std::span<const std::byte> file_bytes);
+
+		// Same as above, reusing the decoder's state and buffers (and this image's pixel buffer)
+		void loadFromFile(const std::filesystem::path& path_to_file, Decoder& decoder);
+
+		void loadFromMemory(std::span<const std::byte> file_bytes, Decoder& decoder);
+
+		// Decodes only region of the image (clipped to it), which becomes this image: rows below it are never inflated,
+		// rows above it are reconstructed one at a time and dropped, and only its columns are kept
+		void loadRegion(const std::filesystem::path& path_to_file, const Rect& region);
+
+		void loadRegion(std::span<const std::byte> file_bytes, const Rect& region);
+
+		void loadRegion(const std::filesystem::path& path_to_file, const Rect& region, Decoder& decoder);
+
+		void loadRegion(std::span<const std::byte> file_bytes, const Rect& region, Decoder& decoder);
+
+		// Format is picked from the extension: .png, .pam, .ppm or .pgm
+		void saveToFile(const std::filesystem::path& path_to_file) const;
+
+		void saveToFile(const std::filesystem::path& path_to_file, const EncodeOptions& options) const;
+
+		// Non interlaced PNG of this image's format, see encode.hpp
+		void saveToPNG(const std::filesystem::path& path_png) const;
+
+		void saveToPNG(const std::filesystem::path& path_png, const EncodeOptions& options) const;
+
+		std::vector<std::uint8_t> encodePNG(const EncodeOptions& options) const;
 
-		Image resize(std::uint32_t new_width, std::uint32_t new_height);
+		// Same as above, for any view (e.g. a crop of a larger image), which doesn't need to be contiguous
+		static void saveToPNG(const ImageView& source, const std::filesystem::path& path_png, const EncodeOptions& options);
 
+		static std::vector<std::uint8_t> encodePNG(const ImageView& source, const EncodeOptions& options);
+
+		// Binary PAM, PPM or PGM of this image's format (8 or 16 bit), see pnm.hpp. PPM and PGM only hold RGB and greyscale images
+		void saveToPNM(const std::filesystem::path& path_pnm, PnmType type = PnmType::PAM) const;
+
+		static void saveToPNM(const ImageView& source, const std::filesystem::path& path_pnm, PnmType type = PnmType::PAM);
+
+		static std::vector<std::uint8_t> encodePNM(const ImageView& source, PnmType type = PnmType::PAM);
+
+		// Packs all images, which must share one pixel format, into a texture atlas (see atlas.hpp)
+		static Atlas merge_images(std::span<const Image* const> images, const AtlasOptions& options);
+
+		// Resamples into a new image of the same format and layout (8 bit only), bands of rows are spread over pool when one is given
+		Image resize(std::uint32_t new_width, std::uint32_t new_height, ResizeFilter filter = ResizeFilter::Bilinear, ThreadPool* pool = nullptr) const;
+
+		static Image resize(const ImageView& source, std::uint32_t new_width, std::uint32_t new_height, ResizeFilter filter = ResizeFilter::Bilinear, ThreadPool* pool = nullptr, const PixelLayout& layout = {});
+
+		// Full mip chain down to 1x1 in one buffer, box filtered (see mipmap.hpp), 8 bit only
+		Mipmaps generateMipmaps() const;
+
+		Mipmaps generateMipmaps(const MipmapOptions& options) const;
+
+		// New image as large as both, in this image's format, filled with 0xFF and this image drawn offset pixels to the right.
+		// Only the size of other is used
 		Image insert(Image& other, std::uint32_t offset);
 
+		// Copies source_rect of source with its top left corner at (x, y), clipped to both images.
+		// Rows are copied as is when formats match, and converted when only the channel count differs (8 bit only).
+		// source may be (part of) this image, the areas may overlap
+		void blit(const ImageView& source, std::int32_t x, std::int32_t y, const Rect& source_rect);
+
+		void blit(const ImageView& source, std::int32_t x = 0, std::int32_t y = 0);
+
 
 	// == Getters
 
@@ -64,41 +175,68 @@ namespace fill
 		
 		std::uint8_t getBitDepth() const noexcept { return bit_depth; }
 		std::uint8_t getColorChannel() const noexcept { return color_channel; }
+		std::uint8_t getBytesPerPixel() const noexcept { return bpp; }
+
+		// Bytes from one row to the next, width * bpp when rows are packed
+		size_t getPitch() const noexcept { return pitch; }
+
+		const PixelLayout& getLayout() const noexcept { return layout; }
 
-		// size in bytes
-		const size_t size() const noexcept { return image_data.size(); }
-		const std::uint32_t size_bytes() const noexcept { return width * height * bpp; }
+		// size in bytes, row padding included
+		size_t size() const noexcept { return image_data.size(); }
+		size_t size_bytes() const noexcept { return pitch * height; }
 
 		const std::uint8_t* data() const noexcept { return image_data.data(); }
 		std::uint8_t* data() noexcept { return image_data.data(); }
 
-		std::vector<std::uint8_t>& getImage() noexcept { return image_data; }
-		const std::vector<std::uint8_t>& getImage() const noexcept { return image_data; }
+		const std::uint8_t* row(std::uint32_t y) const noexcept { return image_data.data() + y * pitch; }
+		std::uint8_t* row(std::uint32_t y) noexcept { return image_data.data() + y * pitch; }
+
+		PixelBuffer& getImage() noexcept { return image_data; }
+		const PixelBuffer& getImage() const noexcept { return image_data; }
+
+		// All of the image, valid until its pixels are reallocated (e.g. by loading another image into it)
+		ImageView view() const { return { image_data.data(), width, height, pitch, color_channel, bit_depth }; }
+
+		operator ImageView() const { return view(); }
 
 
 
 	// == Setters
 
-		void setWidth(std::uint32_t new_width) noexcept { width = new_width; }
+		// The pixel buffer follows, its pitch as layout says: existing pixels keep their place, new ones are zeroed
+		void setWidth(std::uint32_t new_width);
 
-		void setHeight(std::uint32_t new_height) noexcept { height = new_height; }
+		void setHeight(std::uint32_t new_height);
 
 
 	private: 
 		/*Actor Functions*/
 
-		void loadFromPNG(const std::filesystem::path& path_png);
+		// Sizes the pixel buffer for width, height and bpp as layout says. Existing pixels are kept, new ones are zeroed
+		void allocate();
+
+		void loadFromPNG(const std::filesystem::path& path_png, Decoder& decoder);
+
+		// Decodes only region when there is one
+		void loadFromPNG(std::span<const std::uint8_t> png_bytes, Decoder& decoder, const Rect* region = nullptr);
+
+		static void read_PNGchunk(std::span<const std::uint8_t>& stream, Chunk& chunk);
+
+		void loadFromPNM(const std::filesystem::path& path_pnm, Decoder& decoder);
 
-		void read_PNGchunk(std::ifstream& stream, Chunk& chunk);
+		void loadFromPNM(std::span<const std::uint8_t> pnm_bytes, Decoder& decoder, const Rect* region = nullptr);
 
-		void unfilter_PNG(std::vector<std::uint8_t>& filtered_data);
+		void unfilter_PNG(Decoder& decoder, const Rect& region);
 
 
 
 	private: /*Members*/
 
 
-		std::vector<std::uint8_t> image_data{};
+		PixelBuffer image_data{};
+		PixelLayout layout{};
+		size_t pitch{};
 
 		std::uint32_t width{}, height{};
 		std::uint8_t bit_depth{};
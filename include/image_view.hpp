@@ -0,0 +1,76 @@
+#pragma once // image_view.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// This file contains a non-owning view of pixels, for handing part of an image around without copying it.
+//	- A view is a pointer, a size, a stride (bytes from one row to the next) and a pixel format.
+//	- Cropping only moves the pointer and shrinks the size: a sub-view shares the rows of its parent, whatever their stride.
+//	- fill::Image converts to a view of all of its pixels; blit, resize and encoding accept views as their source.
+//	- A view doesn't keep its pixels alive: whatever owns them must outlive it.
+// ===================================================
+
+#include <cstddef>
+#include <cstdint>
+
+namespace fill
+{
+
+	// Area of an image, in pixels
+	struct Rect
+	{
+		std::uint32_t x{}, y{};
+		std::uint32_t width{}, height{};
+	};
+
+
+	class ImageView
+	{
+	public:
+
+	// == Constructors
+
+		ImageView() noexcept = default;
+
+		// stride is in bytes, and at least width * bytes per pixel
+		ImageView(const std::uint8_t* pixels, std::uint32_t width, std::uint32_t height, size_t stride, std::uint8_t color_channel, std::uint8_t bit_depth = 8);
+
+
+	// == Actors
+
+		// Area of this view, clipped to it, sharing its pixels
+		ImageView crop(const Rect& area) const noexcept;
+
+
+	// == Getters
+
+		std::uint32_t getWidth() const noexcept { return width; }
+		std::uint32_t getHeight() const noexcept { return height; }
+
+		size_t getStride() const noexcept { return stride; }
+
+		std::uint8_t getBitDepth() const noexcept { return bit_depth; }
+		std::uint8_t getColorChannel() const noexcept { return color_channel; }
+		std::uint8_t getBytesPerPixel() const noexcept { return bpp; }
+
+		const std::uint8_t* data() const noexcept { return pixels; }
+		const std::uint8_t* row(std::uint32_t y) const noexcept { return pixels + y * stride; }
+
+		bool empty() const noexcept { return width == 0 || height == 0; }
+
+		// Rows follow each other with no gap, the pixels can be handled as one block
+		bool contiguous() const noexcept { return stride == static_cast<size_t>(width) * bpp; }
+
+
+	private: /*Members*/
+
+		const std::uint8_t* pixels{};
+
+		std::uint32_t width{}, height{};
+		size_t stride{};
+
+		std::uint8_t bit_depth{};
+		std::uint8_t color_channel{};
+		std::uint8_t bpp{};
+	};
+
+} // fill
@@ -0,0 +1,59 @@
+#pragma once // mipmap.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// This file contains the mip chain types used by fill::Image::generateMipmaps.
+//	- Every level, from the image itself down to 1x1, lives in one contiguous buffer, each level at an offset given by the level table.
+//	- Level n is max(1, width >> n) x max(1, height >> n): odd sizes drop their last row or column, as GPUs expect.
+//	- The box filter reduces the image one tile at a time, taking each tile through as many levels as it can while it is still in cache.
+//	- The Kaiser filter is sharper, and works one level at a time from the level above it.
+//	- Gamma correct (sRGB) filtering averages colours in linear light, alpha is always linear.
+// ===================================================
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace fill
+{
+
+	class ThreadPool;
+
+	struct MipmapOptions
+	{
+		enum class Filter
+			: std::uint8_t
+		{
+			Box, /*2x2 average*/
+			Kaiser
+		};
+
+		Filter filter{ Filter::Box };
+
+		bool srgb{ false }; /*colour channels are sRGB encoded, filter them in linear light*/
+
+		ThreadPool* pool{ nullptr }; /*everything runs on the calling thread without one*/
+	};
+
+	struct MipLevel
+	{
+		std::uint32_t width{}, height{};
+
+		size_t offset{}; /*in bytes, from the start of Mipmaps::data*/
+		size_t size{};   /*in bytes*/
+	};
+
+	struct Mipmaps
+	{
+		std::vector<std::uint8_t> data{};
+		std::vector<MipLevel> levels{}; /*levels[0] is the full size image*/
+
+		std::uint8_t color_channel{};
+		std::uint8_t bpp{};
+
+		std::span<const std::uint8_t> level(size_t index) const { return { data.data() + levels[index].offset, levels[index].size }; }
+		std::span<std::uint8_t> level(size_t index) { return { data.data() + levels[index].offset, levels[index].size }; }
+	};
+
+} // fill
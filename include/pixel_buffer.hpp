@@ -0,0 +1,109 @@
+#pragma once // pixel_buffer.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// This file contains how fill::Image lays out and allocates its pixels.
+//	- PixelLayout picks the alignment of the first pixel and of every row: rows are padded to a pitch, e.g. 256 bytes for GPU uploads.
+//	- PixelAllocator makes aligned allocations from any std::pmr::memory_resource, so pixels can live in a caller provided arena.
+//	- PixelBuffer is the vector holding an image's pixels, rows pitch bytes apart.
+// Padding bytes at the end of rows are never read, and their content is unspecified.
+// ===================================================
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <type_traits>
+#include <vector>
+
+namespace fill
+{
+
+	template <typename T>
+	class PixelAllocator
+	{
+	public:
+		using value_type = T;
+
+		// Buffers keep their allocator when moved or swapped between images
+		using propagate_on_container_copy_assignment = std::true_type;
+		using propagate_on_container_move_assignment = std::true_type;
+		using propagate_on_container_swap = std::true_type;
+
+
+	// == Constructors
+
+		PixelAllocator() noexcept = default;
+
+		// The resource must outlive every buffer allocated from it, alignment is a power of two
+		PixelAllocator(std::pmr::memory_resource* resource, size_t alignment) noexcept
+			: resource{ resource ? resource : std::pmr::get_default_resource() }
+			, alignment{ alignment }
+		{
+		}
+
+		template <typename U>
+		PixelAllocator(const PixelAllocator<U>& other) noexcept
+			: resource{ other.getResource() }
+			, alignment{ other.getAlignment() }
+		{
+		}
+
+
+	// == Actors
+
+		T* allocate(size_t count)
+		{
+			return static_cast<T*>(resource->allocate(count * sizeof(T), std::max(alignment, alignof(T))));
+		}
+
+		void deallocate(T* pointer, size_t count) noexcept
+		{
+			resource->deallocate(pointer, count * sizeof(T), std::max(alignment, alignof(T)));
+		}
+
+
+	// == Getters
+
+		std::pmr::memory_resource* getResource() const noexcept { return resource; }
+		size_t getAlignment() const noexcept { return alignment; }
+
+		template <typename U>
+		bool operator==(const PixelAllocator<U>& other) const noexcept { return resource == other.getResource() && alignment == other.getAlignment(); }
+
+
+	private:
+		std::pmr::memory_resource* resource{ std::pmr::get_default_resource() };
+		size_t alignment{ 64 };
+	};
+
+	using PixelBuffer = std::vector<std::uint8_t, PixelAllocator<std::uint8_t>>;
+
+
+	struct PixelLayout
+	{
+		size_t alignment{ 64 };     /*of the first pixel, a power of two: 64 bytes is a cache line, and suits every SIMD load*/
+		size_t row_alignment{ 1 };  /*of every row, a power of two: the pitch is rounded up to a multiple of it, 1 packs rows*/
+
+		std::pmr::memory_resource* resource{ nullptr }; /*pixels are allocated from the default resource without one*/
+
+
+		bool valid() const noexcept
+		{
+			return alignment != 0 && (alignment & (alignment - 1)) == 0 && row_alignment != 0 && (row_alignment & (row_alignment - 1)) == 0;
+		}
+
+		// Bytes from one row to the next
+		size_t pitch(std::uint32_t width, size_t bpp) const noexcept
+		{
+			return (static_cast<size_t>(width) * bpp + row_alignment - 1) & ~(row_alignment - 1);
+		}
+
+		// Aligned for the first pixel and for every row
+		PixelAllocator<std::uint8_t> allocator() const noexcept
+		{
+			return { resource, std::max(alignment, row_alignment) };
+		}
+	};
+
+} // fill
@@ -0,0 +1,68 @@
+#pragma once // pnm.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// This file contains what fill::Image reads and writes Netpbm files with: PAM (P7), PPM (P6) and PGM (P5), binary only.
+// Being uncompressed, they hand images from one stage of a pipeline to the next at the speed of the disk:
+//	- Loading copies the raster straight into the image (expanded as DecodeOptions says), there is nothing to inflate nor unfilter.
+//	- MappedImage doesn't even copy it: the file is mapped, and its pixels viewed where they lie (e.g. those of an RGBA8 PAM).
+//	- Any MAXVAL is read, scaled to 8 or 16 bits. Files are written with MAXVAL 255 or 65535.
+//
+// See: https://netpbm.sourceforge.net/doc/pam.html
+// ===================================================
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+
+#include "image_view.hpp"
+
+namespace fill
+{
+
+	namespace detail
+	{
+		class MappedFile;
+	}
+
+	enum class PnmType
+		: std::uint8_t
+	{
+		PAM, /*P7, 1 to 4 channels: grey, grey + alpha, RGB, RGBA*/
+		PPM, /*P6, RGB*/
+		PGM  /*P5, greyscale*/
+	};
+
+
+	// A PAM, PPM or PGM file, mapped and viewed in place: opening one costs the mapping alone, pages are read as rows are touched
+	class MappedImage
+	{
+	public:
+
+	// == Constructors
+
+		// Throws unless the samples can be used as stored: 8 bit (MAXVAL 255) or big endian 16 bit (65535), as fill::Image holds them
+		explicit MappedImage(const std::filesystem::path& path_to_file);
+
+		MappedImage(MappedImage&&) noexcept;
+		MappedImage& operator=(MappedImage&&) noexcept;
+
+		~MappedImage();
+
+
+	// == Getters
+
+		// Valid as long as this object, rows are packed
+		ImageView view() const noexcept { return pixels; }
+
+		operator ImageView() const noexcept { return pixels; }
+
+
+	private: /*Members*/
+
+		std::unique_ptr<detail::MappedFile> file;
+		ImageView pixels{};
+	};
+
+} // fill
@@ -0,0 +1,45 @@
+#pragma once // probe.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// This file contains fill::probe, reading what an image is without decoding it (e.g. to index a whole asset directory).
+//	- Only the signature and the IHDR chunk are read: the first 33 bytes of the file, in a single read -- nothing is mapped nor inflated.
+//	- The batched variant spreads files over a fill::ThreadPool, so indexing is bound by the file system rather than by decoding.
+// ===================================================
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+namespace fill
+{
+
+	class ThreadPool;
+
+	// Format of an image as stored in its file (see PNG spec, section 11.2.2)
+	struct ImageInfo
+	{
+		std::uint32_t width{}, height{};
+
+		std::uint8_t bit_depth{};     /*per sample, or per palette index*/
+		std::uint8_t color_type{};    /*0 = greyscale, 2 = RGB, 3 = indexed, 4 = grey + alpha, 6 = RGBA*/
+		std::uint8_t channels{};      /*samples per pixel in the file, 1 for indexed images*/
+
+		bool interlaced{ false };     /*Adam7*/
+
+		// Default constructed, i.e. the file couldn't be probed -- PNG images are never 0 pixels wide
+		explicit operator bool() const noexcept { return width != 0; }
+	};
+
+	// Throws on unreadable files and invalid headers, like loading would
+	ImageInfo probe(const std::filesystem::path& path_to_file);
+
+	ImageInfo probe(std::span<const std::byte> file_bytes);
+
+	// One info per path, in the same order. Files that cannot be probed are left default constructed (false), without throwing.
+	// Runs on the calling thread without a pool, blocks until every file is done otherwise (not to be called from one of its workers)
+	std::vector<ImageInfo> probe(std::span<const std::filesystem::path> paths, ThreadPool* pool = nullptr);
+
+} // fill
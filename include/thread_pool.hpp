@@ -0,0 +1,101 @@
+#pragma once // thread_pool.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// This file contains a small work-stealing thread pool, shared by FILL's parallel algorithms.
+//	- Every worker owns a task deque: it pops its own tasks from the back, and steals from the front of the others' when idle.
+//	- Tasks submitted from a worker go to that worker's deque, others are spread round-robin.
+//	- current_worker() lets a task pick per-worker state (e.g. one fill::Decoder per thread) without locking.
+//	- An exception thrown by a task is caught by its worker, and the first one is rethrown by wait().
+// ===================================================
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace fill
+{
+
+	class ThreadPool
+	{
+	public:
+
+	// == Constructors
+
+		// 0 threads means one per hardware thread
+		explicit ThreadPool(unsigned thread_count = 0);
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		// Runs every task already submitted, then joins the workers
+		~ThreadPool();
+
+
+	// == Actors
+
+		void submit(std::function<void()> task);
+
+		template <typename Function>
+		auto async(Function&& function) -> std::future<std::invoke_result_t<Function>>
+		{
+			using Result = std::invoke_result_t<Function>;
+
+			auto task{ std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function)) };
+			std::future<Result> result{ task->get_future() };
+
+			submit([task]() { (*task)(); });
+
+			return result;
+		}
+
+		// Blocks until every submitted task has finished, then rethrows the first exception one of them threw since the last wait().
+		// Must not be called from a worker
+		void wait();
+
+
+	// == Getters
+
+		unsigned size() const noexcept { return static_cast<unsigned>(workers.size()); }
+
+		// Index of the calling thread in this pool, or -1 if it isn't one of its workers
+		int current_worker() const noexcept;
+
+
+	private:
+		struct Worker
+		{
+			std::mutex mutex;
+			std::deque<std::function<void()>> tasks;
+		};
+
+		void run(unsigned index);
+
+		bool try_pop(unsigned index, std::function<void()>& task);
+
+
+		std::vector<std::unique_ptr<Worker>> workers{};
+		std::vector<std::thread> threads{};
+
+		std::mutex sleep_mutex{};
+		std::condition_variable wake{}; /*tasks were queued, or the pool is stopping*/
+		std::condition_variable idle{}; /*the last unfinished task ended*/
+
+		std::atomic<size_t> queued{};
+		std::atomic<size_t> unfinished{};
+		std::atomic<unsigned> next_worker{};
+
+		bool stopping{};
+		std::exception_ptr failure{}; /*first one thrown by a task, guarded by sleep_mutex*/
+	};
+
+} // fill
@@ -0,0 +1,432 @@
+#include "atlas.hpp"
+#include "parallel.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+
+// Bin packers
+// Both place w x h rectangles in a bin, in the order they are given, and report false once one doesn't fit.
+
+namespace
+{
+
+	struct BinRect
+	{
+		std::uint32_t x{}, y{};
+		std::uint32_t width{}, height{};
+
+		std::uint32_t right() const noexcept { return x + width; }
+		std::uint32_t bottom() const noexcept { return y + height; }
+
+		bool contains(const BinRect& other) const noexcept
+		{
+			return other.x >= x && other.y >= y && other.right() <= right() && other.bottom() <= bottom();
+		}
+
+		bool intersects(const BinRect& other) const noexcept
+		{
+			return other.x < right() && x < other.right() && other.y < bottom() && y < other.bottom();
+		}
+	};
+
+
+	// MaxRects, best short side fit (see J. Jylanki, "A Thousand Ways to Pack the Bin")
+	class MaxRectsBin
+	{
+	public:
+		MaxRectsBin(std::uint32_t width, std::uint32_t height)
+			: free_rects{ BinRect{ 0, 0, width, height } }
+		{
+		}
+
+		bool insert(std::uint32_t width, std::uint32_t height, BinRect& placed)
+		{
+			std::uint32_t best_short{ UINT32_MAX }, best_long{ UINT32_MAX };
+			bool found{};
+
+			for (const BinRect& free : free_rects)
+			{
+				if (free.width < width || free.height < height)
+					continue;
+
+				const std::uint32_t left_x{ free.width - width }, left_y{ free.height - height };
+				const std::uint32_t short_side{ std::min(left_x, left_y) }, long_side{ std::max(left_x, left_y) };
+
+				if (short_side < best_short || (short_side == best_short && long_side < best_long))
+				{
+					placed = BinRect{ free.x, free.y, width, height };
+					best_short = short_side;
+					best_long = long_side;
+					found = true;
+				}
+			}
+
+			if (found)
+				split(placed);
+
+			return found;
+		}
+
+	private:
+		// Replaces every free rectangle overlapping used by the (up to 4) maximal ones left around it
+		void split(const BinRect& used)
+		{
+			const auto kept_end{ static_cast<size_t>(std::partition(free_rects.begin(), free_rects.end(),
+				[&](const BinRect& free) { return !free.intersects(used); }) - free_rects.begin()) };
+
+			new_rects.clear();
+
+			for (size_t i{ kept_end }; i < free_rects.size(); i++)
+			{
+				const BinRect free{ free_rects[i] };
+
+				if (used.x > free.x)
+					new_rects.push_back({ free.x, free.y, used.x - free.x, free.height });
+				if (used.right() < free.right())
+					new_rects.push_back({ used.right(), free.y, free.right() - used.right(), free.height });
+				if (used.y > free.y)
+					new_rects.push_back({ free.x, free.y, free.width, used.y - free.y });
+				if (used.bottom() < free.bottom())
+					new_rects.push_back({ free.x, used.bottom(), free.width, free.bottom() - used.bottom() });
+			}
+
+			free_rects.resize(kept_end);
+
+			// Kept rectangles never contain each other, nor can one of them sit inside a new one:
+			// only new rectangles need checking, against everything else
+			for (size_t i{}; i < new_rects.size(); i++)
+			{
+				const BinRect& candidate{ new_rects[i] };
+
+				const bool redundant{
+					std::any_of(free_rects.begin(), free_rects.end(), [&](const BinRect& free) { return free.contains(candidate); }) ||
+					std::any_of(new_rects.begin() + i + 1, new_rects.end(), [&](const BinRect& other) { return other.contains(candidate); }) ||
+					std::any_of(new_rects.begin(), new_rects.begin() + i, [&](const BinRect& other) { return other.contains(candidate) && !candidate.contains(other); }) };
+
+				if (!redundant)
+					free_rects.push_back(candidate);
+			}
+		}
+
+
+		std::vector<BinRect> free_rects{};
+		std::vector<BinRect> new_rects{}; /*scratch*/
+	};
+
+
+	// Skyline, bottom left: the lowest position the rectangle fits at, leftmost on ties
+	class SkylineBin
+	{
+	public:
+		SkylineBin(std::uint32_t width, std::uint32_t height)
+			: bin_width{ width }
+			, bin_height{ height }
+			, skyline{ Segment{ 0, 0, width } }
+		{
+		}
+
+		bool insert(std::uint32_t width, std::uint32_t height, BinRect& placed)
+		{
+			std::uint32_t best_bottom{ UINT32_MAX };
+			size_t best_index{ skyline.size() };
+
+			for (size_t i{}; i < skyline.size(); i++)
+			{
+				std::uint32_t y{};
+
+				if (fits(i, width, height, y) && y + height < best_bottom)
+				{
+					best_bottom = y + height;
+					best_index = i;
+					placed = BinRect{ skyline[i].x, y, width, height };
+				}
+			}
+
+			if (best_index == skyline.size())
+				return false;
+
+			raise(best_index, placed);
+			return true;
+		}
+
+	private:
+		struct Segment
+		{
+			std::uint32_t x{}, y{};
+			std::uint32_t width{};
+		};
+
+		// Height at which a rectangle starting at segment index rests, over all the segments it spans
+		bool fits(size_t index, std::uint32_t width, std::uint32_t height, std::uint32_t& y) const
+		{
+			if (skyline[index].x + width > bin_width)
+				return false;
+
+			std::int64_t width_left{ width };
+			y = 0;
+
+			for (size_t i{ index }; width_left > 0; i++)
+			{
+				y = std::max(y, skyline[i].y);
+
+				if (y + height > bin_height)
+					return false;
+
+				width_left -= skyline[i].width;
+			}
+
+			return true;
+		}
+
+		void raise(size_t index, const BinRect& placed)
+		{
+			skyline.insert(skyline.begin() + index, Segment{ placed.x, placed.bottom(), placed.width });
+
+			// Trim or drop the segments now under the new one
+			for (size_t i{ index + 1 }; i < skyline.size();)
+			{
+				Segment& segment{ skyline[i] };
+
+				if (segment.x >= placed.right())
+					break;
+
+				const std::uint32_t covered{ placed.right() - segment.x };
+
+				if (covered >= segment.width)
+				{
+					skyline.erase(skyline.begin() + i);
+					continue;
+				}
+
+				segment.x += covered;
+				segment.width -= covered;
+				break;
+			}
+
+			// Merge neighbours of equal height
+			for (size_t i{ 1 }; i < skyline.size();)
+			{
+				if (skyline[i - 1].y == skyline[i].y)
+				{
+					skyline[i - 1].width += skyline[i].width;
+					skyline.erase(skyline.begin() + i);
+				}
+				else
+					i++;
+			}
+		}
+
+
+		std::uint32_t bin_width{}, bin_height{};
+		std::vector<Segment> skyline{};
+	};
+
+
+	template <typename Bin>
+	bool pack(std::uint32_t bin_width, std::uint32_t bin_height, const std::vector<size_t>& order, const std::vector<BinRect>& sizes, std::vector<BinRect>& placements)
+	{
+		Bin bin{ bin_width, bin_height };
+
+		for (const size_t index : order)
+			if (!bin.insert(sizes[index].width, sizes[index].height, placements[index]))
+				return false;
+
+		return true;
+	}
+
+	std::uint32_t next_power_of_two(std::uint32_t value) noexcept
+	{
+		std::uint32_t power{ 1 };
+		while (power < value)
+			power <<= 1;
+
+		return power;
+	}
+
+
+	struct CopyJob
+	{
+		const fill::Image* source{};
+		std::uint32_t x{}, y{};
+		std::uint32_t first_row{}, last_row{};
+	};
+
+	void copy_rows(const CopyJob& job, fill::Image& atlas)
+	{
+		const fill::Rect band{ 0, job.first_row, job.source->getWidth(), job.last_row - job.first_row };
+
+		atlas.blit(*job.source, static_cast<std::int32_t>(job.x), static_cast<std::int32_t>(job.y + job.first_row), band);
+	}
+
+} // namespace
+
+
+// --- Atlas
+
+fill::Atlas fill::Image::merge_images(std::span<const Image* const> images, const AtlasOptions& options)
+{
+	Atlas atlas{};
+
+	if (images.empty())
+		return atlas;
+
+	const Image& first{ *images.front() };
+
+	for (const Image* image : images)
+	{
+		if (image->getBytesPerPixel() != first.getBytesPerPixel() || image->getColorChannel() != first.getColorChannel() || image->getBitDepth() != first.getBitDepth())
+			throw std::runtime_error("ERROR::ATLAS::All images must share the same pixel format");
+		if (image->size() < image->size_bytes())
+			throw std::runtime_error("ERROR::ATLAS::Image holds fewer pixels than its dimensions describe");
+	}
+
+	const std::uint32_t padding{ options.padding };
+
+	// Every image is packed with its padding on the right and bottom, in a bin offset by the padding: borders get it too
+	std::vector<BinRect> sizes(images.size());
+	std::uint64_t area{};
+	std::uint32_t widest{}, tallest{};
+
+	for (size_t i{}; i < images.size(); i++)
+	{
+		sizes[i] = BinRect{ 0, 0, images[i]->getWidth() + padding, images[i]->getHeight() + padding };
+
+		area += static_cast<std::uint64_t>(sizes[i].width) * sizes[i].height;
+		widest = std::max(widest, sizes[i].width);
+		tallest = std::max(tallest, sizes[i].height);
+	}
+
+	// Largest first packs much tighter
+	std::vector<size_t> order(images.size());
+	std::iota(order.begin(), order.end(), size_t{});
+
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+	{
+		if (options.packer == AtlasOptions::Packer::Skyline)
+			return sizes[a].height > sizes[b].height;
+
+		return std::max(sizes[a].width, sizes[a].height) > std::max(sizes[b].width, sizes[b].height);
+	});
+
+	// Start from a square a little larger than the total area (packers never reach 100%), grow the shorter side until everything fits
+	const auto side{ static_cast<std::uint32_t>(std::ceil(std::sqrt(static_cast<double>(area) * 1.05))) };
+
+	std::uint32_t atlas_width{ std::max(widest, side) + padding };
+	std::uint32_t atlas_height{ std::max<std::uint32_t>(tallest, static_cast<std::uint32_t>(area * 1.05 / std::max(widest, side))) + padding };
+
+	if (options.power_of_two)
+	{
+		// Rounding both sides up could quadruple the area: round the width down instead when the height makes up for it
+		const std::uint32_t lower_width{ next_power_of_two(atlas_width) / 2 };
+
+		if (lower_width >= widest + padding)
+		{
+			atlas_width = lower_width;
+			atlas_height = std::max(tallest, static_cast<std::uint32_t>(area * 1.05 / lower_width)) + padding;
+		}
+	}
+
+	std::vector<BinRect> placements(images.size());
+
+	while (true)
+	{
+		if (options.power_of_two)
+		{
+			atlas_width = next_power_of_two(atlas_width);
+			atlas_height = next_power_of_two(atlas_height);
+		}
+
+		if (atlas_width > options.max_size || atlas_height > options.max_size)
+			throw std::runtime_error("ERROR::ATLAS::Images don't fit in an atlas of " + std::to_string(options.max_size) + " pixels per side");
+
+		const bool packed{ options.packer == AtlasOptions::Packer::Skyline
+			? pack<SkylineBin>(atlas_width - padding, atlas_height - padding, order, sizes, placements)
+			: pack<MaxRectsBin>(atlas_width - padding, atlas_height - padding, order, sizes, placements) };
+
+		if (packed)
+			break;
+
+		std::uint32_t& shorter{ atlas_width <= atlas_height ? atlas_width : atlas_height };
+		shorter = options.power_of_two ? shorter * 2 : shorter + std::max(shorter / 8, 1u);
+	}
+
+	// Crop to what was used, unless the sides must stay powers of two
+	if (!options.power_of_two)
+	{
+		atlas_width = padding;
+		atlas_height = padding;
+
+		for (const BinRect& placement : placements)
+		{
+			atlas_width = std::max(atlas_width, placement.right() + padding);
+			atlas_height = std::max(atlas_height, placement.bottom() + padding);
+		}
+	}
+
+	atlas.image = Image{ atlas_width, atlas_height, first.getColorChannel(), first.getBitDepth() };
+	atlas.rects.resize(images.size());
+
+	for (size_t i{}; i < images.size(); i++)
+	{
+		AtlasRect& rect{ atlas.rects[i] };
+
+		rect.x = placements[i].x + padding;
+		rect.y = placements[i].y + padding;
+		rect.width = images[i]->getWidth();
+		rect.height = images[i]->getHeight();
+
+		rect.u0 = static_cast<float>(rect.x) / atlas_width;
+		rect.v0 = static_cast<float>(rect.y) / atlas_height;
+		rect.u1 = static_cast<float>(rect.x + rect.width) / atlas_width;
+		rect.v1 = static_cast<float>(rect.y + rect.height) / atlas_height;
+	}
+
+
+	// Copy the pixels, in jobs of roughly the same number of bytes: big images are cut in row bands, small ones grouped
+	constexpr size_t job_bytes{ 256 * 1024 };
+
+	std::vector<std::vector<CopyJob>> batches(1);
+	size_t batch_bytes{};
+
+	for (size_t i{}; i < images.size(); i++)
+	{
+		const size_t pitch{ std::max<size_t>(images[i]->getWidth() * static_cast<size_t>(first.getBytesPerPixel()), 1) };
+		const auto rows_per_job{ static_cast<std::uint32_t>(std::max<size_t>(job_bytes / pitch, 1)) };
+
+		for (std::uint32_t row{}; row < images[i]->getHeight(); row += rows_per_job)
+		{
+			const std::uint32_t last_row{ std::min(images[i]->getHeight(), row + rows_per_job) };
+
+			if (batch_bytes >= job_bytes)
+			{
+				batches.emplace_back();
+				batch_bytes = 0;
+			}
+
+			batches.back().push_back(CopyJob{ images[i], atlas.rects[i].x, atlas.rects[i].y, row, last_row });
+			batch_bytes += (last_row - row) * pitch;
+		}
+	}
+
+	if (!options.pool || batches.size() == 1)
+	{
+		for (const auto& batch : batches)
+			for (const CopyJob& job : batch)
+				copy_rows(job, atlas.image);
+	}
+	else
+	{
+		fill::detail::for_each_task(*options.pool, batches.size(), [&](size_t batch)
+		{
+			for (const CopyJob& job : batches[batch])
+				copy_rows(job, atlas.image);
+		});
+	}
+
+	return atlas;
+}
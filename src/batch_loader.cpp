@@ -0,0 +1,82 @@
+#include "batch_loader.hpp"
+
+
+fill::BatchLoader::BatchLoader(unsigned thread_count)
+	: pool{ thread_count }
+{
+	decoders.resize(pool.size());
+}
+
+
+std::vector<std::future<fill::Image>> fill::BatchLoader::load(std::span<const std::filesystem::path> paths)
+{
+	std::vector<std::future<Image>> images{};
+	images.reserve(paths.size());
+
+	for (const auto& path : paths)
+		images.push_back(pool.async([this, path]() { return worker_decoder().decode(path); }));
+
+	return images;
+}
+
+std::vector<std::future<fill::Image>> fill::BatchLoader::load(std::span<const std::span<const std::byte>> buffers)
+{
+	std::vector<std::future<Image>> images{};
+	images.reserve(buffers.size());
+
+	for (const auto buffer : buffers)
+		images.push_back(pool.async([this, buffer]() { return worker_decoder().decode(buffer); }));
+
+	return images;
+}
+
+void fill::BatchLoader::load(std::span<const std::filesystem::path> paths, Callback on_complete)
+{
+	for (size_t index{}; index < paths.size(); index++)
+	{
+		pool.submit([this, index, path = paths[index], on_complete]()
+		{
+			Image image{};
+			std::exception_ptr error{};
+
+			try
+			{
+				image.loadFromFile(path, worker_decoder());
+			}
+			catch (...)
+			{
+				error = std::current_exception();
+			}
+
+			on_complete(index, std::move(image), error);
+		});
+	}
+}
+
+void fill::BatchLoader::load(std::span<const std::span<const std::byte>> buffers, Callback on_complete)
+{
+	for (size_t index{}; index < buffers.size(); index++)
+	{
+		pool.submit([this, index, buffer = buffers[index], on_complete]()
+		{
+			Image image{};
+			std::exception_ptr error{};
+
+			try
+			{
+				image.loadFromMemory(buffer, worker_decoder());
+			}
+			catch (...)
+			{
+				error = std::current_exception();
+			}
+
+			on_complete(index, std::move(image), error);
+		});
+	}
+}
+
+void fill::BatchLoader::wait()
+{
+	pool.wait();
+}
@@ -0,0 +1,22 @@
+#pragma once // byte_order.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// Internal header: integers as PNG and zlib streams store them, most significant byte first.
+// ===================================================
+
+#include <cstdint>
+#include <vector>
+
+namespace fill::detail
+{
+
+	inline void write_uint32(std::vector<std::uint8_t>& out, std::uint32_t value)
+	{
+		out.push_back(static_cast<std::uint8_t>(value >> 24));
+		out.push_back(static_cast<std::uint8_t>(value >> 16));
+		out.push_back(static_cast<std::uint8_t>(value >> 8));
+		out.push_back(static_cast<std::uint8_t>(value));
+	}
+
+} // fill::detail
@@ -0,0 +1,104 @@
+#include "convert.hpp"
+
+#include <cstring>
+
+
+// Scalar kernels
+
+namespace
+{
+
+	struct Pixel
+	{
+		std::uint8_t r{}, g{}, b{}, a{ 0xFF };
+	};
+
+	template <std::uint8_t Channels>
+	Pixel read(const std::uint8_t* p) noexcept
+	{
+		if constexpr (Channels == 1)
+			return { p[0], p[0], p[0] };
+		else if constexpr (Channels == 2)
+			return { p[0], p[0], p[0], p[1] };
+		else if constexpr (Channels == 3)
+			return { p[0], p[1], p[2] };
+		else
+			return { p[0], p[1], p[2], p[3] };
+	}
+
+	template <std::uint8_t Channels>
+	void write(std::uint8_t* p, const Pixel& pixel) noexcept
+	{
+		if constexpr (Channels <= 2)
+		{
+			p[0] = static_cast<std::uint8_t>((pixel.r * 77 + pixel.g * 150 + pixel.b * 29) >> 8); /*weights sum to 256*/
+
+			if constexpr (Channels == 2)
+				p[1] = pixel.a;
+		}
+		else
+		{
+			p[0] = pixel.r;
+			p[1] = pixel.g;
+			p[2] = pixel.b;
+
+			if constexpr (Channels == 4)
+				p[3] = pixel.a;
+		}
+	}
+
+	template <std::uint8_t Source, std::uint8_t Destination>
+	void convert(const std::uint8_t* source, std::uint8_t* destination, size_t pixels)
+	{
+		if constexpr (Source == Destination)
+			std::memcpy(destination, source, pixels * Source);
+		else
+		{
+			for (size_t i{}; i < pixels; i++)
+				write<Destination>(destination + i * Destination, read<Source>(source + i * Source));
+		}
+	}
+
+	template <std::uint8_t Source>
+	fill::detail::ConvertKernel scalar_kernel(std::uint8_t destination_channels) noexcept
+	{
+		switch (destination_channels)
+		{
+		case 1: return convert<Source, 1>;
+		case 2: return convert<Source, 2>;
+		case 3: return convert<Source, 3>;
+		case 4: return convert<Source, 4>;
+		default: return nullptr;
+		}
+	}
+
+} // namespace
+
+
+// Dispatch
+
+fill::detail::ConvertKernel fill::detail::convert_kernel(SimdLevel level, std::uint8_t source_channels, std::uint8_t destination_channels) noexcept
+{
+	ConvertKernel kernel{};
+
+	switch (source_channels)
+	{
+	case 1: kernel = scalar_kernel<1>(destination_channels); break;
+	case 2: kernel = scalar_kernel<2>(destination_channels); break;
+	case 3: kernel = scalar_kernel<3>(destination_channels); break;
+	case 4: kernel = scalar_kernel<4>(destination_channels); break;
+	default: return nullptr;
+	}
+
+#if defined(FILL_X86_SIMD)
+	if (kernel && level >= SimdLevel::SSSE3)
+	{
+		if (const ConvertKernel specialized{ ssse3_convert_kernel(source_channels, destination_channels) })
+			kernel = specialized;
+	}
+#else
+	(void)level;
+#endif
+
+	return kernel;
+}
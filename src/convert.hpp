@@ -0,0 +1,38 @@
+#pragma once // convert.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// Internal header: 8 bit pixel format conversion, one row at a time.
+//	- Channels are 1 = grey, 2 = grey + alpha, 3 = RGB, 4 = RGBA.
+//	- Added alpha is opaque, colour to grey uses integer Rec. 601 luma.
+//	- RGB <-> RGBA, the common case when packing or blitting, has SSSE3 kernels.
+// ===================================================
+
+#include <cstddef>
+#include <cstdint>
+
+#include "simd.hpp"
+
+namespace fill::detail
+{
+
+	// Converts pixels pixels from source (source_channels per pixel) to destination (destination_channels per pixel)
+	using ConvertKernel = void (*)(const std::uint8_t* source, std::uint8_t* destination, size_t pixels);
+
+
+	// Kernel for a given instruction set, or nullptr when either channel count isn't in [1, 4]
+	ConvertKernel convert_kernel(SimdLevel level, std::uint8_t source_channels, std::uint8_t destination_channels) noexcept;
+
+	// Kernel for the running machine.
+	inline ConvertKernel convert_kernel(std::uint8_t source_channels, std::uint8_t destination_channels) noexcept
+	{
+		return convert_kernel(detect_simd_level(), source_channels, destination_channels);
+	}
+
+
+	// Per instruction set overrides, nullptr where there is no specialization
+#if defined(FILL_X86_SIMD)
+	ConvertKernel ssse3_convert_kernel(std::uint8_t source_channels, std::uint8_t destination_channels) noexcept;
+#endif
+
+} // fill::detail
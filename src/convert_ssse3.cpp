@@ -0,0 +1,102 @@
+#include "convert.hpp"
+
+#if defined(FILL_X86_SIMD)
+
+#include <cstring>
+
+#include <tmmintrin.h>
+
+// SSSE3 kernels
+// Four pixels per step, rearranged with a single pshufb. The tails fall back to plain byte copies.
+
+namespace
+{
+
+	// RGB -> RGBA: 16 bytes are loaded for 12, so stop while a full load still fits in the source
+	void rgb_to_rgba(const std::uint8_t* source, std::uint8_t* destination, size_t pixels)
+	{
+		const __m128i spread{ _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1) };
+		const __m128i alpha{ _mm_set1_epi32(static_cast<int>(0xFF00'0000)) };
+
+		size_t i{};
+
+		for (; (i + 4) * 3 + 4 <= pixels * 3; i += 4)
+		{
+			const __m128i rgb{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 3)) };
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i * 4), _mm_or_si128(_mm_shuffle_epi8(rgb, spread), alpha));
+		}
+
+		for (; i < pixels; i++)
+		{
+			destination[i * 4 + 0] = source[i * 3 + 0];
+			destination[i * 4 + 1] = source[i * 3 + 1];
+			destination[i * 4 + 2] = source[i * 3 + 2];
+			destination[i * 4 + 3] = 0xFF;
+		}
+	}
+
+	// RGBA -> RGB: the 12 packed bytes are stored as 8 + 4, never writing past the destination
+	void rgba_to_rgb(const std::uint8_t* source, std::uint8_t* destination, size_t pixels)
+	{
+		const __m128i pack{ _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1) };
+
+		size_t i{};
+
+		for (; i + 4 <= pixels; i += 4)
+		{
+			const __m128i rgb{ _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 4)), pack) };
+
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(destination + i * 3), rgb);
+
+			const auto last{ static_cast<std::uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(rgb, 8))) };
+			std::memcpy(destination + i * 3 + 8, &last, 4);
+		}
+
+		for (; i < pixels; i++)
+		{
+			destination[i * 3 + 0] = source[i * 4 + 0];
+			destination[i * 3 + 1] = source[i * 4 + 1];
+			destination[i * 3 + 2] = source[i * 4 + 2];
+		}
+	}
+
+	// Grey -> RGBA: 4 grey bytes become 4 pixels
+	void grey_to_rgba(const std::uint8_t* source, std::uint8_t* destination, size_t pixels)
+	{
+		const __m128i spread{ _mm_setr_epi8(0, 0, 0, -1, 1, 1, 1, -1, 2, 2, 2, -1, 3, 3, 3, -1) };
+		const __m128i alpha{ _mm_set1_epi32(static_cast<int>(0xFF00'0000)) };
+
+		size_t i{};
+
+		for (; i + 4 <= pixels; i += 4)
+		{
+			std::uint32_t grey{};
+			std::memcpy(&grey, source + i, 4);
+
+			const __m128i rgba{ _mm_or_si128(_mm_shuffle_epi8(_mm_cvtsi32_si128(static_cast<int>(grey)), spread), alpha) };
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i * 4), rgba);
+		}
+
+		for (; i < pixels; i++)
+		{
+			destination[i * 4 + 0] = destination[i * 4 + 1] = destination[i * 4 + 2] = source[i];
+			destination[i * 4 + 3] = 0xFF;
+		}
+	}
+
+} // namespace
+
+
+fill::detail::ConvertKernel fill::detail::ssse3_convert_kernel(std::uint8_t source_channels, std::uint8_t destination_channels) noexcept
+{
+	if (source_channels == 3 && destination_channels == 4)
+		return rgb_to_rgba;
+	if (source_channels == 4 && destination_channels == 3)
+		return rgba_to_rgb;
+	if (source_channels == 1 && destination_channels == 4)
+		return grey_to_rgba;
+
+	return nullptr;
+}
+
+#endif
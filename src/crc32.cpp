@@ -0,0 +1,47 @@
+#include "crc32.hpp"
+#include "simd.hpp"
+
+#include <algorithm>
+
+#include "zlib.h"
+
+
+namespace
+{
+
+	std::uint32_t zlib_crc32(std::uint32_t crc, const std::uint8_t* bytes, size_t size)
+	{
+		uLong checksum{ crc };
+
+		// uInt lengths only
+		for (size_t piece{}; size > 0; bytes += piece, size -= piece)
+		{
+			piece = std::min<size_t>(size, 1u << 30);
+			checksum = ::crc32(checksum, bytes, static_cast<uInt>(piece));
+		}
+
+		return static_cast<std::uint32_t>(checksum);
+	}
+
+} // namespace
+
+
+// Dispatch
+
+fill::detail::Crc32Kernel fill::detail::crc32_kernel(bool clmul) noexcept
+{
+#if defined(FILL_X86_SIMD)
+	if (clmul)
+		return pclmul_crc32;
+#else
+	(void)clmul;
+#endif
+
+	return zlib_crc32;
+}
+
+std::uint32_t fill::detail::crc32(std::uint32_t crc, const std::uint8_t* bytes, size_t size)
+{
+	static const Crc32Kernel kernel{ crc32_kernel(detect_clmul()) };
+	return kernel(crc, bytes, size);
+}
@@ -0,0 +1,28 @@
+#pragma once // crc32.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// Internal header: CRC-32 of PNG chunks (see PNG spec, section 5.5), as zlib's crc32 computes it.
+// With PCLMULQDQ, 64 bytes are folded at a time by carry-less multiplications (Intel's "Fast CRC Computation
+// for Generic Polynomials Using PCLMULQDQ"), several times faster than zlib's tables. zlib is used otherwise.
+// ===================================================
+
+#include <cstddef>
+#include <cstdint>
+
+namespace fill::detail
+{
+
+	// CRC-32 of size bytes, going on from crc (0 for none yet)
+	using Crc32Kernel = std::uint32_t (*)(std::uint32_t crc, const std::uint8_t* bytes, size_t size);
+
+	Crc32Kernel crc32_kernel(bool clmul) noexcept;
+
+#if defined(FILL_X86_SIMD)
+	std::uint32_t pclmul_crc32(std::uint32_t crc, const std::uint8_t* bytes, size_t size);
+#endif
+
+	// With the best kernel for this machine
+	std::uint32_t crc32(std::uint32_t crc, const std::uint8_t* bytes, size_t size);
+
+} // fill::detail
@@ -0,0 +1,109 @@
+#include "crc32.hpp"
+
+#if defined(FILL_X86_SIMD)
+
+#include "zlib.h"
+
+#include <emmintrin.h>
+#include <wmmintrin.h>
+
+// PCLMULQDQ kernels
+// CRC-32 by folding (as Chromium's zlib does): four 128 bit lanes are carried 64 bytes forward at a time with carry-less
+// multiplications by x^(512+-32) mod P, then folded into one, reduced to 64 bits, and Barrett reduced to the CRC.
+// Constants are for the bit reflected polynomial of PNG (and zlib), the tail of fewer than 16 bytes goes through zlib.
+
+namespace
+{
+
+	alignas(16) constexpr std::uint64_t k1k2[2]{ 0x0154442bd4, 0x01c6e41596 }; /*x^(4*128+32) and x^(4*128-32) mod P*/
+	alignas(16) constexpr std::uint64_t k3k4[2]{ 0x01751997d0, 0x00ccaa009e }; /*x^(128+32) and x^(128-32) mod P*/
+	alignas(16) constexpr std::uint64_t k5k0[2]{ 0x0163cd6124, 0 };            /*x^64 mod P*/
+	alignas(16) constexpr std::uint64_t poly[2]{ 0x01db710641, 0x01f7011641 }; /*P, and floor(x^64 / P)*/
+
+	// Folds lane forward over 128 bits (with the k3k4 constants) or 512 bits (k1k2), onto next
+	__m128i fold(__m128i lane, __m128i constants, __m128i next) noexcept
+	{
+		const __m128i low{ _mm_clmulepi64_si128(lane, constants, 0x00) };
+		const __m128i high{ _mm_clmulepi64_si128(lane, constants, 0x11) };
+
+		return _mm_xor_si128(_mm_xor_si128(high, low), next);
+	}
+
+	__m128i load(const std::uint8_t* bytes) noexcept
+	{
+		return _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+	}
+
+	// Inverted CRC (as it is while being computed) of a multiple of 16 bytes, at least 64
+	std::uint32_t fold_crc32(std::uint32_t crc, const std::uint8_t* bytes, size_t size) noexcept
+	{
+		__m128i x1{ _mm_xor_si128(load(bytes), _mm_cvtsi32_si128(static_cast<int>(crc))) };
+		__m128i x2{ load(bytes + 16) };
+		__m128i x3{ load(bytes + 32) };
+		__m128i x4{ load(bytes + 48) };
+
+		bytes += 64;
+		size -= 64;
+
+		// 64 bytes at a time
+		const __m128i k12{ _mm_load_si128(reinterpret_cast<const __m128i*>(k1k2)) };
+
+		for (; size >= 64; bytes += 64, size -= 64)
+		{
+			x1 = fold(x1, k12, load(bytes));
+			x2 = fold(x2, k12, load(bytes + 16));
+			x3 = fold(x3, k12, load(bytes + 32));
+			x4 = fold(x4, k12, load(bytes + 48));
+		}
+
+		// Into one lane, then 16 bytes at a time
+		const __m128i k34{ _mm_load_si128(reinterpret_cast<const __m128i*>(k3k4)) };
+
+		x1 = fold(x1, k34, x2);
+		x1 = fold(x1, k34, x3);
+		x1 = fold(x1, k34, x4);
+
+		for (; size >= 16; bytes += 16, size -= 16)
+			x1 = fold(x1, k34, load(bytes));
+
+		// 128 bits to 64
+		const __m128i low32{ _mm_setr_epi32(~0, 0, ~0, 0) };
+
+		x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), _mm_clmulepi64_si128(x1, k34, 0x10));
+
+		const __m128i k50{ _mm_loadl_epi64(reinterpret_cast<const __m128i*>(k5k0)) };
+
+		x1 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, low32), k50, 0x00), _mm_srli_si128(x1, 4));
+
+		// Barrett reduction to 32 bits
+		const __m128i p{ _mm_load_si128(reinterpret_cast<const __m128i*>(poly)) };
+
+		__m128i quotient{ _mm_clmulepi64_si128(_mm_and_si128(x1, low32), p, 0x10) };
+		quotient = _mm_clmulepi64_si128(_mm_and_si128(quotient, low32), p, 0x00);
+		x1 = _mm_xor_si128(x1, quotient);
+
+		return static_cast<std::uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(x1, 4)));
+	}
+
+} // namespace
+
+
+std::uint32_t fill::detail::pclmul_crc32(std::uint32_t crc, const std::uint8_t* bytes, size_t size)
+{
+	if (size >= 64)
+	{
+		const size_t folded{ size & ~size_t{ 15 } };
+
+		crc = ~fold_crc32(~crc, bytes, folded);
+		bytes += folded;
+		size -= folded;
+	}
+
+	// Fewer than 64 bytes (no fold to amortize), or the tail
+	if (size > 0)
+		crc = static_cast<std::uint32_t>(::crc32(crc, bytes, static_cast<uInt>(size)));
+
+	return crc;
+}
+
+#endif // FILL_X86_SIMD
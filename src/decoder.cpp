@@ -0,0 +1,71 @@
+#include "decoder.hpp"
+#include "decoder_state.hpp"
+
+#include "image.hpp"
+
+
+fill::Decoder::Decoder()
+	: Decoder{ nullptr }
+{
+}
+
+fill::Decoder::Decoder(std::pmr::memory_resource* arena)
+	: Decoder{ DecodeOptions{}, arena }
+{
+}
+
+fill::Decoder::Decoder(const DecodeOptions& options, std::pmr::memory_resource* arena)
+	: state{ std::make_unique<State>(arena) }
+{
+	state->options = options;
+}
+
+fill::Decoder::Decoder(Decoder&&) noexcept = default;
+fill::Decoder& fill::Decoder::operator=(Decoder&&) noexcept = default;
+
+fill::Decoder::~Decoder() = default;
+
+
+fill::Image fill::Decoder::decode(const std::filesystem::path& path_to_file)
+{
+	Image image{};
+	image.loadFromFile(path_to_file, *this);
+
+	return image;
+}
+
+fill::Image fill::Decoder::decode(std::span<const std::byte> file_bytes)
+{
+	Image image{};
+	image.loadFromMemory(file_bytes, *this);
+
+	return image;
+}
+
+
+const fill::DecodeOptions& fill::Decoder::getOptions() const noexcept
+{
+	return state->options;
+}
+
+const fill::DecodeStats& fill::Decoder::getLastStats() const noexcept
+{
+	return state->stats;
+}
+
+const fill::DecodeStats& fill::Decoder::getTotalStats() const noexcept
+{
+	return state->total_stats;
+}
+
+
+void fill::Decoder::resetStats() noexcept
+{
+	state->stats = DecodeStats{};
+	state->total_stats = DecodeStats{};
+}
+
+void fill::Decoder::setOptions(const DecodeOptions& options)
+{
+	state->options = options;
+}
@@ -0,0 +1,73 @@
+#pragma once // decoder_state.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// Internal header: what a fill::Decoder keeps between images.
+// ===================================================
+
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+#include "decoder.hpp"
+#include "expand.hpp"
+#include "fast_inflater.hpp"
+#include "inflater.hpp"
+#include "stats.hpp"
+
+namespace fill::detail
+{
+
+	// Where the IDAT source of a PNG is: chunks not read yet, and the rest of the IDAT being handed out in slices
+	struct IdatCursor
+	{
+		std::span<const std::uint8_t> chunks{};
+		std::span<const std::uint8_t> left{};
+
+		std::uint32_t crc{};          /*of the IDAT's type and the slices handed out so far*/
+		std::uint32_t expected_crc{};
+		std::uint32_t type{};
+	};
+
+} // fill::detail
+
+struct fill::Decoder::State
+{
+	// No arena: zlib uses its own allocator, scratch buffers the default resource
+	explicit State(std::pmr::memory_resource* arena)
+		: inflater{ arena }
+		, filtered_row{ arena ? arena : std::pmr::get_default_resource() }
+		, raw_rows{ arena ? arena : std::pmr::get_default_resource() }
+		, pass_row{ arena ? arena : std::pmr::get_default_resource() }
+		, pipeline_ring{ arena ? arena : std::pmr::get_default_resource() }
+		, idat_stream{ arena ? arena : std::pmr::get_default_resource() }
+		, inflated{ arena ? arena : std::pmr::get_default_resource() }
+		, expander{ arena }
+	{
+	}
+
+	DecodeOptions options{};
+
+	detail::Inflater inflater;
+	detail::FastInflater fast_inflater{};
+
+	std::pmr::vector<std::uint8_t> filtered_row; /*scanline being inflated, filter byte included*/
+	std::pmr::vector<std::uint8_t> raw_rows;     /*current and previous unfiltered rows, when they still need expanding*/
+	std::pmr::vector<std::uint8_t> pass_row;     /*expanded row of an Adam7 pass, before it is scattered*/
+	std::pmr::vector<std::uint8_t> pipeline_ring; /*blocks of inflated data, when pipelined*/
+	std::pmr::vector<std::uint8_t> idat_stream;   /*IDAT payloads put end to end, for the builtin inflater (unless there is one)*/
+	std::pmr::vector<std::uint8_t> inflated;      /*every scanline, filter bytes included, from the builtin inflater*/
+
+	detail::Inflater::Input idat{};              /*IDAT payloads of the image being decoded, in order*/
+	detail::IdatCursor idat_cursor{};            /*where idat is in the file*/
+
+	detail::PngFormat png{};                     /*format of the image being decoded*/
+	detail::RowExpander expander;
+
+	// Left untouched without FILL_DECODE_STATS
+	DecodeStats stats{};             /*of the image being decoded, then of the last one*/
+	DecodeStats total_stats{};       /*every image since the decoder was created or reset*/
+	std::uint64_t pending_map_ns{};  /*time spent mapping the file about to be decoded*/
+	detail::StageClock clock{};
+};
@@ -0,0 +1,139 @@
+#include "deflater.hpp"
+#include "byte_order.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "zlib.h"
+
+
+namespace
+{
+
+	constexpr size_t window_size{ 32 * 1024 };
+
+	struct Strip
+	{
+		std::vector<std::uint8_t> deflated{};
+		uLong adler{};
+	};
+
+	// Raw deflate of data, primed with dictionary, ending with Z_FINISH for the last strip and Z_SYNC_FLUSH otherwise
+	void deflate_strip(std::span<const std::uint8_t> data, std::span<const std::uint8_t> dictionary, int level, bool last, Strip& strip)
+	{
+		z_stream stream{};
+
+		int ret{ deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS /*raw: the zlib header and trailer are written once, around every strip*/, 8, Z_DEFAULT_STRATEGY) };
+		if (ret != Z_OK)
+			throw std::runtime_error("ERROR::PNG_DEFLATE::Cannot initialize deflate process: " + std::to_string(ret));
+
+		if (!dictionary.empty())
+			deflateSetDictionary(&stream, dictionary.data(), static_cast<uInt>(dictionary.size()));
+
+		const int flush{ last ? Z_FINISH : Z_SYNC_FLUSH };
+
+		strip.deflated.resize(deflateBound(&stream, static_cast<uLong>(std::min<size_t>(data.size(), std::numeric_limits<uLong>::max()))) + 16);
+		strip.adler = adler32(0L, Z_NULL, 0);
+
+		size_t consumed{}, produced{};
+
+		do
+		{
+			// uInt may be narrower than size_t: hand data over in pieces
+			const size_t input{ std::min<size_t>(data.size() - consumed, std::numeric_limits<uInt>::max()) };
+			const bool final_input{ consumed + input == data.size() };
+
+			stream.next_in = const_cast<Bytef*>(data.data() + consumed);
+			stream.avail_in = static_cast<uInt>(input);
+			strip.adler = adler32(strip.adler, data.data() + consumed, static_cast<uInt>(input));
+
+			do
+			{
+				if (strip.deflated.size() - produced < 64)
+					strip.deflated.resize(strip.deflated.size() * 2);
+
+				const size_t room{ std::min<size_t>(strip.deflated.size() - produced, std::numeric_limits<uInt>::max()) };
+
+				stream.next_out = strip.deflated.data() + produced;
+				stream.avail_out = static_cast<uInt>(room);
+
+				ret = deflate(&stream, final_input ? flush : Z_NO_FLUSH);
+				produced += room - stream.avail_out;
+
+				if (ret == Z_STREAM_ERROR)
+				{
+					deflateEnd(&stream);
+					throw std::runtime_error("ERROR::PNG_DEFLATE::Couldn't compress data: " + std::to_string(ret));
+				}
+			}
+			while (stream.avail_out == 0 || (final_input && last && ret != Z_STREAM_END));
+
+			consumed += input;
+		}
+		while (consumed < data.size());
+
+		deflateEnd(&stream);
+		strip.deflated.resize(produced);
+	}
+
+} // namespace
+
+
+std::vector<std::uint8_t> fill::detail::deflate_zlib(std::span<const std::uint8_t> data, int level, size_t strip_bytes, ThreadPool* pool)
+{
+	strip_bytes = std::max(strip_bytes, window_size);
+
+	const size_t strip_count{ pool ? std::max<size_t>((data.size() + strip_bytes - 1) / strip_bytes, 1) : 1 };
+	if (!pool)
+		strip_bytes = std::max<size_t>(data.size(), 1);
+
+	std::vector<Strip> strips(strip_count);
+
+	for_each_band(pool, strip_count, 1, [&](size_t begin, size_t end)
+	{
+		for (size_t i{ begin }; i < end; i++)
+		{
+			const size_t first{ std::min(i * strip_bytes, data.size()) };
+			const size_t last{ std::min(first + strip_bytes, data.size()) };
+			const size_t window{ std::min(first, window_size) };
+
+			deflate_strip(data.subspan(first, last - first), data.subspan(first - window, window), level, i + 1 == strip_count, strips[i]);
+		}
+	});
+
+	// zlib header (see RFC 1950): deflate with a 32KB window, FLEVEL from the compression level, FCHECK makes it a multiple of 31
+	const int flevel{ level == Z_DEFAULT_COMPRESSION ? 2 : level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3 };
+	const std::uint8_t cmf{ 0x78 };
+	std::uint8_t flg{ static_cast<std::uint8_t>(flevel << 6) };
+	flg = static_cast<std::uint8_t>(flg + (31 - (cmf * 256 + flg) % 31) % 31);
+
+	size_t total{ 2 + 4 };
+	for (const Strip& strip : strips)
+		total += strip.deflated.size();
+
+	std::vector<std::uint8_t> out{};
+	out.reserve(total);
+	out.push_back(cmf);
+	out.push_back(flg);
+
+	uLong adler{ strips.front().adler };
+	size_t offset{};
+
+	for (size_t i{}; i < strips.size(); i++)
+	{
+		out.insert(out.end(), strips[i].deflated.begin(), strips[i].deflated.end());
+
+		const size_t length{ std::min(offset + strip_bytes, data.size()) - offset };
+		if (i > 0)
+			adler = adler32_combine(adler, strips[i].adler, static_cast<z_off_t>(length));
+
+		offset += length;
+	}
+
+	write_uint32(out, static_cast<std::uint32_t>(adler));
+
+	return out;
+}
@@ -0,0 +1,28 @@
+#pragma once // deflater.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// Internal header: zlib stream compression, split in strips compressed in parallel (as pigz does).
+//	- Each strip is a raw deflate stream primed with the last 32KB of the strip before it, so matches
+//	  still reach across strips, and ends on a byte boundary (Z_SYNC_FLUSH): strips can simply be concatenated.
+//	- The Adler-32 of each strip is computed with it, and combined in order at the end.
+// ===================================================
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace fill
+{
+	class ThreadPool;
+}
+
+namespace fill::detail
+{
+
+	// Complete zlib stream (header, deflate data, Adler-32) of data. Without a pool, data is compressed as a single strip.
+	// level is a zlib compression level (0 to 9, or Z_DEFAULT_COMPRESSION)
+	std::vector<std::uint8_t> deflate_zlib(std::span<const std::uint8_t> data, int level, size_t strip_bytes, ThreadPool* pool);
+
+} // fill::detail
@@ -0,0 +1,166 @@
+#include "image.hpp"
+#include "encode.hpp"
+#include "byte_order.hpp"
+#include "deflater.hpp"
+#include "filter.hpp"
+#include "parallel.hpp"
+
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+
+// Chunk writing
+
+namespace
+{
+
+	// Length, type, data and the CRC of type and data (see PNG spec, section 5.3)
+	void write_chunk(std::vector<std::uint8_t>& png, const char (&type)[5], std::span<const std::uint8_t> data)
+	{
+		fill::detail::write_uint32(png, static_cast<std::uint32_t>(data.size()));
+
+		const size_t type_offset{ png.size() };
+		png.insert(png.end(), type, type + 4);
+		png.insert(png.end(), data.begin(), data.end());
+
+		const uLong crc{ crc32(crc32(0L, Z_NULL, 0), png.data() + type_offset, static_cast<uInt>(4 + data.size())) };
+		fill::detail::write_uint32(png, static_cast<std::uint32_t>(crc));
+	}
+
+	std::uint8_t png_color_type(std::uint8_t color_channel)
+	{
+		switch (color_channel)
+		{
+		case 1: return 0; /*Greyscale*/
+		case 2: return 4; /*Greyscale with alpha*/
+		case 3: return 2; /*TrueColor*/
+		case 4: return 6; /*TrueColor with alpha*/
+		default:
+			throw std::runtime_error("ERROR::PNG_ENCODE::No PNG color type has " + std::to_string(color_channel) + " channels");
+		}
+	}
+
+	constexpr size_t idat_bytes{ 1024 * 1024 }; /*largest IDAT written*/
+
+} // namespace
+
+
+// --- Saving
+
+void fill::Image::saveToFile(const std::filesystem::path& path_to_file) const
+{
+	saveToFile(path_to_file, EncodeOptions{});
+}
+
+void fill::Image::saveToFile(const std::filesystem::path& path_to_file, const EncodeOptions& options) const
+{
+	if (path_to_file.has_extension())
+	{
+		std::string extension{ path_to_file.extension().string() };
+		std::transform(extension.begin(), extension.end(), extension.begin(),
+			[](unsigned char c) { return std::tolower(c); });
+
+		if (extension == ".png")
+			return saveToPNG(path_to_file, options);
+
+		if (extension == ".pam")
+			return saveToPNM(path_to_file, PnmType::PAM);
+		if (extension == ".ppm")
+			return saveToPNM(path_to_file, PnmType::PPM);
+		if (extension == ".pgm")
+			return saveToPNM(path_to_file, PnmType::PGM);
+
+		// Add other files
+	}
+
+	throw std::runtime_error("ERROR::No compatible version of the program was found to save the file: " + path_to_file.string());
+}
+
+void fill::Image::saveToPNG(const std::filesystem::path& path_png) const
+{
+	saveToPNG(path_png, EncodeOptions{});
+}
+
+void fill::Image::saveToPNG(const std::filesystem::path& path_png, const EncodeOptions& options) const
+{
+	if (size() < size_bytes())
+		throw std::runtime_error("ERROR::PNG_ENCODE::Image holds fewer pixels than its dimensions describe");
+
+	saveToPNG(view(), path_png, options);
+}
+
+void fill::Image::saveToPNG(const ImageView& source, const std::filesystem::path& path_png, const EncodeOptions& options)
+{
+	const std::vector<std::uint8_t> png{ encodePNG(source, options) };
+
+	std::ofstream file{ path_png, std::ios::binary | std::ios::trunc };
+
+	if (!file || !file.write(reinterpret_cast<const char*>(png.data()), static_cast<std::streamsize>(png.size())))
+		throw std::runtime_error("ERROR::FILE::Couldn't write file: " + path_png.string());
+}
+
+std::vector<std::uint8_t> fill::Image::encodePNG(const EncodeOptions& options) const
+{
+	if (size() < size_bytes())
+		throw std::runtime_error("ERROR::PNG_ENCODE::Image holds fewer pixels than its dimensions describe");
+
+	return encodePNG(view(), options);
+}
+
+std::vector<std::uint8_t> fill::Image::encodePNG(const ImageView& source, const EncodeOptions& options)
+{
+	const std::uint32_t width{ source.getWidth() }, height{ source.getHeight() };
+	const std::uint8_t bit_depth{ source.getBitDepth() };
+	const std::uint8_t bpp{ source.getBytesPerPixel() };
+
+	if (bit_depth != 8 && bit_depth != 16)
+		throw std::runtime_error("ERROR::PNG_ENCODE::Unsupported bit depth: " + std::to_string(bit_depth));
+	if (source.empty())
+		throw std::runtime_error("ERROR::PNG_ENCODE::A PNG image can't be empty");
+
+	const std::uint8_t color_type{ png_color_type(source.getColorChannel()) };
+
+	// Filtering: rows are independent (each only reads the raw row above it), bands of rows go to the pool
+	const size_t width_bytes{ static_cast<size_t>(width) * bpp };
+	const size_t filtered_pitch{ width_bytes + 1 };
+
+	std::vector<std::uint8_t> filtered(filtered_pitch * height);
+
+	const detail::FilterKernels kernels{ detail::filter_kernels() };
+	const auto filter{ static_cast<int>(options.filter) };
+
+	detail::for_each_band(options.pool, height, 64 * 1024 / filtered_pitch, [&](size_t begin, size_t end)
+	{
+		std::vector<std::uint8_t> scratch(width_bytes);
+		const std::vector<std::uint8_t> zeros(begin == 0 ? width_bytes : 0); /*the row above the first one*/
+
+		for (size_t row{ begin }; row < end; row++)
+		{
+			const std::uint8_t* current{ source.row(static_cast<std::uint32_t>(row)) };
+			const std::uint8_t* prior{ row == 0 ? zeros.data() : current - source.getStride() };
+
+			detail::filter_row(kernels, filter, current, prior, filtered.data() + row * filtered_pitch, scratch.data(), width_bytes, bpp);
+		}
+	});
+
+	const std::vector<std::uint8_t> compressed{ detail::deflate_zlib(filtered, options.compression_level, options.strip_bytes, options.pool) };
+
+	// Signature, IHDR, IDATs, IEND
+	std::vector<std::uint8_t> png{ 0x89, 0x50, 0x4e, 0x47, 0xd, 0xa, 0x1a, 0xa };
+	png.reserve(png.size() + 25 + compressed.size() + (compressed.size() / idat_bytes + 1) * 12 + 12);
+
+	std::vector<std::uint8_t> ihdr{};
+	fill::detail::write_uint32(ihdr, width);
+	fill::detail::write_uint32(ihdr, height);
+	ihdr.insert(ihdr.end(), { bit_depth, color_type, 0 /*deflate*/, 0 /*adaptive filtering*/, 0 /*no interlace*/ });
+
+	write_chunk(png, "IHDR", ihdr);
+
+	for (size_t offset{}; offset < compressed.size(); offset += idat_bytes)
+		write_chunk(png, "IDAT", std::span<const std::uint8_t>{ compressed }.subspan(offset, std::min(idat_bytes, compressed.size() - offset)));
+
+	write_chunk(png, "IEND", {});
+
+	return png;
+}
@@ -0,0 +1,222 @@
+#include "expand.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+
+// Scalar kernels
+
+namespace
+{
+
+	void gather(const std::uint8_t* indices, std::uint8_t* rgba, size_t pixels, const std::uint32_t* palette)
+	{
+		for (size_t i{}; i < pixels; i++)
+			std::memcpy(rgba + i * 4, palette + indices[i], 4);
+	}
+
+	void narrow(const std::uint8_t* samples16, std::uint8_t* samples8, size_t samples)
+	{
+		for (size_t i{}; i < samples; i++)
+			samples8[i] = samples16[i * 2]; /*big endian: high byte first*/
+	}
+
+	template <std::uint8_t Depth>
+	void unpack(const std::uint8_t* packed, std::uint8_t* samples, size_t count, const std::array<std::uint64_t, 256>& table)
+	{
+		constexpr size_t per_byte{ 8 / Depth };
+
+		size_t i{};
+
+		for (; i + per_byte <= count; i += per_byte)
+			std::memcpy(samples + i, &table[*packed++], per_byte);
+
+		if (i < count)
+			std::memcpy(samples + i, &table[*packed], count - i);
+	}
+
+	// Appends an alpha channel: 0 where the pixel equals key, opaque elsewhere
+	template <typename Sample>
+	void key_alpha(const std::uint8_t* source, std::uint8_t* destination, size_t pixels, size_t channels, const std::array<std::uint16_t, 3>& key)
+	{
+		constexpr size_t size{ sizeof(Sample) };
+
+		for (size_t i{}; i < pixels; i++)
+		{
+			bool matches{ true };
+
+			for (size_t c{}; c < channels; c++)
+			{
+				const std::uint8_t* sample{ source + (i * channels + c) * size };
+				const auto value{ static_cast<std::uint16_t>(size == 2 ? sample[0] << 8 | sample[1] : sample[0]) };
+
+				matches = matches && value == key[c];
+			}
+
+			std::memcpy(destination + i * (channels + 1) * size, source + i * channels * size, channels * size);
+			std::memset(destination + (i * (channels + 1) + channels) * size, matches ? 0x00 : 0xFF, size);
+		}
+	}
+
+} // namespace
+
+
+// Dispatch
+
+fill::detail::ExpandKernels fill::detail::expand_kernels(SimdLevel level) noexcept
+{
+	ExpandKernels kernels{ gather, narrow };
+
+#if defined(FILL_X86_SIMD)
+	if (level >= SimdLevel::AVX2)
+		avx2_expand_kernels(kernels);
+#else
+	(void)level;
+#endif
+
+	return kernels;
+}
+
+
+// Row expander
+
+fill::detail::RowExpander::RowExpander(std::pmr::memory_resource* arena)
+	: scratch{ arena ? arena : std::pmr::get_default_resource() }
+{
+}
+
+void fill::detail::RowExpander::configure(const PngFormat& png, PixelFormat output, std::uint32_t max_width)
+{
+	format = png;
+	stage_count = 0;
+	kernels = expand_kernels(detect_simd_level());
+
+	const auto add{ [this](Stage stage) { stages[stage_count++] = stage; } };
+
+	std::uint8_t channels{ png.channels };
+	std::uint8_t depth{ png.bit_depth };
+
+	if (depth < 8)
+	{
+		add(Stage::Unpack);
+
+		// Greyscale is scaled to the full 8 bit range (e.g. 2 bits: 0, 85, 170, 255), indices are kept
+		const int max_value{ (1 << depth) - 1 };
+		const int scale{ png.indexed() ? 1 : 255 / max_value };
+
+		for (int byte{}; byte < 256; byte++)
+		{
+			std::uint64_t samples{};
+
+			for (int i{}; i < 8 / depth; i++)
+			{
+				const int value{ (byte >> (8 - depth * (i + 1))) & max_value }; /*leftmost sample in the high bits*/
+				samples |= static_cast<std::uint64_t>(value * scale) << (8 * i);
+			}
+
+			unpack_table[byte] = samples;
+		}
+
+		key[0] = static_cast<std::uint16_t>(png.key[0] * scale);
+		depth = 8;
+	}
+	else
+		key = png.key;
+
+	if (png.indexed())
+	{
+		add(Stage::Gather);
+		channels = 4;
+	}
+
+	const bool has_alpha{ channels == 2 || channels == 4 };
+	const bool wants_alpha{ output == PixelFormat::RGBA8 || (png.indexed() ? png.palette_size > 0 && std::any_of(png.palette.begin(), png.palette.begin() + png.palette_size, [](std::uint32_t entry) { return (entry >> 24) != 0xFF; }) : png.transparent_key) };
+
+	if (png.transparent_key && !png.indexed() && !has_alpha)
+	{
+		add(Stage::Key);
+		key_channels = channels;
+		key_depth = depth;
+		channels++;
+	}
+
+	if (output == PixelFormat::RGBA8)
+	{
+		if (depth == 16)
+		{
+			add(Stage::Narrow);
+			depth = 8;
+		}
+
+		if (channels != 4)
+		{
+			add(Stage::Convert);
+			convert_channels = channels;
+			convert = convert_kernel(channels, 4);
+			channels = 4;
+		}
+	}
+	else if (png.indexed() && !wants_alpha)
+	{
+		// Native palette images come out as RGB, unless some entry isn't opaque
+		add(Stage::Convert);
+		convert_channels = 4;
+		convert = convert_kernel(4, 3);
+		channels = 3;
+	}
+
+	output_channels = channels;
+	output_depth = depth;
+
+	// Widest intermediate row: 4 channels of 16 bits
+	scratch.resize(2 * static_cast<size_t>(max_width) * 8);
+}
+
+void fill::detail::RowExpander::expand(const std::uint8_t* raw, std::uint8_t* out, std::uint32_t width)
+{
+	const std::uint8_t* source{ raw };
+
+	std::uint8_t channels{ format.channels };
+	const size_t half{ scratch.size() / 2 };
+
+	for (size_t i{}; i < stage_count; i++)
+	{
+		// Stages bounce between the two scratch rows, the last one lands in the image
+		std::uint8_t* destination{ i + 1 == stage_count ? out : scratch.data() + (i % 2) * half };
+
+		switch (stages[i])
+		{
+		case Stage::Unpack:
+			switch (format.bit_depth)
+			{
+			case 1: unpack<1>(source, destination, width, unpack_table); break;
+			case 2: unpack<2>(source, destination, width, unpack_table); break;
+			case 4: unpack<4>(source, destination, width, unpack_table); break;
+			}
+			break;
+
+		case Stage::Gather:
+			kernels.gather(source, destination, width, format.palette.data());
+			channels = 4;
+			break;
+
+		case Stage::Key:
+			if (key_depth == 16)
+				key_alpha<std::uint16_t>(source, destination, width, key_channels, key);
+			else
+				key_alpha<std::uint8_t>(source, destination, width, key_channels, key);
+			channels = key_channels + 1;
+			break;
+
+		case Stage::Narrow:
+			kernels.narrow(source, destination, static_cast<size_t>(width) * channels);
+			break;
+
+		case Stage::Convert:
+			convert(source, destination, width);
+			break;
+		}
+
+		source = destination;
+	}
+}
@@ -0,0 +1,111 @@
+#pragma once // expand.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// Internal header: expansion of unfiltered PNG rows to the pixel format asked for by the caller.
+//	- Every IHDR combination is covered: 1/2/4 bit samples are unpacked through lookup tables, palettes are gathered
+//	  (alpha from tRNS folded in), tRNS colour keys become an alpha channel, 16 bit samples are narrowed to 8 bits
+//	  and channels are added where needed.
+//	- Rows are expanded one at a time, straight after unfiltering, while they are still in cache.
+//	- Stages run through two scratch rows, the last one writes straight into the image.
+//
+// See: https://www.w3.org/TR/2003/REC-PNG-20031110/#11IHDR
+// ===================================================
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#include "convert.hpp"
+#include "decoder.hpp"
+#include "simd.hpp"
+
+namespace fill::detail
+{
+
+	// Layout of the image data in a PNG file, from IHDR, PLTE and tRNS
+	struct PngFormat
+	{
+		std::uint8_t bit_depth{};
+		std::uint8_t color_type{};
+		std::uint8_t channels{}; /*samples per pixel in the file, 1 for indexed colour*/
+
+		std::array<std::uint32_t, 256> palette{}; /*RGBA in memory order, alpha from tRNS, opaque otherwise*/
+		std::uint16_t palette_size{};
+
+		bool transparent_key{}; /*tRNS on greyscale or truecolour: pixels equal to key are fully transparent*/
+		std::array<std::uint16_t, 3> key{};
+
+		// Bytes of a row without its filter byte (samples are packed when under 8 bits)
+		size_t row_bytes(std::uint32_t width) const noexcept { return (static_cast<size_t>(width) * channels * bit_depth + 7) / 8; }
+
+		// Filters work on whole pixels, rounded up to a byte (see PNG spec, section 9.2)
+		size_t filter_bpp() const noexcept { return (static_cast<size_t>(channels) * bit_depth + 7) / 8; }
+
+		bool indexed() const noexcept { return color_type == 3; }
+	};
+
+
+	// Kernels with SIMD specializations
+	struct ExpandKernels
+	{
+		void (*gather)(const std::uint8_t* indices, std::uint8_t* rgba, size_t pixels, const std::uint32_t* palette){};
+		void (*narrow)(const std::uint8_t* samples16, std::uint8_t* samples8, size_t samples){}; /*keeps the high byte*/
+	};
+
+	ExpandKernels expand_kernels(SimdLevel level) noexcept;
+
+#if defined(FILL_X86_SIMD)
+	void avx2_expand_kernels(ExpandKernels& kernels) noexcept;
+#endif
+
+
+	class RowExpander
+	{
+	public:
+		explicit RowExpander(std::pmr::memory_resource* arena = nullptr);
+
+		// Picks the stages turning rows of format into rows of output, scratch rows keep their capacity
+		void configure(const PngFormat& format, PixelFormat output, std::uint32_t max_width);
+
+		// Unfiltered rows already are in the output format: nothing to do
+		bool passthrough() const noexcept { return stage_count == 0; }
+
+		std::uint8_t channels() const noexcept { return output_channels; }
+		std::uint8_t bit_depth() const noexcept { return output_depth; }
+
+		void expand(const std::uint8_t* raw, std::uint8_t* out, std::uint32_t width);
+
+
+	private:
+		enum class Stage
+			: std::uint8_t
+		{
+			Unpack,  /*1/2/4 bit samples to bytes (greyscale scaled to 0-255, indices kept)*/
+			Gather,  /*palette indices to RGBA*/
+			Key,     /*tRNS colour key to an alpha channel*/
+			Narrow,  /*16 to 8 bits*/
+			Convert  /*8 bit channel count*/
+		};
+
+		PngFormat format{};
+
+		std::array<Stage, 5> stages{};
+		size_t stage_count{};
+
+		std::uint8_t output_channels{}, output_depth{};
+		std::uint8_t key_channels{}, key_depth{}; /*format of the samples the key stage sees*/
+		std::array<std::uint16_t, 3> key{};        /*scaled like those samples*/
+		std::uint8_t convert_channels{};            /*channel count before Convert*/
+
+		ConvertKernel convert{};
+		ExpandKernels kernels{};
+
+		std::array<std::uint64_t, 256> unpack_table{}; /*one packed byte to 8 / bit_depth samples, in memory order*/
+
+		std::pmr::vector<std::uint8_t> scratch;
+	};
+
+} // fill::detail
@@ -0,0 +1,59 @@
+#include "expand.hpp"
+
+#if defined(FILL_X86_SIMD)
+
+#include <cstring>
+
+#include <immintrin.h>
+
+// AVX2 kernels
+// Palette lookups as 8 wide gathers of whole RGBA entries, 16 to 8 bit narrowing as a mask and a pack.
+
+namespace
+{
+
+	void gather(const std::uint8_t* indices, std::uint8_t* rgba, size_t pixels, const std::uint32_t* palette)
+	{
+		size_t i{};
+
+		for (; i + 8 <= pixels; i += 8)
+		{
+			const __m256i offsets{ _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(indices + i))) };
+			const __m256i entries{ _mm256_i32gather_epi32(reinterpret_cast<const int*>(palette), offsets, 4) };
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(rgba + i * 4), entries);
+		}
+
+		for (; i < pixels; i++)
+			std::memcpy(rgba + i * 4, palette + indices[i], 4);
+	}
+
+	// Loaded as little endian lanes, a big endian sample has its high byte in the low half: mask and pack
+	void narrow(const std::uint8_t* samples16, std::uint8_t* samples8, size_t samples)
+	{
+		const __m256i low_bytes{ _mm256_set1_epi16(0x00FF) };
+		size_t i{};
+
+		for (; i + 32 <= samples; i += 32)
+		{
+			const __m256i a{ _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples16 + i * 2)), low_bytes) };
+			const __m256i b{ _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples16 + i * 2 + 32)), low_bytes) };
+
+			// packus works per 128 bit lane: restore the order of the four 8 byte groups
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(samples8 + i), _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), _MM_SHUFFLE(3, 1, 2, 0)));
+		}
+
+		for (; i < samples; i++)
+			samples8[i] = samples16[i * 2];
+	}
+
+} // namespace
+
+
+void fill::detail::avx2_expand_kernels(ExpandKernels& kernels) noexcept
+{
+	kernels.gather = gather;
+	kernels.narrow = narrow;
+}
+
+#endif
@@ -0,0 +1,697 @@
+#include "fast_inflater.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#include "zlib.h"
+
+
+// Table entries: the bits a code takes, what it decodes to, and how to go on from there
+
+namespace
+{
+
+	constexpr std::uint32_t code_bits{ 0x1F };     /*bits 0-4: to consume for the code (for a subtable pointer: the main table's bits)*/
+	constexpr unsigned extra_shift{ 8 };            /*bits 8-11: extra bits of a length or offset, or a subtable's bits*/
+	constexpr std::uint32_t subtable{ 1u << 12 };
+	constexpr std::uint32_t end_of_block{ 1u << 13 };
+	constexpr std::uint32_t invalid{ 1u << 14 };    /*unused code, or a symbol deflate doesn't allow*/
+	constexpr std::uint32_t literal{ 1u << 15 };
+	constexpr unsigned value_shift{ 16 };           /*bits 16-31: literal, base length or offset, precode symbol, or subtable start*/
+
+	// Longest match (15 bits length code, 5 extra, 15 bits offset code, 13 extra), so a refill covers a whole one
+	constexpr unsigned match_bits{ 48 };
+
+	constexpr std::uint32_t extra_of(std::uint32_t entry) noexcept
+	{
+		return (entry >> extra_shift) & 0xF;
+	}
+
+
+	// What each symbol's entry holds, before its code length is added
+
+	constexpr std::array<std::uint32_t, 288> litlen_symbols{ []
+	{
+		constexpr std::uint16_t base[29]{ 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+		constexpr std::uint8_t extra[29]{ 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+
+		std::array<std::uint32_t, 288> symbols{};
+
+		for (std::uint32_t s{}; s < 256; s++)
+			symbols[s] = s << value_shift | literal;
+
+		symbols[256] = end_of_block;
+
+		for (size_t i{}; i < 29; i++)
+			symbols[257 + i] = std::uint32_t{ base[i] } << value_shift | std::uint32_t{ extra[i] } << extra_shift;
+
+		symbols[286] = symbols[287] = invalid;
+
+		return symbols;
+	}() };
+
+	constexpr std::array<std::uint32_t, 32> offset_symbols{ []
+	{
+		constexpr std::uint16_t base[30]{ 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+		constexpr std::uint8_t extra[30]{ 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+		std::array<std::uint32_t, 32> symbols{};
+
+		for (size_t i{}; i < 30; i++)
+			symbols[i] = std::uint32_t{ base[i] } << value_shift | std::uint32_t{ extra[i] } << extra_shift;
+
+		symbols[30] = symbols[31] = invalid;
+
+		return symbols;
+	}() };
+
+	constexpr std::array<std::uint32_t, 19> precode_symbols{ []
+	{
+		std::array<std::uint32_t, 19> symbols{};
+
+		for (std::uint32_t s{}; s < 19; s++)
+			symbols[s] = s << value_shift;
+
+		return symbols;
+	}() };
+
+
+	// Canonical Huffman decode table for the code lengths lens (RFC 1951, 3.2.2): a main table indexed by the next table_bits bits,
+	// then a subtable for each prefix of longer codes, sized for the longest of them.
+	// Over-subscribed codes are invalid, and so are incomplete ones, unless single_allowed and made of a single code (as zlib has it)
+	bool build_table(std::uint32_t* table, unsigned table_bits, const std::uint8_t* lens, size_t count, const std::uint32_t* symbols, bool single_allowed = true) noexcept
+	{
+		std::uint16_t counts[16]{};
+		for (size_t s{}; s < count; s++)
+			counts[lens[s]]++;
+		counts[0] = 0;
+
+		unsigned longest_code{};
+		for (unsigned len{ 15 }; len > 0 && longest_code == 0; len--)
+			if (counts[len] != 0)
+				longest_code = len;
+
+		const size_t main_size{ size_t{ 1 } << table_bits };
+		std::fill(table, table + main_size, invalid);
+
+		if (longest_code == 0)
+			return true; /*no code at all, every lookup is invalid*/
+
+		int left{ 1 };
+		for (unsigned len{ 1 }; len <= 15; len++)
+		{
+			left = (left << 1) - counts[len];
+			if (left < 0)
+				return false;
+		}
+
+		if (left > 0 && (!single_allowed || longest_code != 1))
+			return false;
+
+		std::uint16_t next_code[16]{};
+		for (unsigned len{ 1 }, code{}; len <= 15; len++)
+		{
+			code = (code + counts[len - 1]) << 1;
+			next_code[len] = static_cast<std::uint16_t>(code);
+		}
+
+		// Codes come first bit first: tables are indexed by their reversed bits
+		std::uint16_t codes[288]{};
+		std::uint8_t longest[size_t{ 1 } << 11]{}; /*longest code under each main table prefix*/
+
+		for (size_t s{}; s < count; s++)
+		{
+			const unsigned len{ lens[s] };
+			if (len == 0)
+				continue;
+
+			const unsigned code{ next_code[len]++ };
+			unsigned reversed{};
+			for (unsigned bit{}; bit < len; bit++)
+				reversed |= ((code >> bit) & 1) << (len - 1 - bit);
+
+			codes[s] = static_cast<std::uint16_t>(reversed);
+
+			if (len > table_bits)
+			{
+				std::uint8_t& prefix_longest{ longest[reversed & (main_size - 1)] };
+				prefix_longest = std::max(prefix_longest, static_cast<std::uint8_t>(len));
+			}
+		}
+
+		size_t next_table{ main_size };
+		for (size_t prefix{}; prefix < main_size && longest_code > table_bits; prefix++)
+		{
+			if (longest[prefix] == 0)
+				continue;
+
+			const unsigned sub_bits{ longest[prefix] - table_bits };
+
+			table[prefix] = static_cast<std::uint32_t>(next_table) << value_shift | sub_bits << extra_shift | subtable | table_bits;
+			std::fill(table + next_table, table + next_table + (size_t{ 1 } << sub_bits), invalid);
+
+			next_table += size_t{ 1 } << sub_bits;
+		}
+
+		for (size_t s{}; s < count; s++)
+		{
+			const unsigned len{ lens[s] };
+			if (len == 0)
+				continue;
+
+			const unsigned code{ codes[s] };
+
+			if (len <= table_bits)
+			{
+				for (size_t i{ code }; i < main_size; i += size_t{ 1 } << len)
+					table[i] = symbols[s] | len;
+			}
+			else
+			{
+				const std::uint32_t pointer{ table[code & (main_size - 1)] };
+				std::uint32_t* const sub{ table + (pointer >> value_shift) };
+
+				for (size_t i{ code >> table_bits }; i < (size_t{ 1 } << extra_of(pointer)); i += size_t{ 1 } << (len - table_bits))
+					sub[i] = symbols[s] | (len - table_bits);
+			}
+		}
+
+		return true;
+	}
+
+	std::uint64_t load_le64(const std::uint8_t* bytes) noexcept
+	{
+		std::uint64_t word{};
+
+		if constexpr (std::endian::native == std::endian::little)
+		{
+			std::memcpy(&word, bytes, sizeof(word));
+		}
+		else
+		{
+			for (unsigned i{}; i < 8; i++)
+				word |= std::uint64_t{ bytes[i] } << (8 * i);
+		}
+
+		return word;
+	}
+
+	void copy8(std::uint8_t* to, const std::uint8_t* from) noexcept
+	{
+		std::memcpy(to, from, 8);
+	}
+
+	std::uint32_t zlib_adler32(std::uint32_t adler, const std::uint8_t* bytes, size_t size)
+	{
+		uLong checksum{ adler };
+
+		// uInt lengths only
+		for (size_t piece{}; size > 0; bytes += piece, size -= piece)
+		{
+			piece = std::min<size_t>(size, 1u << 30);
+			checksum = adler32(checksum, bytes, static_cast<uInt>(piece));
+		}
+
+		return static_cast<std::uint32_t>(checksum);
+	}
+
+} // namespace
+
+
+// Bits of the stream, first bit lowest. Past the end of the input, zeros are read in its place: a stream may end
+// anywhere inside the last refill, reading further than that is only found out when the bits are used (see overrun)
+struct fill::detail::FastInflater::BitReader
+{
+	const std::uint8_t* in{};
+	const std::uint8_t* end{};
+	std::uint64_t buffer{};
+	unsigned left{};     /*valid bits in buffer, those above are the next input bytes or zeros*/
+	unsigned overread{}; /*zero bytes read past the end*/
+
+	// At least 56 bits in buffer
+	void refill() noexcept
+	{
+		if (end - in >= 8)
+			refill_fast();
+		else
+			refill_slow();
+	}
+
+	// Whole bytes that fit are taken, the partial one above is loaded again next time
+	void refill_fast() noexcept
+	{
+		buffer |= load_le64(in) << left;
+		in += (63 - left) >> 3;
+		left |= 56;
+	}
+
+	// A byte at a time, less than 8 are left
+	void refill_slow() noexcept
+	{
+		buffer &= (std::uint64_t{ 1 } << left) - 1;
+
+		for (; left <= 56; left += 8)
+		{
+			if (in != end)
+				buffer |= std::uint64_t{ *in++ } << left;
+			else
+				overread++;
+		}
+	}
+
+	std::uint32_t peek(unsigned count) const noexcept
+	{
+		return static_cast<std::uint32_t>(buffer) & ((1u << count) - 1);
+	}
+
+	void consume(unsigned count) noexcept
+	{
+		buffer >>= count;
+		left -= count;
+	}
+
+	std::uint32_t take(unsigned count) noexcept
+	{
+		const std::uint32_t bits{ peek(count) };
+		consume(count);
+
+		return bits;
+	}
+
+	// Some of the zeros read past the end were used
+	bool overrun() const noexcept
+	{
+		return overread * 8 > left;
+	}
+
+	// Drops bits up to the next byte, and returns where it is in the input, or nullptr past its end
+	const std::uint8_t* align() noexcept
+	{
+		consume(left & 7);
+
+		if (overrun())
+			return nullptr;
+
+		return in - (left / 8 - overread);
+	}
+
+	// Goes on from a byte of the input, after align
+	void restart(const std::uint8_t* at) noexcept
+	{
+		in = at;
+		buffer = 0;
+		left = 0;
+		overread = 0;
+	}
+};
+
+
+// Dispatch
+
+fill::detail::Adler32Kernel fill::detail::adler32_kernel(SimdLevel level) noexcept
+{
+#if defined(FILL_X86_SIMD)
+	if (level >= SimdLevel::AVX2)
+		return avx2_adler32;
+#else
+	(void)level;
+#endif
+
+	return zlib_adler32;
+}
+
+
+// Inflater
+
+fill::detail::FastInflater::FastInflater() noexcept
+	: adler32{ adler32_kernel(detect_simd_level()) }
+{
+	std::uint8_t lens[288]{};
+
+	std::fill(lens, lens + 144, std::uint8_t{ 8 });
+	std::fill(lens + 144, lens + 256, std::uint8_t{ 9 });
+	std::fill(lens + 256, lens + 280, std::uint8_t{ 7 });
+	std::fill(lens + 280, lens + 288, std::uint8_t{ 8 });
+	build_table(fixed_litlen.data(), litlen_bits, lens, 288, litlen_symbols.data());
+
+	std::fill(lens, lens + 32, std::uint8_t{ 5 });
+	build_table(fixed_offset.data(), offset_bits, lens, 32, offset_symbols.data());
+}
+
+
+fill::detail::FastInflater::Result fill::detail::FastInflater::inflate(std::span<const std::uint8_t> stream, std::span<std::uint8_t> out) noexcept
+{
+	std::uint8_t* const out_begin{ out.data() };
+	std::uint8_t* const out_end{ out_begin + out.size() };
+	std::uint8_t* out_next{ out_begin };
+
+	// Output from zeros read past the end isn't valid: only up to the last refill before any of them was used
+	std::uint8_t* valid_end{};
+
+	BitReader bits{ stream.data(), stream.data() + stream.size() };
+
+	const auto stop = [&](Status status, const char* error = nullptr) -> Result
+	{
+		if (bits.overrun())
+			status = Status::Truncated; /*whatever was wrong came from zeros past the end*/
+		if (status == Status::Truncated && valid_end)
+			out_next = std::min(out_next, valid_end);
+
+		return { static_cast<size_t>(out_next - out_begin), status, error };
+	};
+
+	// False once 8 zeros were read past the end: they are all used, the stream is truncated
+	const auto refill = [&]() -> bool
+	{
+		if (bits.end - bits.in >= 8)
+		{
+			bits.refill_fast();
+			return true;
+		}
+
+		bits.refill_slow();
+
+		if (!bits.overrun())
+			valid_end = out_next;
+
+		return bits.overread < 8;
+	};
+
+	// zlib header (RFC 1950): deflate, a window of at most 32K, no preset dictionary
+	if (stream.size() < 2)
+		return stop(Status::Truncated);
+
+	if ((stream[0] & 0x0F) != 8)
+		return stop(Status::Corrupt, "unknown compression method");
+	if ((stream[0] >> 4) > 7)
+		return stop(Status::Corrupt, "invalid window size");
+	if ((stream[0] << 8 | stream[1]) % 31 != 0)
+		return stop(Status::Corrupt, "incorrect header check");
+	if (stream[1] & 0x20)
+		return stop(Status::Corrupt, "preset dictionary");
+
+	bits.restart(stream.data() + 2);
+
+	for (bool final{}; !final;)
+	{
+		if (!refill() || bits.overrun())
+			return stop(Status::Truncated);
+
+		final = bits.take(1) != 0;
+		const std::uint32_t type{ bits.take(2) };
+
+		if (type == 0)
+		{
+			// Stored: byte aligned length, its complement, then as many bytes as they are
+			const std::uint8_t* at{ bits.align() };
+
+			if (!at || bits.end - at < 4)
+				return stop(Status::Truncated);
+
+			const size_t length{ size_t{ at[0] } | size_t{ at[1] } << 8 };
+			if (length != (~(size_t{ at[2] } | size_t{ at[3] } << 8) & 0xFFFF))
+				return stop(Status::Corrupt, "invalid stored block lengths");
+
+			at += 4;
+
+			const size_t available{ std::min<size_t>(length, bits.end - at) };
+			const size_t room{ static_cast<size_t>(out_end - out_next) };
+
+			const size_t copied{ std::min(available, room) };
+			if (copied > 0)
+				std::memcpy(out_next, at, copied);
+			out_next += copied;
+
+			if (room < length && room <= available)
+				return stop(Status::Full);
+			if (available < length)
+			{
+				valid_end = nullptr; /*whatever was copied is valid*/
+				return stop(Status::Truncated);
+			}
+
+			bits.restart(at + length);
+			valid_end = nullptr; /*no zero read past the end was used*/
+			continue;
+		}
+
+		const std::uint32_t* litlen_table{ fixed_litlen.data() };
+		const std::uint32_t* offset_table{ fixed_offset.data() };
+
+		if (type == 2)
+		{
+			if (const char* error{ read_dynamic_tables(bits) })
+				return stop(Status::Corrupt, error);
+
+			litlen_table = litlen.data();
+			offset_table = offset.data();
+		}
+		else if (type != 1)
+		{
+			return stop(Status::Corrupt, "invalid block type");
+		}
+
+		constexpr std::uint32_t litlen_mask{ (1u << litlen_bits) - 1 };
+		constexpr std::uint32_t offset_mask{ (1u << offset_bits) - 1 };
+
+		// Huffman block: after each refill, up to three literals in a row, or one whole match
+		for (;;)
+		{
+			if (!refill())
+				return stop(Status::Truncated);
+
+			std::uint32_t entry{ litlen_table[bits.buffer & litlen_mask] };
+
+			if (entry & literal)
+			{
+				if (out_end - out_next < 3)
+				{
+					if (out_next == out_end)
+						return stop(Status::Full);
+
+					bits.consume(entry & code_bits);
+					*out_next++ = static_cast<std::uint8_t>(entry >> value_shift);
+					continue;
+				}
+
+				bits.consume(entry & code_bits);
+				*out_next++ = static_cast<std::uint8_t>(entry >> value_shift);
+
+				entry = litlen_table[bits.buffer & litlen_mask];
+				if (entry & literal)
+				{
+					bits.consume(entry & code_bits);
+					*out_next++ = static_cast<std::uint8_t>(entry >> value_shift);
+
+					entry = litlen_table[bits.buffer & litlen_mask];
+					if (entry & literal)
+					{
+						bits.consume(entry & code_bits);
+						*out_next++ = static_cast<std::uint8_t>(entry >> value_shift);
+						continue;
+					}
+				}
+
+				if (bits.left < match_bits)
+					continue;
+			}
+
+			if (entry & subtable)
+			{
+				bits.consume(litlen_bits);
+				entry = litlen_table[(entry >> value_shift) + bits.peek(extra_of(entry))];
+			}
+
+			bits.consume(entry & code_bits);
+
+			if (entry & literal)
+			{
+				if (out_next == out_end)
+					return stop(Status::Full);
+
+				*out_next++ = static_cast<std::uint8_t>(entry >> value_shift);
+				continue;
+			}
+
+			if (entry & invalid)
+				return stop(Status::Corrupt, "invalid literal/length code");
+			if (entry & end_of_block)
+				break;
+
+			const size_t length{ (entry >> value_shift) + bits.take(extra_of(entry)) };
+
+			entry = offset_table[bits.buffer & offset_mask];
+			if (entry & subtable)
+			{
+				bits.consume(offset_bits);
+				entry = offset_table[(entry >> value_shift) + bits.peek(extra_of(entry))];
+			}
+
+			bits.consume(entry & code_bits);
+
+			if (entry & invalid)
+				return stop(Status::Corrupt, "invalid distance code");
+
+			const size_t distance{ (entry >> value_shift) + bits.take(extra_of(entry)) };
+
+			if (distance > static_cast<size_t>(out_next - out_begin))
+				return stop(Status::Corrupt, "invalid distance too far back");
+
+			const std::uint8_t* from{ out_next - distance };
+			const size_t room{ static_cast<size_t>(out_end - out_next) };
+
+			if (room >= length + 8)
+			{
+				// Word at a time, up to 7 bytes past the match: they are overwritten next
+				std::uint8_t* const copy_end{ out_next + length };
+
+				if (distance >= 8)
+				{
+					do
+					{
+						copy8(out_next, from);
+						out_next += 8;
+						from += 8;
+					} while (out_next < copy_end);
+				}
+				else if (distance == 1)
+				{
+					std::uint64_t run{ *from * 0x0101'0101'0101'0101ull };
+
+					do
+					{
+						std::memcpy(out_next, &run, 8);
+						out_next += 8;
+					} while (out_next < copy_end);
+				}
+				else
+				{
+					// A multiple of the distance at least 8 long is a period too: a byte at a time up to it, then words
+					const size_t period{ distance * ((8 + distance - 1) / distance) };
+					std::uint8_t* const pattern_end{ out_next + std::min(period, length) };
+
+					while (out_next < pattern_end)
+						*out_next++ = *from++;
+
+					for (from = out_next - period; out_next < copy_end; out_next += 8, from += 8)
+						copy8(out_next, from);
+				}
+
+				out_next = copy_end;
+			}
+			else
+			{
+				const size_t copied{ std::min(length, room) };
+
+				for (size_t i{}; i < copied; i++)
+					out_next[i] = from[i];
+				out_next += copied;
+
+				if (copied < length)
+					return stop(Status::Full);
+			}
+		}
+	}
+
+	// Adler-32 of the output, byte aligned and most significant byte first
+	const std::uint8_t* at{ bits.align() };
+
+	if (!at || bits.end - at < 4)
+		return stop(Status::Truncated);
+
+	const std::uint32_t expected{ std::uint32_t{ at[0] } << 24 | std::uint32_t{ at[1] } << 16 | std::uint32_t{ at[2] } << 8 | at[3] };
+
+	if (adler32(1, out_begin, static_cast<size_t>(out_next - out_begin)) != expected)
+		return stop(Status::Corrupt, "incorrect data check");
+
+	return stop(Status::Ended);
+}
+
+
+const char* fill::detail::FastInflater::read_dynamic_tables(BitReader& bits) noexcept
+{
+	constexpr std::uint8_t order[19]{ 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+	// 14 header bits, then at most 19 * 3: two refills
+	bits.refill();
+
+	const unsigned litlen_count{ bits.take(5) + 257 };
+	const unsigned offset_count{ bits.take(5) + 1 };
+	const unsigned precode_count{ bits.take(4) + 4 };
+
+	if (litlen_count > 286 || offset_count > 30)
+		return "too many length or distance symbols";
+
+	std::uint8_t precode_lens[19]{};
+
+	for (unsigned i{}; i < precode_count; i++)
+	{
+		if (i == 10)
+			bits.refill();
+
+		precode_lens[order[i]] = static_cast<std::uint8_t>(bits.take(3));
+	}
+
+	if (!build_table(precode.data(), precode_bits, precode_lens, 19, precode_symbols.data(), false))
+		return "invalid code lengths set";
+
+	// Literal/length and offset code lengths, one run: repeats may cross from one to the other
+	std::uint8_t lens[286 + 30]{};
+	const unsigned total{ litlen_count + offset_count };
+
+	for (unsigned i{}; i < total;)
+	{
+		bits.refill(); /*a 7 bit code and 7 extra bits*/
+
+		const std::uint32_t entry{ precode[bits.peek(precode_bits)] };
+		if (entry & invalid)
+			return "invalid code lengths set";
+
+		bits.consume(entry & code_bits);
+
+		const std::uint32_t symbol{ entry >> value_shift };
+
+		if (symbol < 16)
+		{
+			lens[i++] = static_cast<std::uint8_t>(symbol);
+			continue;
+		}
+
+		std::uint8_t repeated{};
+		unsigned times{};
+
+		if (symbol == 16)
+		{
+			if (i == 0)
+				return "invalid bit length repeat";
+
+			repeated = lens[i - 1];
+			times = 3 + bits.take(2);
+		}
+		else if (symbol == 17)
+		{
+			times = 3 + bits.take(3);
+		}
+		else
+		{
+			times = 11 + bits.take(7);
+		}
+
+		if (times > total - i)
+			return "invalid bit length repeat";
+
+		std::fill(lens + i, lens + i + times, repeated);
+		i += times;
+	}
+
+	if (lens[256] == 0)
+		return "invalid code -- missing end-of-block";
+
+	if (!build_table(litlen.data(), litlen_bits, lens, litlen_count, litlen_symbols.data()))
+		return "invalid literal/lengths set";
+	if (!build_table(offset.data(), offset_bits, lens + litlen_count, offset_count, offset_symbols.data()))
+		return "invalid distances set";
+
+	return nullptr;
+}
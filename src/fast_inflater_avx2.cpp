@@ -0,0 +1,78 @@
+#include "fast_inflater.hpp"
+
+#if defined(FILL_X86_SIMD)
+
+#include <algorithm>
+
+#include <immintrin.h>
+
+// AVX2 kernels
+// Adler-32 on 32 bytes at a time (as libdeflate does): byte sums from sad, position weighted sums from maddubs,
+// reduced modulo 65521 once per block, before any 32 bit lane can overflow.
+
+namespace
+{
+
+	constexpr std::uint32_t modulus{ 65521 };
+
+	// 256 vectors a block: no 32 bit lane gets past 2^27
+	constexpr size_t block_bytes{ 256 * 32 };
+
+	std::uint64_t sum_lanes(__m256i lanes) noexcept
+	{
+		alignas(32) std::uint32_t values[8];
+		_mm256_store_si256(reinterpret_cast<__m256i*>(values), lanes);
+
+		std::uint64_t sum{};
+		for (const std::uint32_t value : values)
+			sum += value;
+
+		return sum;
+	}
+
+} // namespace
+
+
+std::uint32_t fill::detail::avx2_adler32(std::uint32_t adler, const std::uint8_t* bytes, size_t size)
+{
+	std::uint64_t s1{ adler & 0xFFFF }, s2{ adler >> 16 };
+
+	const __m256i zero{ _mm256_setzero_si256() };
+	const __m256i ones{ _mm256_set1_epi16(1) };
+	const __m256i weights{ _mm256_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1) };
+
+	while (size >= 32)
+	{
+		const size_t block{ std::min(size, block_bytes) & ~size_t{ 31 } };
+
+		// Each byte adds itself to s1, and s1 to s2 for every byte after it: within a vector through the weights,
+		// across vectors as the sum of s1 before each of them (times 32)
+		__m256i sums{ zero }, weighted{ zero }, prefix{ zero };
+
+		for (const std::uint8_t* end{ bytes + block }; bytes < end; bytes += 32)
+		{
+			const __m256i vector{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes)) };
+
+			prefix = _mm256_add_epi32(prefix, sums);
+			sums = _mm256_add_epi32(sums, _mm256_sad_epu8(vector, zero));
+			weighted = _mm256_add_epi32(weighted, _mm256_madd_epi16(_mm256_maddubs_epi16(vector, weights), ones));
+		}
+
+		s2 += s1 * block + (sum_lanes(prefix) << 5) + sum_lanes(weighted);
+		s1 += sum_lanes(sums);
+
+		s1 %= modulus;
+		s2 %= modulus;
+		size -= block;
+	}
+
+	for (; size > 0; size--)
+	{
+		s1 += *bytes++;
+		s2 += s1;
+	}
+
+	return static_cast<std::uint32_t>((s2 % modulus) << 16 | (s1 % modulus));
+}
+
+#endif
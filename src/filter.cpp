@@ -0,0 +1,132 @@
+#include "filter.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+
+// Scalar kernels
+
+namespace
+{
+
+	std::uint8_t paeth_predictor(std::uint8_t a, std::uint8_t b, std::uint8_t c) noexcept
+	{
+		const int p{ static_cast<int>(a) + b - c };
+		const int pa{ std::abs(p - a) };
+		const int pb{ std::abs(p - b) };
+		const int pc{ std::abs(p - c) };
+
+		if (pa <= pb && pa <= pc)
+			return a;
+		if (pb <= pc)
+			return b;
+		return c;
+	}
+
+	// Predictor of byte i, from its left (a), upper (b) and upper left (c) neighbours
+	template <std::uint8_t Filter>
+	std::uint8_t predict(std::uint8_t a, std::uint8_t b, std::uint8_t c) noexcept
+	{
+		if constexpr (Filter == 0)
+			return 0;
+		else if constexpr (Filter == 1)
+			return a;
+		else if constexpr (Filter == 2)
+			return b;
+		else if constexpr (Filter == 3)
+			return static_cast<std::uint8_t>((a + b) >> 1);
+		else
+			return paeth_predictor(a, b, c);
+	}
+
+	template <std::uint8_t Filter>
+	std::uint64_t filter_range(const std::uint8_t* row, const std::uint8_t* prior, std::uint8_t* filtered, size_t begin, size_t end, size_t bpp) noexcept
+	{
+		std::uint64_t cost{};
+
+		for (size_t i{ begin }; i < end; i++)
+		{
+			const std::uint8_t a{ i >= bpp ? row[i - bpp] : std::uint8_t{} };
+			const std::uint8_t c{ i >= bpp ? prior[i - bpp] : std::uint8_t{} };
+
+			filtered[i] = static_cast<std::uint8_t>(row[i] - predict<Filter>(a, prior[i], c));
+			cost += static_cast<std::uint64_t>(std::abs(static_cast<std::int8_t>(filtered[i])));
+		}
+
+		return cost;
+	}
+
+	template <std::uint8_t Filter>
+	std::uint64_t filter(const std::uint8_t* row, const std::uint8_t* prior, std::uint8_t* filtered, size_t width_bytes, size_t bpp)
+	{
+		return filter_range<Filter>(row, prior, filtered, 0, width_bytes, bpp);
+	}
+
+} // namespace
+
+
+std::uint64_t fill::detail::filter_bytes(std::uint8_t filter, const std::uint8_t* row, const std::uint8_t* prior, std::uint8_t* filtered, size_t begin, size_t end, size_t bpp) noexcept
+{
+	switch (filter)
+	{
+	case 0: return filter_range<0>(row, prior, filtered, begin, end, bpp);
+	case 1: return filter_range<1>(row, prior, filtered, begin, end, bpp);
+	case 2: return filter_range<2>(row, prior, filtered, begin, end, bpp);
+	case 3: return filter_range<3>(row, prior, filtered, begin, end, bpp);
+	default: return filter_range<4>(row, prior, filtered, begin, end, bpp);
+	}
+}
+
+
+// Dispatch
+
+fill::detail::FilterKernels fill::detail::filter_kernels(SimdLevel level) noexcept
+{
+	FilterKernels kernels{ filter<0>, filter<1>, filter<2>, filter<3>, filter<4> };
+
+#if defined(FILL_X86_SIMD)
+	if (level >= SimdLevel::AVX2)
+		avx2_filter_kernels(kernels);
+#else
+	(void)level;
+#endif
+
+	return kernels;
+}
+
+std::uint8_t fill::detail::filter_row(const FilterKernels& kernels, int filter, const std::uint8_t* row, const std::uint8_t* prior, std::uint8_t* filtered, std::uint8_t* scratch, size_t width_bytes, size_t bpp)
+{
+	if (filter >= 0)
+	{
+		filtered[0] = static_cast<std::uint8_t>(filter);
+		kernels[filter](row, prior, filtered + 1, width_bytes, bpp);
+
+		return filtered[0];
+	}
+
+	// Minimum sum of absolute differences: the best candidate so far and the one being tried swap buffers
+	std::uint8_t* best{ filtered + 1 };
+	std::uint8_t* trial{ scratch };
+
+	std::uint8_t best_filter{};
+	std::uint64_t best_cost{ kernels[0](row, prior, best, width_bytes, bpp) };
+
+	for (std::uint8_t type{ 1 }; type < kernels.size(); type++)
+	{
+		const std::uint64_t cost{ kernels[type](row, prior, trial, width_bytes, bpp) };
+
+		if (cost < best_cost)
+		{
+			best_cost = cost;
+			best_filter = type;
+			std::swap(best, trial);
+		}
+	}
+
+	if (best != filtered + 1)
+		std::memcpy(filtered + 1, best, width_bytes);
+
+	filtered[0] = best_filter;
+	return best_filter;
+}
@@ -0,0 +1,49 @@
+#pragma once // filter.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// Internal header: PNG scanline filtering, the encoder side of unfilter.hpp.
+//	- Every kernel filters a row against the raw (unfiltered) row above it, and reports the sum of absolute
+//	  differences of the result (bytes taken as signed), the usual estimate of how well a row will compress.
+//	- Adaptive filtering tries all five filters on each row and keeps the cheapest.
+//	- There is no dependency between bytes here: the AVX2 kernels handle any pixel size, 32 bytes at a time.
+//
+// See: https://www.w3.org/TR/2003/REC-PNG-20031110/#12Filter-selection
+// ===================================================
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "simd.hpp"
+
+namespace fill::detail
+{
+
+	// Filters width_bytes bytes of row into filtered, returns the sum of |(int8_t)filtered[i]|. prior is never nullptr here.
+	using FilterKernel = std::uint64_t (*)(const std::uint8_t* row, const std::uint8_t* prior, std::uint8_t* filtered, size_t width_bytes, size_t bpp);
+
+	using FilterKernels = std::array<FilterKernel, 5>; /*indexed by filter type: None, Sub, Up, Average, Paeth*/
+
+
+	// Scalar filtering of bytes [begin, end) of a row, as the scalar kernels do it: the vector kernels' first pixel and tail
+	std::uint64_t filter_bytes(std::uint8_t filter, const std::uint8_t* row, const std::uint8_t* prior, std::uint8_t* filtered, size_t begin, size_t end, size_t bpp) noexcept;
+
+	// Kernels for a given instruction set, falling back to lower ones where there is no specialization.
+	FilterKernels filter_kernels(SimdLevel level) noexcept;
+
+	// Kernels for the running machine.
+	inline FilterKernels filter_kernels() noexcept { return filter_kernels(detect_simd_level()); }
+
+	// Filters one row into filtered (filter type byte first, then width_bytes bytes) and returns the filter type used.
+	// filter is a filter type, or -1 to pick the cheapest. prior is the previous raw row, all zeros for the first one.
+	// scratch holds width_bytes bytes
+	std::uint8_t filter_row(const FilterKernels& kernels, int filter, const std::uint8_t* row, const std::uint8_t* prior, std::uint8_t* filtered, std::uint8_t* scratch, size_t width_bytes, size_t bpp);
+
+
+	// Per instruction set kernel tables, only filled where a specialization exists.
+#if defined(FILL_X86_SIMD)
+	void avx2_filter_kernels(FilterKernels& kernels) noexcept;
+#endif
+
+} // fill::detail
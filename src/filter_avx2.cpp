@@ -0,0 +1,102 @@
+#include "filter.hpp"
+
+#if defined(FILL_X86_SIMD)
+
+#include <algorithm>
+
+#include <immintrin.h>
+
+// AVX2 kernels
+// Filtering only reads raw rows, so 32 bytes are filtered at once whatever the pixel size: the left neighbours are
+// simply loaded bpp bytes earlier. The cost is accumulated with psadbw on the absolute (signed) filtered bytes.
+
+namespace
+{
+
+	// floor((a + b) / 2) on bytes: avg_epu8 rounds up, so remove the carried bit when a + b is odd
+	__m256i average_floor(__m256i a, __m256i b) noexcept
+	{
+		const __m256i odd{ _mm256_and_si256(_mm256_xor_si256(a, b), _mm256_set1_epi8(1)) };
+		return _mm256_sub_epi8(_mm256_avg_epu8(a, b), odd);
+	}
+
+	// Paeth predictor of 16 bytes, on 16 bit lanes: p - a = b - c, p - b = a - c, p - c = (b - c) + (a - c)
+	__m128i paeth_predictor(__m128i a8, __m128i b8, __m128i c8) noexcept
+	{
+		const __m256i a{ _mm256_cvtepu8_epi16(a8) };
+		const __m256i b{ _mm256_cvtepu8_epi16(b8) };
+		const __m256i c{ _mm256_cvtepu8_epi16(c8) };
+
+		const __m256i pa_signed{ _mm256_sub_epi16(b, c) };
+		const __m256i pb_signed{ _mm256_sub_epi16(a, c) };
+
+		const __m256i pa{ _mm256_abs_epi16(pa_signed) };
+		const __m256i pb{ _mm256_abs_epi16(pb_signed) };
+		const __m256i pc{ _mm256_abs_epi16(_mm256_add_epi16(pa_signed, pb_signed)) };
+
+		const __m256i not_a{ _mm256_or_si256(_mm256_cmpgt_epi16(pa, pb), _mm256_cmpgt_epi16(pa, pc)) };
+		const __m256i not_b{ _mm256_cmpgt_epi16(pb, pc) };
+
+		const __m256i predictor{ _mm256_blendv_epi8(a, _mm256_blendv_epi8(b, c, not_b), not_a) };
+
+		const __m256i packed{ _mm256_packus_epi16(predictor, predictor) };
+		return _mm256_castsi256_si128(_mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+	}
+
+	template <std::uint8_t Filter>
+	__m256i predict(const std::uint8_t* row, const std::uint8_t* prior, size_t i, size_t bpp) noexcept
+	{
+		const auto load{ [](const std::uint8_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); } };
+
+		if constexpr (Filter == 1)
+			return load(row + i - bpp);
+		else if constexpr (Filter == 2)
+			return load(prior + i);
+		else if constexpr (Filter == 3)
+			return average_floor(load(row + i - bpp), load(prior + i));
+		else
+		{
+			const auto load16{ [](const std::uint8_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); } };
+
+			const __m128i low{ paeth_predictor(load16(row + i - bpp), load16(prior + i), load16(prior + i - bpp)) };
+			const __m128i high{ paeth_predictor(load16(row + i - bpp + 16), load16(prior + i + 16), load16(prior + i - bpp + 16)) };
+
+			return _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+		}
+	}
+
+	template <std::uint8_t Filter>
+	std::uint64_t filter(const std::uint8_t* row, const std::uint8_t* prior, std::uint8_t* filtered, size_t width_bytes, size_t bpp)
+	{
+		// The first pixel has no left neighbour: filtered by the scalar kernel, as is the tail
+		size_t i{ std::min(bpp, width_bytes) };
+		std::uint64_t cost{ fill::detail::filter_bytes(Filter, row, prior, filtered, 0, i, bpp) };
+
+		__m256i sums{ _mm256_setzero_si256() };
+
+		for (; i + 32 <= width_bytes; i += 32)
+		{
+			const __m256i x{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i)) };
+			__m256i result{ x };
+			if constexpr (Filter != 0)
+				result = _mm256_sub_epi8(x, predict<Filter>(row, prior, i, bpp));
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(filtered + i), result);
+			sums = _mm256_add_epi64(sums, _mm256_sad_epu8(_mm256_abs_epi8(result), _mm256_setzero_si256()));
+		}
+
+		const __m128i halves{ _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1)) };
+		cost += static_cast<std::uint64_t>(_mm_cvtsi128_si64(halves)) + static_cast<std::uint64_t>(_mm_extract_epi64(halves, 1));
+
+		return cost + fill::detail::filter_bytes(Filter, row, prior, filtered, i, width_bytes, bpp);
+	}
+
+} // namespace
+
+
+void fill::detail::avx2_filter_kernels(FilterKernels& kernels) noexcept
+{
+	kernels = { filter<0>, filter<1>, filter<2>, filter<3>, filter<4> };
+}
+
+#endif
@@ -1,7 +1,21 @@
 #include "image.hpp"
+#include "decoder_state.hpp"
+#include "mapped_file.hpp"
+#include "unfilter.hpp"
+#include "interlace.hpp"
+#include "convert.hpp"
+#include "pipeline.hpp"
+#include "crc32.hpp"
+#include "pnm_format.hpp"
 
 #include <array>
 #include <cmath>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <optional>
+#include <span>
+#include <utility>
 
 // Utility Classes
 
@@ -10,7 +24,7 @@ struct Chunk
 	std::uint32_t length{};
 	std::uint32_t type{};
 
-	std::vector<std::uint8_t> data{};
+	std::span<const std::uint8_t> data{}; /*points into the file's bytes, never copied*/
 
 	std::uint32_t CRC{};
 };
@@ -47,11 +61,11 @@ struct ColorType
 			break;
 
 		case Indexed_Color:
-			return 0;
+			return 1; /*one palette index per pixel*/
 			break;
 
 		case Greyscale_with_Alpha:
-			return 3;
+			return 2;
 			break;
 
 		case TrueColor_with_Alpha:
@@ -64,24 +78,33 @@ struct ColorType
 		}
 	}
 
+	// Allowed bit depths (see PNG spec, section 11.2.2)
+	constexpr bool allows(std::uint8_t bit_depth) const noexcept
+	{
+		switch (type)
+		{
+		case Greyscale:
+			return bit_depth == 1 || bit_depth == 2 || bit_depth == 4 || bit_depth == 8 || bit_depth == 16;
+
+		case Indexed_Color:
+			return bit_depth == 1 || bit_depth == 2 || bit_depth == 4 || bit_depth == 8;
+
+		case TrueColor:
+		case Greyscale_with_Alpha:
+		case TrueColor_with_Alpha:
+			return bit_depth == 8 || bit_depth == 16;
+
+		default:
+			return false;
+		}
+	}
+
 	Type type;
 };
 
 
 // Utility functions 
 
-void read_uint32(std::ifstream& stream, std::uint32_t& integer) noexcept
-{
-	stream.read(reinterpret_cast<char*>(&integer), sizeof(integer));
-	integer =
-		(
-			(reinterpret_cast<char*>(&integer)[0] << (3 * 8)) |
-			(reinterpret_cast<char*>(&integer)[1] << (2 * 8)) |
-			(reinterpret_cast<char*>(&integer)[2] << (1 * 8)) |
-			(reinterpret_cast<char*>(&integer)[3] << (0 * 8))
-			);
-}
-
 std::uint32_t uint8_as_uint32(std::uint8_t byte0, std::uint8_t byte1, std::uint8_t byte2, std::uint8_t byte3) noexcept
 {
 	return
@@ -94,6 +117,20 @@ std::uint32_t uint8_as_uint32(std::uint8_t byte0, std::uint8_t byte1, std::uint8
 	};
 }
 
+bool is_PNG(std::span<const std::uint8_t> bytes) noexcept
+{
+	return
+		bytes.size() >= 8 &&
+		bytes[0] == 0x89 &&
+		bytes[1] == 0x50 &&
+		bytes[2] == 0x4e &&
+		bytes[3] == 0x47 &&
+		bytes[4] == 0xd &&
+		bytes[5] == 0xa &&
+		bytes[6] == 0x1a &&
+		bytes[7] == 0xa;
+}
+
 std::string uint32_as_string(std::uint32_t _string) noexcept
 {
 	return 
@@ -105,85 +142,147 @@ std::string uint32_as_string(std::uint32_t _string) noexcept
 	};
 }
 
-std::vector<std::uint8_t> inflate(const std::vector<std::uint8_t>& in, std::uint32_t chunk_size = 16384)
+// Critical chunks have an uppercase first letter, bit 5 of their first byte clear (see PNG spec, section 5.4)
+bool crc_checked(fill::CrcCheck check, std::uint32_t type) noexcept
 {
-	if (in.size() > 4'294'967'295 /*Overflows if image's size is over 4GB*/)
-		throw std::runtime_error("ERROR::PNG_DEFLATE::Buffer overflow, size of file is superior to 4 GigaBytes");
-	if (in.size() <= 0)
-		throw std::runtime_error("ERROR::PNG_DEFLATE::In buffer doesn't contain any data");
-
+	return check == fill::CrcCheck::All || (check == fill::CrcCheck::Critical && (type & 0x2000'0000) == 0);
+}
 
-	std::vector<std::uint8_t> destination{};
+void throw_crc_mismatch(std::uint32_t type)
+{
+	throw std::runtime_error("ERROR::PNG_CHUNK::CRC mismatch in " + uint32_as_string(type) + " chunk");
+}
 
-	z_stream strm;
+// The CRC covers type and data, the type being right before the data in the file
+void check_crc(const Chunk& chunk, fill::CrcCheck check)
+{
+	if (crc_checked(check, chunk.type) && fill::detail::crc32(0, chunk.data.data() - 4, chunk.data.size() + 4) != chunk.CRC)
+		throw_crc_mismatch(chunk.type);
+}
 
-	/* allocate inflate state */
-	strm.zalloc = Z_NULL;
-	strm.zfree = Z_NULL;
-	strm.opaque = Z_NULL;
-	strm.avail_in = 0;
-	strm.next_in = Z_NULL;
+// Area to decode: the region clipped to the image, or all of it without one
+fill::Rect clip_region(const fill::Rect* region, std::uint32_t width, std::uint32_t height)
+{
+	fill::Rect area{ 0, 0, width, height };
 
+	if (region)
+	{
+		area.x = std::min(region->x, width);
+		area.y = std::min(region->y, height);
+		area.width = static_cast<std::uint32_t>(std::min<std::uint64_t>(std::uint64_t{ region->x } + region->width, width) - area.x);
+		area.height = static_cast<std::uint32_t>(std::min<std::uint64_t>(std::uint64_t{ region->y } + region->height, height) - area.y);
 
-	int ret;
+		if (area.width == 0 || area.height == 0)
+			throw std::runtime_error("ERROR::REGION::Region lies outside the image");
+	}
 
-	ret = inflateInit(&strm);
-	if (ret != Z_OK)
-		throw std::runtime_error("ERROR::PNG_DEFLATE::Cannot initialize inflate process on data: " + std::to_string(ret));
+	return area;
+}
 
-	/* decompress until deflate stream ends or end of file */
-	std::vector<std::uint8_t> out(chunk_size);
-	do
+// Samples of any MAXVAL to the whole range of their bit depth, rounded. Those above MAXVAL are clamped
+void scale_samples(const std::uint8_t* samples, std::uint8_t* scaled, size_t count, std::uint32_t maxval, std::uint8_t bit_depth) noexcept
+{
+	if (bit_depth == 8)
 	{
-		strm.avail_in = static_cast<uInt>(in.size());
+		for (size_t i{}; i < count; i++)
+			scaled[i] = static_cast<std::uint8_t>((std::min<std::uint32_t>(samples[i], maxval) * 255 + maxval / 2) / maxval);
+	}
+	else
+	{
+		for (size_t i{}; i < count; i++)
+		{
+			const std::uint32_t sample{ std::min<std::uint32_t>(static_cast<std::uint32_t>(samples[i * 2] << 8 | samples[i * 2 + 1]), maxval) };
+			const std::uint32_t value{ (sample * 65535 + maxval / 2) / maxval };
 
-		strm.next_in = const_cast<std::uint8_t*>(in.data());
+			scaled[i * 2] = static_cast<std::uint8_t>(value >> 8); /*big endian, as read*/
+			scaled[i * 2 + 1] = static_cast<std::uint8_t>(value);
+		}
+	}
+}
 
-		/* run inflate() on input until output buffer not full */
-		do
-		{
-			strm.avail_out = chunk_size;
-			strm.next_out = out.data();
-			ret = inflate(&strm, Z_NO_FLUSH);
+// Image Class
 
-			if (ret == Z_STREAM_ERROR)
-				throw std::runtime_error("ERROR::PNG_DEFLATE::State not clobbered: " + std::to_string(ret));
+fill::Image::Image(const std::filesystem::path& path_to_file)
+{
+	loadFromFile(path_to_file);
+}
 
-			switch (ret)
-			{
-			case Z_NEED_DICT:
-				ret = Z_DATA_ERROR;
-				[[fallthrough]];
-			case Z_DATA_ERROR:
-			case Z_MEM_ERROR:
-				inflateEnd(&strm);
-				throw std::runtime_error("ERROR::PNG_DEFLATE::Couldn't read data properly: " + std::to_string(ret));
-			}
+fill::Image::Image(std::span<const std::byte> file_bytes)
+{
+	loadFromMemory(file_bytes);
+}
 
-			std::uint16_t have = chunk_size - strm.avail_out;
+fill::Image::Image(std::uint32_t width, std::uint32_t height, std::uint8_t color_channel, std::uint8_t bit_depth, const PixelLayout& layout)
+	: layout{ layout }
+	, width{ width }
+	, height{ height }
+	, bit_depth{ bit_depth }
+	, color_channel{ color_channel }
+	, bpp{ static_cast<std::uint8_t>(color_channel * (bit_depth / 8)) }
+{
+	allocate();
+}
 
-			destination.insert(destination.end(), out.begin(), out.begin() + have);
 
-		} while (strm.avail_out == 0);
+void fill::Image::allocate()
+{
+	if (!layout.valid())
+		throw std::runtime_error("ERROR::LAYOUT::Alignments must be powers of two");
 
-		/* done when inflate() says it's done */
-	} while (ret != Z_STREAM_END);
+	pitch = layout.pitch(width, bpp);
 
-	/* clean up and return */
-	inflateEnd(&strm);
-	return destination;
+	if (pitch / std::max<size_t>(bpp, 1) < width || (height != 0 && pitch > std::numeric_limits<size_t>::max() / height))
+		throw std::runtime_error("ERROR::LAYOUT::Image is too large to be held in memory");
+
+	// The buffer, and its capacity, is kept as long as its memory comes from the right place
+	if (image_data.get_allocator() != layout.allocator())
+		image_data = PixelBuffer(layout.allocator());
+
+	image_data.resize(pitch * height);
 }
 
+void fill::Image::setWidth(std::uint32_t new_width)
+{
+	if (color_channel == 0) /*no format yet, nor pixels to hold*/
+	{
+		width = new_width;
+		return;
+	}
+
+	if (new_width == width)
+		return;
 
-// Image Class
+	// Rows move when the pitch changes: copied into a buffer of the new one
+	Image resized{ new_width, height, color_channel, bit_depth, layout };
 
-fill::Image::Image(const std::filesystem::path& path_to_file)
+	if (size() >= size_bytes())
+		resized.blit(*this);
+
+	*this = std::move(resized);
+}
+
+void fill::Image::setHeight(std::uint32_t new_height)
 {
-	loadFromFile(path_to_file);
+	height = new_height;
+
+	if (color_channel != 0)
+		allocate(); /*same pitch, rows stay where they are*/
 }
 
 
 void fill::Image::loadFromFile(const std::filesystem::path& path_to_file)
+{
+	Decoder decoder{};
+	loadFromFile(path_to_file, decoder);
+}
+
+void fill::Image::loadFromMemory(std::span<const std::byte> file_bytes)
+{
+	Decoder decoder{};
+	loadFromMemory(file_bytes, decoder);
+}
+
+void fill::Image::loadFromFile(const std::filesystem::path& path_to_file, Decoder& decoder)
 {
 	if (path_to_file.has_extension())
 	{
@@ -192,7 +291,10 @@ void fill::Image::loadFromFile(const std::filesystem::path& path_to_file)
 			[](unsigned char c) { return std::tolower(c); });
 
 		if (extension == ".png")
-			return loadFromPNG(path_to_file);
+			return loadFromPNG(path_to_file, decoder);
+
+		if (extension == ".pam" || extension == ".ppm" || extension == ".pgm" || extension == ".pnm")
+			return loadFromPNM(path_to_file, decoder);
 
 		// Add other files
 	}
@@ -200,261 +302,842 @@ void fill::Image::loadFromFile(const std::filesystem::path& path_to_file)
 	throw std::runtime_error("ERROR::No compatible version of the program was found for the file: " + path_to_file.string());
 }
 
+void fill::Image::loadFromMemory(std::span<const std::byte> file_bytes, Decoder& decoder)
+{
+	const std::span<const std::uint8_t> bytes{ reinterpret_cast<const std::uint8_t*>(file_bytes.data()), file_bytes.size() };
+
+	if (is_PNG(bytes))
+		return loadFromPNG(bytes, decoder);
 
-// --- Transformation Algorithms
+	if (fill::detail::is_PNM(bytes))
+		return loadFromPNM(bytes, decoder);
 
-fill::Image fill::Image::merge_images(const Image& image, bool merge_horizontaly)
+	// Add other files
+
+	throw std::runtime_error("ERROR::No compatible version of the program was found for the data in memory");
+}
+
+void fill::Image::loadRegion(const std::filesystem::path& path_to_file, const Rect& region)
+{
+	Decoder decoder{};
+	loadRegion(path_to_file, region, decoder);
+}
+
+void fill::Image::loadRegion(std::span<const std::byte> file_bytes, const Rect& region)
 {
-	return Image();
+	Decoder decoder{};
+	loadRegion(file_bytes, region, decoder);
 }
 
-fill::Image fill::Image::resize(std::uint32_t new_width, std::uint32_t new_height)
-{	
-	Image background{};
-	std::uint32_t new_size{ new_width * new_height * bpp * bpp };
+void fill::Image::loadRegion(const std::filesystem::path& path_to_file, const Rect& region, Decoder& decoder)
+{
+	fill::detail::StageClock clock{};
+	const fill::detail::MappedFile file{ path_to_file };
+	clock.lap(decoder.state->pending_map_ns);
 
-	while (background.size() < new_size)
-		background.getImage().push_back(0);
+	loadRegion(std::as_bytes(file.bytes()), region, decoder); /*only the pages holding data up to the region's last row are ever read*/
+}
+
+void fill::Image::loadRegion(std::span<const std::byte> file_bytes, const Rect& region, Decoder& decoder)
+{
+	const std::span<const std::uint8_t> bytes{ reinterpret_cast<const std::uint8_t*>(file_bytes.data()), file_bytes.size() };
 
+	if (is_PNG(bytes))
+		return loadFromPNG(bytes, decoder, &region);
 
-	background.setWidth(new_width);
-	background.setHeight(new_height);
+	if (fill::detail::is_PNM(bytes))
+		return loadFromPNM(bytes, decoder, &region);
 
-	background.insert(*this, 0);
+	// Add other files
 
-	return background;
+	throw std::runtime_error("ERROR::No compatible version of the program was found for the data in memory");
 }
 
+
+// --- Transformation Algorithms
+
 fill::Image fill::Image::insert(Image& other, std::uint32_t offset)
 {
 	Image new_image{};
 
-	new_image.setWidth(std::max(width, other.getWidth()));
-	new_image.setHeight(std::max(height, other.getHeight()));
+	new_image.width = std::max(width, other.getWidth());
+	new_image.height = std::max(height, other.getHeight());
+	new_image.bit_depth = bit_depth;
+	new_image.color_channel = color_channel;
+	new_image.bpp = bpp;
+	new_image.layout = layout;
+
+	// Allocated and filled once, the blit only overwrites it
+	new_image.allocate();
+	std::fill(new_image.image_data.begin(), new_image.image_data.end(), std::uint8_t{ 0xFF });
+
+	offset = std::min(offset, new_image.width - std::min(width, other.getWidth()));
 
-	
+	if (size())
+		new_image.blit(*this, static_cast<std::int32_t>(offset), 0); /*clipped at the right edge*/
 
-	offset = std::min(offset, new_image.getWidth() - std::min(width, other.getWidth()));
+	return new_image;
+}
 
-	offset *= bpp;
-	
-	while (new_image.size() < new_image.size_bytes())
-		new_image.getImage().push_back(0xFF); /*make up space*/
+void fill::Image::blit(const ImageView& source, std::int32_t x, std::int32_t y)
+{
+	blit(source, x, y, Rect{ 0, 0, source.getWidth(), source.getHeight() });
+}
 
-	
-	std::uint64_t line{};
+void fill::Image::blit(const ImageView& source, std::int32_t x, std::int32_t y, const Rect& source_rect)
+{
+	if (source.getBitDepth() != bit_depth)
+		throw std::runtime_error("ERROR::BLIT::Images have different bit depths");
 
-	std::uint64_t oWidth_bytes{ getWidth() * bpp };
+	const size_t source_bpp{ source.getBytesPerPixel() };
+	const size_t destination_bpp{ bpp };
 
-	for (size_t i{}; i < new_image.size_bytes(); i += new_image.getWidth() * 4)
+	if (size() < size_bytes() || pitch < static_cast<size_t>(width) * destination_bpp)
+		throw std::runtime_error("ERROR::BLIT::Image holds fewer bytes than its dimensions describe");
+
+	detail::ConvertKernel convert{};
+
+	if (source.getColorChannel() != color_channel)
 	{
-		if (line * getWidth() * bpp < size())
-		{
-			new_image.getImage().insert(
-				new_image.getImage().begin() + i + offset, /*start of line n of original image*/
-				getImage().begin() + line * oWidth_bytes, /*start of line n of other image */
-				getImage().begin() + line * oWidth_bytes + oWidth_bytes /*end of line n of other image*/
-			);
-
-			new_image.getImage().insert(
-				new_image.getImage().begin() + i + line * oWidth_bytes + oWidth_bytes, /*end of line n of original image*/
-				new_image.getWidth() * bpp - oWidth_bytes, /*calculate how many bytes are left between end of original image and other*/
-				0xFF /*set to 0 for transparency (don't want to alter the image)*/
-			);
-		}
+		if (bit_depth != 8)
+			throw std::runtime_error("ERROR::BLIT::Converting between formats is only supported for 8 bit images");
+
+		convert = detail::convert_kernel(source.getColorChannel(), color_channel);
 
-		line++;
+		if (!convert)
+			throw std::runtime_error("ERROR::BLIT::No conversion between " + std::to_string(source.getColorChannel()) + " and " + std::to_string(color_channel) + " channels");
 	}
 
+	// Clip the source area to the source, then to the destination (in 64 bits, offsets can be negative)
+	std::int64_t left{ std::min<std::int64_t>(source_rect.x, source.getWidth()) };
+	std::int64_t top{ std::min<std::int64_t>(source_rect.y, source.getHeight()) };
+	std::int64_t right{ std::min<std::int64_t>(static_cast<std::int64_t>(source_rect.x) + source_rect.width, source.getWidth()) };
+	std::int64_t bottom{ std::min<std::int64_t>(static_cast<std::int64_t>(source_rect.y) + source_rect.height, source.getHeight()) };
 
-	// Crop image to fit
-	new_image.getImage().erase(new_image.getImage().begin() + new_image.getWidth() * new_image.getHeight() * bpp, new_image.getImage().end());
+	std::int64_t destination_x{ x }, destination_y{ y };
 
-	return new_image;
-}
+	if (destination_x < 0)
+	{
+		left -= destination_x;
+		destination_x = 0;
+	}
+	if (destination_y < 0)
+	{
+		top -= destination_y;
+		destination_y = 0;
+	}
+
+	right = std::min<std::int64_t>(right, left + (static_cast<std::int64_t>(width) - destination_x));
+	bottom = std::min<std::int64_t>(bottom, top + (static_cast<std::int64_t>(height) - destination_y));
+
+	if (left >= right || top >= bottom)
+		return;
+
+	const size_t columns{ static_cast<size_t>(right - left) };
+	const size_t source_pitch{ source.getStride() };
+	const size_t destination_pitch{ pitch };
+
+	const size_t rows{ static_cast<size_t>(bottom - top) };
 
+	const std::uint8_t* from{ source.row(static_cast<std::uint32_t>(top)) + static_cast<size_t>(left) * source_bpp };
+	std::uint8_t* to{ data() + static_cast<size_t>(destination_y) * destination_pitch + static_cast<size_t>(destination_x) * destination_bpp };
 
+	// When source views this image, moving an area down must start from its last row
+	std::ptrdiff_t source_step{ static_cast<std::ptrdiff_t>(source_pitch) };
+	std::ptrdiff_t destination_step{ static_cast<std::ptrdiff_t>(destination_pitch) };
+
+	const std::uint8_t* first{ image_data.data() };
+	const bool aliased{ from >= first && from < first + image_data.size() };
+
+	if (aliased && to > from)
+	{
+		from += (rows - 1) * source_pitch;
+		to += (rows - 1) * destination_pitch;
+		source_step = -source_step;
+		destination_step = -destination_step;
+	}
+
+	for (size_t row{}; row < rows; row++)
+	{
+		if (convert)
+			convert(from, to, columns);
+		else
+			std::memmove(to, from, columns * destination_bpp); /*a row may overlap itself when source is this image*/
+
+		from += source_step;
+		to += destination_step;
+	}
+}
 
 
 
 // --- PNG loading
 
-void fill::Image::loadFromPNG(const std::filesystem::path& path_png)
+void fill::Image::loadFromPNG(const std::filesystem::path& path_png, Decoder& decoder)
 {
-	std::ifstream file{};
-	file.open(path_png.string(), std::ios::binary);
+	fill::detail::StageClock clock{};
+	const fill::detail::MappedFile file{ path_png };
+	clock.lap(decoder.state->pending_map_ns);
 
+	loadFromPNG(file.bytes(), decoder); /*the mapping outlives the decode*/
+}
+
+void fill::Image::loadFromPNG(std::span<const std::uint8_t> png_bytes, Decoder& decoder, const Rect* region)
+{
+	std::span<const std::uint8_t> stream{ png_bytes };
 
-	std::array<std::uint8_t, 8> header; 
-	file.read(reinterpret_cast<char*>(header.data()), header.size()); /*fetch header*/
+	DecodeStats& stats{ decoder.state->stats };
+	fill::detail::StageClock& clock{ decoder.state->clock };
 
-	if (header[0] == 0x89 &&
-		header[1] == 0x50 &&
-		header[2] == 0x4e &&
-		header[3] == 0x47 &&
-		header[4] == 0xd &&
-		header[5] == 0xa &&
-		header[6] == 0x1a &&
-		header[7] == 0xa)
+	if constexpr (decode_stats_enabled)
 	{
+		stats = DecodeStats{};
+		stats.map_ns = std::exchange(decoder.state->pending_map_ns, 0);
+		stats.file_bytes = png_bytes.size();
+		clock.restart();
+	}
+
+	if (is_PNG(stream))
+	{
+		stream = stream.subspan(8); /*skip header*/
 
 		Chunk ihdr;
-		read_PNGchunk(file, ihdr); /*fetch IHDR chunk*/
+		read_PNGchunk(stream, ihdr); /*fetch IHDR chunk*/
+		fill::detail::count(stats.chunks);
 
-		if (uint32_as_string(ihdr.type) != "IHDR")
+		if (uint32_as_string(ihdr.type) != "IHDR" || ihdr.length != 13)
 			throw std::runtime_error("ERROR::WRONG_TYPE::File doesn't correspond to the PNG standard::No corresponding IHDR chunk");
 
+		const CrcCheck crc_check{ decoder.state->options.crc_check };
+		check_crc(ihdr, crc_check);
+
 		// Fetch attributes
 		width = uint8_as_uint32(ihdr.data[0], ihdr.data[1], ihdr.data[2], ihdr.data[3]);
 		height = uint8_as_uint32(ihdr.data[4], ihdr.data[5], ihdr.data[6], ihdr.data[7]);
-		bit_depth = ihdr.data[8];
+		const std::uint8_t file_bit_depth{ ihdr.data[8] };
 		ColorType color_type = static_cast<ColorType>(ihdr.data[9]);
 		compression_method = ihdr.data[10];
 		filter_method = ihdr.data[11];
 		interlace_method = ihdr.data[12];
 
-		color_channel = color_type.asBytes();
+		if (!color_type.allows(file_bit_depth))
+			throw std::runtime_error("ERROR::PNG::Invalid bit depth " + std::to_string(file_bit_depth) + " for color type " + std::to_string(ihdr.data[9]));
+		if (interlace_method > 1)
+			throw std::runtime_error("ERROR::PNG::Unknown interlace method: " + std::to_string(interlace_method));
+
+		const Rect area{ clip_region(region, width, height) };
 
-		
-		std::vector<uint8_t> raw_data{};
-		// Fetch Different Chunks & Collect Data
-		while (!file.eof())
+		detail::PngFormat& format{ decoder.state->png };
+		format = detail::PngFormat{};
+		format.bit_depth = file_bit_depth;
+		format.color_type = color_type.type;
+		format.channels = color_type.asBytes();
+		format.palette.fill(0xFF00'0000); /*out of range indices come out opaque black*/
+
+		// Ancillary and palette chunks all come before the image data
+		for (std::span<const std::uint8_t> ahead{ stream };;)
 		{
 			Chunk chunk;
-			read_PNGchunk(file, chunk);
+			read_PNGchunk(ahead, chunk);
 
-			std::string type{ uint32_as_string(chunk.type) };
+			const std::string type{ uint32_as_string(chunk.type) };
 
 			if (type == "IDAT")
-				raw_data.insert(raw_data.end(), chunk.data.begin(), chunk.data.end());
+				break;
+			if (type == "IEND")
+				throw std::runtime_error("ERROR::PNG::No image data");
+
+			fill::detail::count(stats.chunks); /*the first IDAT is counted when the inflater reads it*/
+			check_crc(chunk, crc_check);
+
+			if (type == "PLTE")
+			{
+				if (chunk.length % 3 != 0 || chunk.length > 256 * 3)
+					throw std::runtime_error("ERROR::PNG::Invalid PLTE chunk length: " + std::to_string(chunk.length));
+
+				format.palette_size = static_cast<std::uint16_t>(chunk.length / 3);
+
+				for (size_t i{}; i < format.palette_size; i++)
+					format.palette[i] = uint8_as_uint32(0xFF, chunk.data[i * 3 + 2], chunk.data[i * 3 + 1], chunk.data[i * 3]); /*RGBA in memory*/
+			}
+			else if (type == "tRNS")
+			{
+				if (format.indexed())
+				{
+					// One alpha per palette entry, the missing ones are opaque
+					for (size_t i{}; i < std::min<size_t>(chunk.length, 256); i++)
+						format.palette[i] = (format.palette[i] & 0x00FF'FFFF) | static_cast<std::uint32_t>(chunk.data[i]) << 24;
+				}
+				else if (chunk.length == static_cast<size_t>(format.channels) * 2 && (format.channels == 1 || format.channels == 3))
+				{
+					format.transparent_key = true;
+
+					for (size_t c{}; c < format.channels; c++)
+						format.key[c] = static_cast<std::uint16_t>(chunk.data[c * 2] << 8 | chunk.data[c * 2 + 1]);
+				}
+			}
+
+			stream = ahead; /*the inflater starts from the first IDAT*/
 		}
 
-		// Apply DEFLATE
-		std::vector<std::uint8_t> decompressed_data{};
-		decompressed_data = inflate(raw_data);
+		if (format.indexed() && format.palette_size == 0)
+			throw std::runtime_error("ERROR::PNG::Indexed color image without a PLTE chunk");
+
+		decoder.state->expander.configure(format, decoder.state->options.format, width);
+
+		color_channel = decoder.state->expander.channels();
+		bit_depth = decoder.state->expander.bit_depth();
+		bpp = static_cast<std::uint8_t>(color_channel * (bit_depth / 8));
+
+
+		clock.lap(stats.parse_ns);
+
+		// IDAT payloads in place, one chunk at a time, up to IEND. Timed by whoever reads them, the inflater or a pipeline.
+		// Checked ones are handed out a slice at a time, each added to the chunk's CRC right before it is inflated (still in cache),
+		// and compared with it along with the chunk's last slice. The cursor lives in the decoder's state, so that the callable
+		// only holds a pointer to it, and std::function never allocates
+		decoder.state->idat_cursor = detail::IdatCursor{ stream };
+
+		decoder.state->idat = [state = decoder.state.get()]() -> std::span<const std::uint8_t>
+		{
+			constexpr size_t slice_bytes{ 32 * 1024 };
+
+			detail::IdatCursor& cursor{ state->idat_cursor };
+			DecodeStats& stats{ state->stats };
+			const CrcCheck crc_check{ state->options.crc_check };
+
+			Chunk chunk;
+
+			while (cursor.left.empty())
+			{
+				if (cursor.chunks.empty())
+					return {};
+
+				read_PNGchunk(cursor.chunks, chunk);
+				fill::detail::count(stats.chunks);
+
+				const std::string name{ uint32_as_string(chunk.type) };
+
+				if (name == "IDAT")
+				{
+					fill::detail::count(stats.idat_chunks);
+					fill::detail::count(stats.bytes_read, chunk.length);
 
-		// Process Data
-		unfilter_PNG(decompressed_data);
+					// Empty ones are valid, and skipped: an empty span is the end of the data to whoever reads them
+					if (chunk.data.empty())
+					{
+						check_crc(chunk, crc_check);
+						continue;
+					}
+
+					if (!crc_checked(crc_check, chunk.type))
+						return chunk.data;
+
+					cursor.left = chunk.data;
+					cursor.crc = fill::detail::crc32(0, chunk.data.data() - 4, 4);
+					cursor.expected_crc = chunk.CRC;
+					cursor.type = chunk.type;
+					break;
+				}
+
+				check_crc(chunk, crc_check);
+
+				if (name == "IEND")
+					return {};
+			}
+
+			const std::span<const std::uint8_t> slice{ cursor.left.first(std::min(cursor.left.size(), slice_bytes)) };
+			cursor.left = cursor.left.subspan(slice.size());
+
+			cursor.crc = fill::detail::crc32(cursor.crc, slice.data(), slice.size());
+
+			if (cursor.left.empty() && cursor.crc != cursor.expected_crc)
+				throw_crc_mismatch(cursor.type);
+
+			return slice;
+		};
+
+		// Apply DEFLATE & Process Data, one scanline at a time
+		unfilter_PNG(decoder, area);
+
+		if constexpr (decode_stats_enabled)
+		{
+			stats.total_ns = stats.map_ns + stats.parse_ns + stats.unfilter_ns + stats.expand_ns + (stats.pipelined ? stats.wait_ns : stats.read_ns + stats.inflate_ns);
+			stats.images = 1;
+			decoder.state->total_stats += stats;
+
+			if (decoder.state->options.on_stats)
+				decoder.state->options.on_stats(stats);
+		}
 	}
 	else
 		throw std::runtime_error("ERROR::WRONG_TYPE::PNG file couldn't be read properly::No proper header");
 }
 
-void fill::Image::read_PNGchunk(std::ifstream& stream, Chunk& chunk)
+void fill::Image::read_PNGchunk(std::span<const std::uint8_t>& stream, Chunk& chunk)
 {
-	read_uint32(stream, chunk.length);
-	chunk.data.resize(chunk.length);
-	
-	read_uint32(stream, chunk.type);
-	
-	stream.read(reinterpret_cast<char*>(chunk.data.data()), chunk.data.size());
+	constexpr size_t overhead{ 12 }; /*length, type and CRC*/
+
+	if (stream.size() < overhead)
+		throw std::runtime_error("ERROR::PNG_CHUNK::File ends in the middle of a chunk");
 
-	read_uint32(stream, chunk.CRC);
+	chunk.length = uint8_as_uint32(stream[0], stream[1], stream[2], stream[3]);
+	chunk.type = uint8_as_uint32(stream[4], stream[5], stream[6], stream[7]);
+
+	if (chunk.length > 0x7FFF'FFFF /*see PNG spec, section 5.3*/ || chunk.length > stream.size() - overhead)
+		throw std::runtime_error("ERROR::PNG_CHUNK::Chunk length runs past the end of the file: " + std::to_string(chunk.length));
+
+	chunk.data = stream.subspan(8, chunk.length);
+
+	const auto crc{ stream.subspan(8 + chunk.length, 4) };
+	chunk.CRC = uint8_as_uint32(crc[0], crc[1], crc[2], crc[3]);
+
+	stream = stream.subspan(overhead + chunk.length); /*move to the next chunk*/
 }
 
-void fill::Image::unfilter_PNG(std::vector<std::uint8_t>& filtered_data)
+void fill::Image::unfilter_PNG(Decoder& decoder, const Rect& region)
 {
-	const auto bpp{ static_cast<std::uint16_t>(color_channel * (bit_depth / 8)) };
+	detail::Inflater& inflater{ decoder.state->inflater };
+	detail::RowExpander& expander{ decoder.state->expander };
+	const detail::PngFormat& format{ decoder.state->png };
+
+	DecodeStats& stats{ decoder.state->stats };
+	fill::detail::StageClock& clock{ decoder.state->clock };
 
-	const std::uint32_t width_bytes{ width * bpp };
+	const std::uint32_t image_width{ width }, image_height{ height };
 
-	std::uint8_t filter{};
+	const size_t filter_bpp{ format.filter_bpp() };
+	const size_t raw_bytes{ format.row_bytes(image_width) };
+	const size_t width_bytes{ static_cast<size_t>(region.width) * bpp };
 
-	std::uint8_t a{}, b{}, c{};
-	std::uint16_t p{}, pa{}, pb{}, pc{};
+	// The decompressed stream is exactly height * (1 + raw_bytes)
+	if (static_cast<size_t>(image_width) * bpp / bpp != image_width || (raw_bytes + 1) > std::numeric_limits<size_t>::max() / std::max<size_t>(image_height, 1) ||
+		width_bytes > std::numeric_limits<size_t>::max() / std::max<size_t>(region.height, 1))
+		throw std::runtime_error("ERROR::PNG_UNFILTER::Image described by IHDR is too large to be held in memory");
 
-	std::uint8_t data{};
+	// Only the region is kept, the image takes its size. Rows are written padded to the pitch the options ask for
+	width = region.width;
+	height = region.height;
+	layout = decoder.state->options.layout;
 
-	
-	for (size_t byte_index{}; byte_index < filtered_data.size(); byte_index++)
+	const std::uint8_t* previous_pixels{ image_data.data() };
+	allocate();
+
+	if (image_data.data() != previous_pixels && !image_data.empty())
 	{
+		fill::detail::count(stats.allocations);
+		fill::detail::count(stats.allocated_bytes, image_data.capacity());
+	}
+
+	const auto row_start{ [this](size_t y) { return image_data.data() + y * pitch; } };
+
+	const size_t region_end{ static_cast<size_t>(region.y) + region.height }; /*no row at or below it is ever inflated or unfiltered*/
+	const bool whole_rows{ region.x == 0 && region.width == image_width };
+
+	const fill::detail::UnfilterKernels kernels{ fill::detail::unfilter_kernels(filter_bpp) };
+
+	// Row window: the scanline being inflated, and the previous one already reconstructed --
+	// in image_data when whole rows need no expansion, in raw_rows otherwise
+	std::pmr::vector<std::uint8_t>& filtered_row{ decoder.state->filtered_row };
+	fill::detail::resize_counted(filtered_row, raw_bytes + 1 /*filter byte*/, stats);
+	const std::uint8_t* prior{ nullptr }; /*no previous row for the first scanline*/
+
+	std::pmr::vector<std::uint8_t>& raw_rows{ decoder.state->raw_rows };
+	std::pmr::vector<std::uint8_t>& pass_row{ decoder.state->pass_row };
+
+	const DecodeOptions& options{ decoder.state->options };
+
+	// The builtin inflater inflates every scanline the region needs at once, before any is unfiltered.
+	// Errors it finds only surface when a scanline past them is needed, or at the end, as they would with zlib
+	const bool whole_stream{ options.inflater == InflateBackend::Builtin };
+	std::pmr::vector<std::uint8_t>& inflated{ decoder.state->inflated };
+	fill::detail::FastInflater::Result inflate_result{};
+	size_t inflated_position{};
+	std::exception_ptr read_error{}; /*chunks after the stream's end are never read with zlib: only thrown if the inflater ran out of input*/
+
+	// Inflating runs on its own thread when the image is large enough, and read to its end (a pipeline can't stop early)
+	std::optional<fill::detail::DecodePipeline> pipeline{};
 
-		if (byte_index % width_bytes == 0)
+	if (whole_stream)
+	{
+		// Payloads are used in place when there is a single one, put end to end otherwise
+		std::span<const std::uint8_t> compressed{ decoder.state->idat() };
+		std::pmr::vector<std::uint8_t>& gathered{ decoder.state->idat_stream };
+
+		for (;;)
 		{
-			filter = filtered_data[byte_index];
-			filtered_data.erase(filtered_data.begin() + byte_index);
+			std::span<const std::uint8_t> payload{};
+
+			try
+			{
+				payload = decoder.state->idat();
+			}
+			catch (const std::runtime_error&)
+			{
+				read_error = std::current_exception();
+			}
+
+			if (payload.empty())
+				break; /*the end of the data, empty IDATs never show up*/
+
+			// Slices of the same chunk follow each other in the file
+			if (compressed.data() != gathered.data() && compressed.data() + compressed.size() == payload.data())
+			{
+				compressed = { compressed.data(), compressed.size() + payload.size() };
+				continue;
+			}
+
+			if (compressed.data() != gathered.data())
+			{
+				fill::detail::resize_counted(gathered, compressed.size(), stats);
+				std::memcpy(gathered.data(), compressed.data(), compressed.size());
+			}
+
+			const size_t size{ gathered.size() };
+			fill::detail::resize_counted(gathered, size + payload.size(), stats);
+			std::memcpy(gathered.data() + size, payload.data(), payload.size());
+
+			compressed = gathered;
 		}
 
-		data = filtered_data[byte_index];
+		clock.lap(stats.read_ns);
 
+		// Scanlines down to the region's last row, and every pass when interlaced: later ones come after the whole of earlier ones
+		size_t stream_bytes{ region_end * (raw_bytes + 1) };
 
-		switch (filter)
+		if (interlace_method != 0)
 		{
-		// Sub
-		case 1:
-			if (byte_index < bpp || (byte_index / bpp) % width == 0)
-				a = 0;
-			else
-				a = image_data[byte_index - bpp];
+			stream_bytes = 0;
+			for (const fill::detail::Adam7Pass& pass : fill::detail::adam7_passes(image_width, image_height))
+				if (pass.width > 0)
+					stream_bytes += static_cast<size_t>(pass.height) * (format.row_bytes(pass.width) + 1);
+		}
 
+		fill::detail::resize_counted(inflated, stream_bytes, stats);
+		inflate_result = decoder.state->fast_inflater.inflate(compressed, inflated);
 
-			data += a;
-			break;
+		clock.lap(stats.inflate_ns);
+	}
+	else if (options.pipelined && region_end == image_height && static_cast<size_t>(image_height) * (raw_bytes + 1) >= options.pipeline_min_bytes)
+	{
+		constexpr size_t ring_blocks{ 8 };
+		const size_t block_bytes{ std::max<size_t>(256 * 1024, (raw_bytes + 1) * 4) }; /*a few rows per block, only rows straddling two are copied*/
 
-		// Up
-		case 2:
-			if (byte_index < width_bytes)
-				b = 0;
-			else
-				b = image_data[byte_index - width_bytes];
+		std::pmr::vector<std::uint8_t>& ring{ decoder.state->pipeline_ring };
+		fill::detail::resize_counted(ring, block_bytes * ring_blocks, stats);
 
+		pipeline.emplace(inflater, decoder.state->idat, ring, block_bytes);
+	}
+	else
+	{
+		// Payloads are fetched from inside the inflater, the time it waits for them is reading.
+		// A single pointer is captured, small enough for std::function to hold without allocating
+		inflater.reset([state = decoder.state.get()]() -> std::span<const std::uint8_t>
+		{
+			state->clock.lap(state->stats.inflate_ns);
+			const std::span<const std::uint8_t> payload{ state->idat() };
+			state->clock.lap(state->stats.read_ns);
 
-			data += b;
-			break;
+			return payload;
+		});
+	}
 
-		// Average
-		case 3:
-			if (byte_index < bpp || (byte_index / bpp) % width == 0)
-				a = 0;
-			else
-				a = image_data[byte_index - bpp];
+	// Whatever ran since the last scanline (expansion, scattering, copies) is timed as expansion.
+	// Returns the scanline, filter byte first: in filtered_row, or in place in the builtin inflater's output or the pipeline's ring
+	const auto inflate_row{ [&](size_t row_bytes) -> const std::uint8_t*
+	{
+		clock.lap(stats.expand_ns);
 
-			if (byte_index < width_bytes)
-				b = 0;
-			else
-				b = image_data[byte_index - width_bytes];
+		const std::uint8_t* filtered{ filtered_row.data() };
 
+		if (whole_stream)
+		{
+			filtered = nullptr;
 
-			data += std::floor((a + b) / 2);
-			break;
+			if (inflate_result.written - inflated_position >= row_bytes + 1)
+			{
+				filtered = inflated.data() + inflated_position;
+				inflated_position += row_bytes + 1;
+			}
+			else if (inflate_result.status == fill::detail::FastInflater::Status::Corrupt)
+				throw std::runtime_error(std::string{ "ERROR::PNG_DEFLATE::Couldn't read data properly: " } + inflate_result.error);
+			else if (inflate_result.status == fill::detail::FastInflater::Status::Truncated && read_error)
+				std::rethrow_exception(read_error);
+		}
+		else if (pipeline)
+			filtered = pipeline->read(row_bytes + 1, filtered_row.data());
+		else if (inflater.read(filtered_row.data(), row_bytes + 1) != row_bytes + 1)
+			filtered = nullptr;
 
-		// Paeth
-		case 4:
-			if (byte_index < bpp || (byte_index / bpp) % width == 0)
-				a = 0;
-			else
-				a = image_data[byte_index - bpp];
+		if (!filtered)
+			throw std::runtime_error("ERROR::PNG_UNFILTER::Decompressed data is smaller than the image described by IHDR");
 
-			if (byte_index < width_bytes)
-				b = 0;
-			else
-				b = image_data[byte_index - width_bytes];
+		fill::detail::count(stats.bytes_inflated, row_bytes + 1);
+		clock.lap(pipeline ? stats.wait_ns : stats.inflate_ns);
 
-			if ((byte_index < width_bytes) || (byte_index < bpp || (byte_index / bpp) % width == 0))
-				c = 0;
-			else
-				c = image_data[(byte_index - width_bytes) - bpp];
+		return filtered;
+	} };
+
+	const auto next_row{ [&](size_t row_bytes, std::uint8_t* current)
+	{
+		const std::uint8_t* filtered{ inflate_row(row_bytes) };
 
+		fill::detail::unfilter_row(kernels, filtered[0], filtered + 1, prior, current, row_bytes, filter_bpp);
 
-			p = static_cast<short>(a) + static_cast<short>(b) - static_cast<short>(c);
-			pa = std::abs(p - static_cast<short>(a));
-			pb = std::abs(p - static_cast<short>(b));
-			pc = std::abs(p - static_cast<short>(c));
+		if constexpr (decode_stats_enabled)
+			stats.filter_rows[filtered[0]]++; /*valid once unfiltered*/
 
-			if (pa <= pb && pa <= pc)
-				data += a;
-			else if (pb <= pc)
-				data += b;
+		prior = current;
+		clock.lap(stats.unfilter_ns);
+	} };
+
+	if (interlace_method == 0)
+	{
+		const bool in_place{ expander.passthrough() && whole_rows };
+
+		// Expansion starts at the byte holding the region's first pixel, sub byte pixels before it in that byte are dropped after
+		const size_t pixel_bits{ static_cast<size_t>(format.channels) * format.bit_depth };
+		const size_t first_byte{ region.x * pixel_bits / 8 };
+		const std::uint32_t skipped{ static_cast<std::uint32_t>(region.x - first_byte * 8 / pixel_bits) };
+
+		if (!in_place || region.y > 0)
+			fill::detail::resize_counted(raw_rows, raw_bytes * 2, stats);
+		if (skipped > 0)
+			fill::detail::resize_counted(pass_row, static_cast<size_t>(region.width + skipped) * bpp, stats);
+
+		for (size_t row{}; row < region_end; row++)
+		{
+			// Rows above the region are only reconstructed as the prior of the next one
+			std::uint8_t* pixels{ row >= region.y ? row_start(row - region.y) : nullptr };
+			std::uint8_t* current{ in_place && pixels ? pixels : raw_rows.data() + (row % 2) * raw_bytes };
+
+			next_row(raw_bytes, current);
+
+			if (!pixels || in_place)
+				continue;
+
+			if (expander.passthrough())
+				std::memcpy(pixels, current + first_byte, width_bytes);
+			else if (skipped == 0)
+				expander.expand(current + first_byte, pixels, region.width);
 			else
-				data += c;
+			{
+				expander.expand(current + first_byte, pass_row.data(), region.width + skipped);
+				std::memcpy(pixels, pass_row.data() + static_cast<size_t>(skipped) * bpp, width_bytes);
+			}
+		}
+	}
+	else
+	{
+		// Adam7: seven reduced images one after the other, each unfiltered on its own, then scattered into place
+		const auto passes{ fill::detail::adam7_passes(image_width, image_height) };
+		const fill::detail::ScatterKernel scatter{ fill::detail::scatter_kernel(bpp) };
 
-			break;
+		const bool replicate{ options.on_pass && options.replicate_pixels && whole_rows && region.height == image_height };
+
+		fill::detail::resize_counted(raw_rows, raw_bytes * 2, stats);
+		if (!expander.passthrough())
+			fill::detail::resize_counted(pass_row, static_cast<size_t>(image_width) * bpp, stats);
+
+		if (options.on_pass && !replicate)
+			std::fill(image_data.begin(), image_data.end(), std::uint8_t{}); /*pixels of later passes show as blank*/
+
+		for (size_t p{}; p < passes.size(); p++)
+		{
+			const fill::detail::Adam7Pass& pass{ passes[p] };
+
+			const size_t pass_bytes{ format.row_bytes(pass.width) };
+			const size_t step{ static_cast<size_t>(pass.dx) * bpp };
+			const bool last_pass{ p + 1 == passes.size() };
+
+			// Pass pixels falling inside the region's columns, computed once per pass
+			const size_t region_right{ static_cast<size_t>(region.x) + region.width };
+			const size_t first{ region.x > pass.x ? (region.x - pass.x + pass.dx - 1) / pass.dx : 0 };
+			const size_t last{ std::min<size_t>(pass.width, region_right > pass.x ? (region_right - pass.x + pass.dx - 1) / pass.dx : 0) };
+			const size_t offset{ (pass.x + first * pass.dx - region.x) * bpp };
+
+			prior = nullptr;
+
+			// An empty pass has no scanlines, filter bytes included
+			for (std::uint32_t r{}; r < pass.height && pass.width > 0; r++)
+			{
+				const size_t y{ pass.y + static_cast<size_t>(r) * pass.dy };
 
+				if (y >= region_end)
+				{
+					// The rest of the image follows the last pass: stop there. Earlier passes still have to be inflated through
+					if (last_pass)
+						break;
+
+					inflate_row(pass_bytes);
+					continue;
+				}
+
+				std::uint8_t* current{ raw_rows.data() + (r % 2) * raw_bytes };
+
+				next_row(pass_bytes, current);
+
+				if (y < region.y || first >= last)
+					continue;
+
+				const std::uint8_t* pixels{ current };
+				if (!expander.passthrough())
+				{
+					expander.expand(current, pass_row.data(), static_cast<std::uint32_t>(last));
+					pixels = pass_row.data();
+				}
+
+				std::uint8_t* destination{ row_start(y - region.y) };
+
+				if (!replicate || last_pass)
+					scatter(pixels + first * bpp, destination + offset, last - first, step);
+				else
+				{
+					// Rows of a block only differ where earlier passes wrote, and those are the same down the whole block
+					fill::detail::replicate_row(pixels, destination, pass, width, bpp);
+
+					const size_t block_end{ std::min<size_t>(y + pass.block_height, height) };
+					for (size_t below{ y + 1 }; below < block_end; below++)
+						std::memcpy(row_start(below), destination, width_bytes);
+				}
+			}
+
+			if (options.on_pass && pass.width > 0 && pass.height > 0) /*small images have empty passes, nothing to show*/
+			{
+				clock.lap(stats.expand_ns);
+				options.on_pass(*this, static_cast<std::uint32_t>(p + 1));
+				clock.restart(); /*the caller's time isn't the decoder's*/
+			}
+		}
+	}
+
+	// A region ending above the last row leaves the rest of the stream, and the image's end, unread
+	clock.lap(stats.expand_ns);
+
+	if (pipeline)
+	{
+		pipeline->finish();
+		clock.lap(stats.wait_ns);
+		pipeline->collect(stats);
+	}
+	else if (whole_stream)
+	{
+		// Inflater::finish's checks, on a stream already read to its end
+		switch (region_end == image_height ? inflate_result.status : fill::detail::FastInflater::Status::Ended)
+		{
+		case fill::detail::FastInflater::Status::Full:
+			throw std::runtime_error("ERROR::PNG_DEFLATE::Decompressed data is larger than the image described by IHDR");
+		case fill::detail::FastInflater::Status::Truncated:
+			if (read_error)
+				std::rethrow_exception(read_error);
+
+			throw std::runtime_error("ERROR::PNG_DEFLATE::Compressed data ended before the end of the zlib stream");
+		case fill::detail::FastInflater::Status::Corrupt:
+			throw std::runtime_error(std::string{ "ERROR::PNG_DEFLATE::Couldn't read data properly: " } + inflate_result.error);
 		default:
 			break;
 		}
+	}
+	else if (region_end == image_height)
+	{
+		inflater.finish();
+		clock.lap(stats.inflate_ns);
+	}
+}
+
+// --- PNM loading
+
+void fill::Image::loadFromPNM(const std::filesystem::path& path_pnm, Decoder& decoder)
+{
+	fill::detail::StageClock clock{};
+	const fill::detail::MappedFile file{ path_pnm };
+	clock.lap(decoder.state->pending_map_ns);
+
+	loadFromPNM(file.bytes(), decoder); /*rows are copied straight from the mapping*/
+}
+
+void fill::Image::loadFromPNM(std::span<const std::uint8_t> pnm_bytes, Decoder& decoder, const Rect* region)
+{
+	DecodeStats& stats{ decoder.state->stats };
+	fill::detail::StageClock& clock{ decoder.state->clock };
+
+	if constexpr (decode_stats_enabled)
+	{
+		stats = DecodeStats{};
+		stats.map_ns = std::exchange(decoder.state->pending_map_ns, 0);
+		stats.file_bytes = pnm_bytes.size();
+		clock.restart();
+	}
+
+	const detail::PnmFormat pnm{ detail::parse_PNM(pnm_bytes) };
+	const Rect area{ clip_region(region, pnm.width, pnm.height) };
+
+	// Samples are laid out as in PNG images of the same channels, which the expander takes from there
+	constexpr std::uint8_t color_types[4]{ 0 /*Greyscale*/, 4 /*Greyscale with alpha*/, 2 /*TrueColor*/, 6 /*TrueColor with alpha*/ };
+
+	detail::PngFormat& format{ decoder.state->png };
+	format = detail::PngFormat{};
+	format.bit_depth = pnm.bit_depth;
+	format.color_type = color_types[pnm.channels - 1];
+	format.channels = pnm.channels;
+
+	detail::RowExpander& expander{ decoder.state->expander };
+	expander.configure(format, decoder.state->options.format, area.width);
+
+	color_channel = expander.channels();
+	bit_depth = expander.bit_depth();
+	bpp = static_cast<std::uint8_t>(color_channel * (bit_depth / 8));
+	compression_method = filter_method = interlace_method = 0;
+
+	clock.lap(stats.parse_ns);
+
+	// Only the region is kept, the image takes its size
+	width = area.width;
+	height = area.height;
+	layout = decoder.state->options.layout;
+
+	const std::uint8_t* previous_pixels{ image_data.data() };
+	allocate();
+
+	if (image_data.data() != previous_pixels && !image_data.empty())
+	{
+		fill::detail::count(stats.allocations);
+		fill::detail::count(stats.allocated_bytes, image_data.capacity());
+	}
+
+	const size_t sample_bytes{ static_cast<size_t>(pnm.bit_depth / 8) };
+	const size_t samples{ static_cast<size_t>(width) * pnm.channels };
+
+	std::pmr::vector<std::uint8_t>& scaled{ decoder.state->raw_rows };
+	if (!pnm.full_range())
+		fill::detail::resize_counted(scaled, samples * sample_bytes, stats);
+
+	for (std::uint32_t y{}; y < height; y++)
+	{
+		const std::uint8_t* source{ pnm.raster.data() + (area.y + y) * pnm.row_bytes() + static_cast<size_t>(area.x) * pnm.channels * sample_bytes };
+
+		if (!pnm.full_range())
+		{
+			scale_samples(source, scaled.data(), samples, pnm.maxval, pnm.bit_depth);
+			source = scaled.data();
+		}
+
+		if (expander.passthrough())
+			std::memcpy(row(y), source, static_cast<size_t>(width) * bpp);
+		else
+			expander.expand(source, row(y), width);
+	}
+
+	clock.lap(stats.expand_ns);
+
+	if constexpr (decode_stats_enabled)
+	{
+		stats.total_ns = stats.map_ns + stats.parse_ns + stats.expand_ns;
+		stats.images = 1;
+		decoder.state->total_stats += stats;
 
-		image_data.push_back(data);
+		if (decoder.state->options.on_stats)
+			decoder.state->options.on_stats(stats);
 	}
 }
 
@@ -0,0 +1,39 @@
+#include "image_view.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+
+fill::ImageView::ImageView(const std::uint8_t* pixels, std::uint32_t width, std::uint32_t height, size_t stride, std::uint8_t color_channel, std::uint8_t bit_depth)
+	: pixels{ pixels }
+	, width{ width }
+	, height{ height }
+	, stride{ stride }
+	, bit_depth{ bit_depth }
+	, color_channel{ color_channel }
+	, bpp{ static_cast<std::uint8_t>(color_channel * (bit_depth / 8)) }
+{
+	if (stride < static_cast<size_t>(width) * bpp)
+		throw std::runtime_error("ERROR::VIEW::Stride is smaller than a row of pixels");
+	if (!pixels && width != 0 && height != 0)
+		throw std::runtime_error("ERROR::VIEW::View of pixels that don't exist");
+}
+
+
+fill::ImageView fill::ImageView::crop(const Rect& area) const noexcept
+{
+	// Clipped in 64 bits, x + width can wrap
+	const std::uint32_t left{ std::min(area.x, width) };
+	const std::uint32_t top{ std::min(area.y, height) };
+	const std::uint32_t right{ static_cast<std::uint32_t>(std::min<std::uint64_t>(std::uint64_t{ area.x } + area.width, width)) };
+	const std::uint32_t bottom{ static_cast<std::uint32_t>(std::min<std::uint64_t>(std::uint64_t{ area.y } + area.height, height)) };
+
+	ImageView view{ *this };
+	view.width = right - left;
+	view.height = bottom - top;
+
+	if (!view.empty())
+		view.pixels = pixels + top * stride + static_cast<size_t>(left) * bpp;
+
+	return view;
+}
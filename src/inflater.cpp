@@ -0,0 +1,147 @@
+#include "inflater.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+
+// zlib allocation hooks for arenas: zfree doesn't give the size back, so it is stored in front of each block
+
+namespace
+{
+
+	constexpr size_t block_header{ alignof(std::max_align_t) };
+
+	voidpf arena_alloc(voidpf opaque, uInt items, uInt size)
+	{
+		auto* arena{ static_cast<std::pmr::memory_resource*>(opaque) };
+		const size_t bytes{ static_cast<size_t>(items) * size + block_header };
+
+		try
+		{
+			auto* block{ static_cast<std::uint8_t*>(arena->allocate(bytes, alignof(std::max_align_t))) };
+			*reinterpret_cast<size_t*>(block) = bytes;
+
+			return block + block_header;
+		}
+		catch (const std::bad_alloc&)
+		{
+			return Z_NULL; /*zlib reports Z_MEM_ERROR*/
+		}
+	}
+
+	void arena_free(voidpf opaque, voidpf address)
+	{
+		auto* arena{ static_cast<std::pmr::memory_resource*>(opaque) };
+		auto* block{ static_cast<std::uint8_t*>(address) - block_header };
+
+		arena->deallocate(block, *reinterpret_cast<size_t*>(block), alignof(std::max_align_t));
+	}
+
+} // namespace
+
+
+fill::detail::Inflater::Inflater(std::pmr::memory_resource* arena)
+{
+	/* allocate inflate state */
+	strm.zalloc = arena ? arena_alloc : Z_NULL;
+	strm.zfree = arena ? arena_free : Z_NULL;
+	strm.opaque = arena;
+	strm.avail_in = 0;
+	strm.next_in = Z_NULL;
+
+	const int ret{ inflateInit(&strm) };
+	if (ret != Z_OK)
+		throw std::runtime_error("ERROR::PNG_DEFLATE::Cannot initialize inflate process on data: " + std::to_string(ret));
+}
+
+fill::detail::Inflater::~Inflater()
+{
+	inflateEnd(&strm);
+}
+
+
+void fill::detail::Inflater::reset(Input input)
+{
+	const int ret{ inflateReset(&strm) };
+	if (ret != Z_OK)
+		throw std::runtime_error("ERROR::PNG_DEFLATE::Cannot reset inflate process: " + std::to_string(ret));
+
+	strm.avail_in = 0;
+	strm.next_in = Z_NULL;
+
+	next_input = std::move(input);
+	ended = false;
+}
+
+size_t fill::detail::Inflater::read(std::uint8_t* out, size_t size)
+{
+	size_t written{};
+
+	// avail_out is only 32 bits wide
+	while (written < size && !ended)
+	{
+		const auto piece{ static_cast<uInt>(std::min<size_t>(size - written, std::numeric_limits<uInt>::max())) };
+
+		const size_t have{ fill(out + written, piece) };
+		written += have;
+
+		if (have < piece)
+			break;
+	}
+
+	return written;
+}
+
+void fill::detail::Inflater::finish()
+{
+	std::uint8_t extra{};
+
+	if (read(&extra, 1) != 0)
+		throw std::runtime_error("ERROR::PNG_DEFLATE::Decompressed data is larger than the image described by IHDR");
+	if (!ended)
+		throw std::runtime_error("ERROR::PNG_DEFLATE::Compressed data ended before the end of the zlib stream");
+}
+
+size_t fill::detail::Inflater::fill(std::uint8_t* out, uInt size)
+{
+	strm.next_out = out;
+	strm.avail_out = size;
+
+	while (strm.avail_out > 0 && !ended)
+	{
+		if (strm.avail_in == 0)
+		{
+			const std::span<const std::uint8_t> in{ next_input() };
+			if (in.empty())
+				break;
+
+			strm.next_in = const_cast<std::uint8_t*>(in.data());
+			strm.avail_in = static_cast<uInt>(in.size());
+		}
+
+		const int ret{ inflate(&strm, Z_NO_FLUSH) };
+
+		switch (ret)
+		{
+		case Z_OK:
+		case Z_BUF_ERROR: /*needs more input*/
+			break;
+
+		case Z_STREAM_END:
+			ended = true;
+			break;
+
+		case Z_NEED_DICT:
+			throw std::runtime_error("ERROR::PNG_DEFLATE::Couldn't read data properly: " + std::to_string(Z_DATA_ERROR));
+
+		default:
+			throw std::runtime_error("ERROR::PNG_DEFLATE::Couldn't read data properly: " + std::to_string(ret));
+		}
+	}
+
+	return size - strm.avail_out;
+}
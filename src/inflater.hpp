@@ -0,0 +1,60 @@
+#pragma once // inflater.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// Internal header: streaming zlib inflater for PNG image data.
+//	- Compressed data is pulled one IDAT payload at a time, and handed to zlib in place.
+//	- Output is written straight into caller provided memory.
+//	- The zlib state (and its 32KB window) is kept between images: reset() only calls inflateReset.
+// ===================================================
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+#include <span>
+
+#include "zlib.h"
+
+namespace fill::detail
+{
+
+	class Inflater
+	{
+	public:
+		// Returns the next IDAT payload, or an empty span once there is none left
+		using Input = std::function<std::span<const std::uint8_t>()>;
+
+
+		// zlib's state is allocated from arena when there is one, from the global heap otherwise
+		explicit Inflater(std::pmr::memory_resource* arena = nullptr);
+
+		Inflater(const Inflater&) = delete;
+		Inflater& operator=(const Inflater&) = delete;
+
+		~Inflater();
+
+
+		// Starts a new zlib stream
+		void reset(Input input);
+
+		// Fills [out, out + size) and returns how many bytes were written: less than size only if the stream (or the input) ended
+		size_t read(std::uint8_t* out, size_t size);
+
+		// Checks the stream ends exactly where the caller stopped reading: no bytes left over, and the zlib trailer present
+		void finish();
+
+		// Bytes written since reset, including by a read that threw (modulo 2^32 where uLong is 32 bits)
+		uLong total_out() const noexcept { return strm.total_out; }
+
+	private:
+		size_t fill(std::uint8_t* out, uInt size);
+
+
+		z_stream strm{};
+		Input next_input;
+
+		bool ended{};
+	};
+
+} // fill::detail
@@ -0,0 +1,79 @@
+#include "interlace.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+
+namespace
+{
+
+	// x, y, dx, dy, block width, block height (see PNG spec, section 8.2)
+	constexpr std::uint32_t adam7[fill::detail::adam7_pass_count][6]{
+		{ 0, 0, 8, 8, 8, 8 },
+		{ 4, 0, 8, 8, 4, 8 },
+		{ 0, 4, 4, 8, 4, 4 },
+		{ 2, 0, 4, 4, 2, 4 },
+		{ 0, 2, 2, 4, 2, 2 },
+		{ 1, 0, 2, 2, 1, 2 },
+		{ 0, 1, 1, 2, 1, 1 }
+	};
+
+
+	// Scatter kernels: a fixed size copy compiles down to a single load and store
+
+	template <size_t BPP>
+	void scatter(const std::uint8_t* source, std::uint8_t* destination, size_t count, size_t step)
+	{
+		for (size_t i{}; i < count; i++, source += BPP, destination += step)
+			std::memcpy(destination, source, BPP);
+	}
+
+} // namespace
+
+
+fill::detail::ScatterKernel fill::detail::scatter_kernel(size_t bpp) noexcept
+{
+	switch (bpp)
+	{
+	case 1: return scatter<1>;
+	case 2: return scatter<2>;
+	case 3: return scatter<3>;
+	case 4: return scatter<4>;
+	case 6: return scatter<6>;
+	case 8: return scatter<8>;
+	default: return nullptr;
+	}
+}
+
+std::array<fill::detail::Adam7Pass, fill::detail::adam7_pass_count> fill::detail::adam7_passes(std::uint32_t width, std::uint32_t height) noexcept
+{
+	std::array<Adam7Pass, adam7_pass_count> passes{};
+
+	for (size_t p{}; p < adam7_pass_count; p++)
+	{
+		const auto& [x, y, dx, dy, block_width, block_height] { adam7[p] };
+
+		Adam7Pass& pass{ passes[p] };
+		pass = Adam7Pass{ x, y, dx, dy, block_width, block_height };
+
+		// Pixels at x, x + dx, ... below width -- computed in 64 bits, width + dx could wrap
+		pass.width = width > x ? static_cast<std::uint32_t>((std::uint64_t{ width } - x + dx - 1) / dx) : 0;
+		pass.height = height > y ? static_cast<std::uint32_t>((std::uint64_t{ height } - y + dy - 1) / dy) : 0;
+	}
+
+	return passes;
+}
+
+void fill::detail::replicate_row(const std::uint8_t* source, std::uint8_t* destination, const Adam7Pass& pass, std::uint32_t image_width, size_t bpp) noexcept
+{
+	std::uint8_t* pixel{ destination + static_cast<size_t>(pass.x) * bpp };
+	const size_t step{ static_cast<size_t>(pass.dx) * bpp };
+
+	for (std::uint32_t i{}, x{ pass.x }; i < pass.width; i++, x += pass.dx, source += bpp, pixel += step)
+	{
+		const std::uint32_t repeat{ std::min(pass.block_width, image_width - x) };
+
+		for (std::uint32_t r{}; r < repeat; r++)
+			std::memcpy(pixel + r * bpp, source, bpp);
+	}
+}
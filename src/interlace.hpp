@@ -0,0 +1,47 @@
+#pragma once // interlace.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// Internal header: Adam7 deinterlacing.
+//	- Each pass is a reduced image of its own, its geometry (origin, step, size) is computed once per image.
+//	- Pass rows are scattered into the final image with pointer strides from that table, specialized per pixel size.
+//	- For progressive display, a pass pixel can also fill the block of pixels later passes will replace.
+//
+// See: https://www.w3.org/TR/2003/REC-PNG-20031110/#8Interlace
+// ===================================================
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace fill::detail
+{
+
+	struct Adam7Pass
+	{
+		std::uint32_t x{}, y{};                      /*first pixel of the pass in the image*/
+		std::uint32_t dx{}, dy{};                    /*distance between two of its pixels*/
+		std::uint32_t block_width{}, block_height{}; /*pixels it stands for until later passes are decoded*/
+
+		std::uint32_t width{}, height{};             /*size of the reduced image, 0 when the pass is empty*/
+
+		bool empty() const noexcept { return width == 0 || height == 0; }
+	};
+
+	inline constexpr size_t adam7_pass_count{ 7 };
+
+	// Geometry of the seven passes of a width x height image
+	std::array<Adam7Pass, adam7_pass_count> adam7_passes(std::uint32_t width, std::uint32_t height) noexcept;
+
+
+	// Copies count pixels from a packed pass row to destination, step bytes apart
+	using ScatterKernel = void (*)(const std::uint8_t* source, std::uint8_t* destination, size_t count, size_t step);
+
+	// Kernel for bpp bytes per pixel (1 to 8)
+	ScatterKernel scatter_kernel(size_t bpp) noexcept;
+
+	// Writes a pass row to its image row, each pixel repeated over the width of its block (clipped to image_width).
+	// Rows below, up to the block height, are left to the caller.
+	void replicate_row(const std::uint8_t* source, std::uint8_t* destination, const Adam7Pass& pass, std::uint32_t image_width, size_t bpp) noexcept;
+
+} // fill::detail
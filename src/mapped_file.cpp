@@ -0,0 +1,177 @@
+#include "mapped_file.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+#if defined(_WIN32)
+
+fill::detail::MappedFile::MappedFile(const std::filesystem::path& path)
+{
+	HANDLE file{ CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr) };
+	if (file == INVALID_HANDLE_VALUE)
+		throw std::runtime_error("ERROR::FILE::Couldn't open file: " + path.string());
+
+	LARGE_INTEGER file_size{};
+	if (!GetFileSizeEx(file, &file_size))
+	{
+		CloseHandle(file);
+		throw std::runtime_error("ERROR::FILE::Couldn't query the size of file: " + path.string());
+	}
+
+	size = static_cast<size_t>(file_size.QuadPart);
+
+	// Empty files cannot be mapped, they are simply an empty span
+	if (size > 0)
+	{
+		mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+		if (mapping)
+			data = static_cast<const std::uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	}
+
+	CloseHandle(file); /*the mapping keeps its own reference*/
+
+	if (size > 0 && !data)
+	{
+		unmap();
+		throw std::runtime_error("ERROR::FILE::Couldn't map file: " + path.string());
+	}
+}
+
+void fill::detail::MappedFile::unmap() noexcept
+{
+	if (data)
+		UnmapViewOfFile(data);
+	if (mapping)
+		CloseHandle(mapping);
+
+	data = nullptr;
+	mapping = nullptr;
+	size = 0;
+}
+
+
+size_t fill::detail::read_file_head(const std::filesystem::path& path, std::span<std::uint8_t> buffer)
+{
+	HANDLE file{ CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+	if (file == INVALID_HANDLE_VALUE)
+		throw std::runtime_error("ERROR::FILE::Couldn't open file: " + path.string());
+
+	DWORD read{};
+	const BOOL success{ ReadFile(file, buffer.data(), static_cast<DWORD>(buffer.size()), &read, nullptr) };
+
+	CloseHandle(file);
+
+	if (!success)
+		throw std::runtime_error("ERROR::FILE::Couldn't read file: " + path.string());
+
+	return read;
+}
+
+#else
+
+fill::detail::MappedFile::MappedFile(const std::filesystem::path& path)
+{
+	const int file{ open(path.c_str(), O_RDONLY) };
+	if (file < 0)
+		throw std::runtime_error("ERROR::FILE::Couldn't open file: " + path.string());
+
+	struct stat status{};
+	if (fstat(file, &status) != 0)
+	{
+		close(file);
+		throw std::runtime_error("ERROR::FILE::Couldn't query the size of file: " + path.string());
+	}
+
+	size = static_cast<size_t>(status.st_size);
+
+	// Empty files cannot be mapped, they are simply an empty span
+	if (size > 0)
+	{
+		void* address{ mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0) };
+
+		if (address == MAP_FAILED)
+		{
+			close(file);
+			throw std::runtime_error("ERROR::FILE::Couldn't map file: " + path.string());
+		}
+
+		madvise(address, size, MADV_SEQUENTIAL);
+		data = static_cast<const std::uint8_t*>(address);
+	}
+
+	close(file); /*the mapping keeps its own reference*/
+}
+
+void fill::detail::MappedFile::unmap() noexcept
+{
+	if (data)
+		munmap(const_cast<std::uint8_t*>(data), size);
+
+	data = nullptr;
+	size = 0;
+}
+
+
+size_t fill::detail::read_file_head(const std::filesystem::path& path, std::span<std::uint8_t> buffer)
+{
+	const int file{ open(path.c_str(), O_RDONLY) };
+	if (file < 0)
+		throw std::runtime_error("ERROR::FILE::Couldn't open file: " + path.string());
+
+	const ssize_t read{ pread(file, buffer.data(), buffer.size(), 0) }; /*a short read only means a short file*/
+
+	close(file);
+
+	if (read < 0)
+		throw std::runtime_error("ERROR::FILE::Couldn't read file: " + path.string());
+
+	return static_cast<size_t>(read);
+}
+
+#endif
+
+
+fill::detail::MappedFile::MappedFile(MappedFile&& other) noexcept
+	: data{ std::exchange(other.data, nullptr) }
+	, size{ std::exchange(other.size, 0) }
+#if defined(_WIN32)
+	, mapping{ std::exchange(other.mapping, nullptr) }
+#endif
+{
+}
+
+fill::detail::MappedFile& fill::detail::MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		unmap();
+
+		data = std::exchange(other.data, nullptr);
+		size = std::exchange(other.size, 0);
+#if defined(_WIN32)
+		mapping = std::exchange(other.mapping, nullptr);
+#endif
+	}
+
+	return *this;
+}
+
+fill::detail::MappedFile::~MappedFile()
+{
+	unmap();
+}
@@ -0,0 +1,51 @@
+#pragma once // mapped_file.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// Internal header: read-only memory mapping of a whole file.
+// The mapping lives as long as the object, spans handed out by bytes() must not outlive it.
+// Also reads only the start of a file, when mapping all of it would be wasted (e.g. headers).
+// ===================================================
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+namespace fill::detail
+{
+
+	class MappedFile
+	{
+	public:
+
+		explicit MappedFile(const std::filesystem::path& path);
+
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		~MappedFile();
+
+
+		std::span<const std::uint8_t> bytes() const noexcept { return { data, size }; }
+
+	private:
+		void unmap() noexcept;
+
+
+		const std::uint8_t* data{};
+		size_t size{};
+
+#if defined(_WIN32)
+		void* mapping{}; /*HANDLE of the file mapping object*/
+#endif
+	};
+
+
+	// Reads up to buffer.size() bytes from the start of the file in a single read, returns how many were read
+	size_t read_file_head(const std::filesystem::path& path, std::span<std::uint8_t> buffer);
+
+} // fill::detail
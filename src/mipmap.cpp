@@ -0,0 +1,309 @@
+#include "mipmap.hpp"
+#include "image.hpp"
+#include "parallel.hpp"
+#include "reduce.hpp"
+#include "resample.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+
+// sRGB transfer functions (see IEC 61966-2-1)
+
+namespace
+{
+
+	constexpr size_t encode_steps{ 4096 };
+
+	struct SrgbTables
+	{
+		std::array<float, 256> decode{}; /*sRGB byte to linear [0, 1]*/
+		std::array<std::uint8_t, encode_steps + 1> encode{}; /*linear, quantized to encode_steps, to the nearest sRGB byte*/
+
+		SrgbTables()
+		{
+			for (size_t i{}; i < decode.size(); i++)
+			{
+				const double value{ i / 255.0 };
+				decode[i] = static_cast<float>(value <= 0.04045 ? value / 12.92 : std::pow((value + 0.055) / 1.055, 2.4));
+			}
+
+			for (size_t i{}; i < encode.size(); i++)
+			{
+				const double value{ static_cast<double>(i) / encode_steps };
+				const double srgb{ value <= 0.0031308 ? value * 12.92 : 1.055 * std::pow(value, 1.0 / 2.4) - 0.055 };
+				encode[i] = static_cast<std::uint8_t>(std::lround(std::clamp(srgb, 0.0, 1.0) * 255.0));
+			}
+		}
+
+		std::uint8_t to_srgb(float linear) const noexcept
+		{
+			return encode[static_cast<size_t>(std::clamp(linear, 0.0f, 1.0f) * encode_steps + 0.5f)];
+		}
+	};
+
+	const SrgbTables& srgb_tables()
+	{
+		static const SrgbTables tables{};
+		return tables;
+	}
+
+	// Grey + alpha and RGBA keep their last channel linear
+	bool is_alpha(size_t channel, size_t bpp) noexcept
+	{
+		return (bpp == 2 || bpp == 4) && channel == bpp - 1;
+	}
+
+} // namespace
+
+
+// Box filtered chain
+
+namespace
+{
+
+	struct LevelView
+	{
+		std::uint8_t* pixels{};
+		std::uint32_t width{}, height{};
+		size_t pitch{};
+	};
+
+	struct Region
+	{
+		std::uint32_t x0{}, y0{}, x1{}, y1{};
+	};
+
+	// Reduces the region of destination (one level below source) from the matching 2x2 blocks of source.
+	// A source level 1 pixel wide or high (the other side being longer) reuses its only column or row
+	void reduce_region(const LevelView& source, const LevelView& destination, const Region& region, size_t bpp, fill::detail::ReduceKernel kernel, bool srgb)
+	{
+		const size_t source_pitch{ source.pitch };
+		const size_t pitch{ destination.pitch };
+
+		const SrgbTables* tables{ srgb ? &srgb_tables() : nullptr };
+
+		for (std::uint32_t y{ region.y0 }; y < region.y1; y++)
+		{
+			const std::uint8_t* top{ source.pixels + std::min(2 * y, source.height - 1) * source_pitch };
+			const std::uint8_t* bottom{ source.pixels + std::min(2 * y + 1, source.height - 1) * source_pitch };
+			std::uint8_t* row{ destination.pixels + y * pitch };
+
+			if (!tables && source.width >= 2)
+			{
+				kernel(top + 2 * region.x0 * bpp, bottom + 2 * region.x0 * bpp, row + region.x0 * bpp, region.x1 - region.x0, bpp);
+				continue;
+			}
+
+			for (std::uint32_t x{ region.x0 }; x < region.x1; x++)
+			{
+				const size_t left{ std::min(2 * x, source.width - 1) * bpp };
+				const size_t right{ std::min(2 * x + 1, source.width - 1) * bpp };
+
+				for (size_t c{}; c < bpp; c++)
+				{
+					if (!tables || is_alpha(c, bpp))
+						row[x * bpp + c] = static_cast<std::uint8_t>((top[left + c] + top[right + c] + bottom[left + c] + bottom[right + c] + 2) >> 2);
+					else
+					{
+						const auto& decode{ tables->decode };
+						row[x * bpp + c] = tables->to_srgb((decode[top[left + c]] + decode[top[right + c]] + decode[bottom[left + c]] + decode[bottom[right + c]]) * 0.25f);
+					}
+				}
+			}
+		}
+	}
+
+	// Tiles of 64 x 64 pixels (16KB of RGBA) go down 6 levels on their own, to a single pixel each
+	constexpr std::uint32_t tile_size{ 64 };
+	constexpr size_t tile_levels{ 6 };
+
+	void box_chain(const fill::Image& image, fill::Mipmaps& mipmaps, const fill::MipmapOptions& options)
+	{
+		const size_t bpp{ mipmaps.bpp };
+		const fill::detail::ReduceKernel kernel{ fill::detail::reduce_kernel(bpp) };
+
+		std::vector<LevelView> views(mipmaps.levels.size());
+		for (size_t i{}; i < views.size(); i++)
+			views[i] = LevelView{ mipmaps.data.data() + mipmaps.levels[i].offset, mipmaps.levels[i].width, mipmaps.levels[i].height, mipmaps.levels[i].width * bpp };
+
+		views[0].pixels = const_cast<std::uint8_t*>(image.data()); /*read level 0 from the image itself, its copy is only written*/
+		views[0].pitch = image.getPitch();
+
+		const size_t blocked_levels{ std::min(tile_levels, views.size() - 1) };
+		const std::uint32_t tiles_x{ (views[0].width + tile_size - 1) / tile_size };
+		const std::uint32_t tiles_y{ (views[0].height + tile_size - 1) / tile_size };
+
+		// Each tile only reads pixels of its own footprint, one level above: tiles are independent
+		fill::detail::for_each_band(options.pool, tiles_y, 1, [&](size_t begin, size_t end)
+		{
+			for (size_t ty{ begin }; ty < end; ty++)
+			{
+				for (std::uint32_t tx{}; tx < tiles_x; tx++)
+				{
+					for (size_t level{ 1 }; level <= blocked_levels; level++)
+					{
+						const LevelView& destination{ views[level] };
+
+						const Region region{
+							(tx * tile_size) >> level,
+							static_cast<std::uint32_t>((ty * tile_size) >> level),
+							std::min(((tx + 1) * tile_size) >> level, destination.width),
+							std::min(static_cast<std::uint32_t>(((ty + 1) * tile_size) >> level), destination.height) };
+
+						if (region.x0 >= region.x1 || region.y0 >= region.y1)
+							break;
+
+						reduce_region(views[level - 1], destination, region, bpp, kernel, options.srgb);
+					}
+				}
+			}
+		});
+
+		// What is left is at most 1/4096th of the image
+		for (size_t level{ blocked_levels + 1 }; level < views.size(); level++)
+			reduce_region(views[level - 1], views[level], Region{ 0, 0, views[level].width, views[level].height }, bpp, kernel, options.srgb);
+	}
+
+} // namespace
+
+
+// Kaiser filtered chain
+
+namespace
+{
+
+	// Separable resampling in linear light, in floats, with the same weight tables as the 8 bit kernels
+	void resample_linear(const std::uint8_t* source, std::uint32_t width, std::uint32_t height, std::uint8_t* destination, std::uint32_t new_width, std::uint32_t new_height, size_t bpp, fill::ThreadPool* pool)
+	{
+		const SrgbTables& tables{ srgb_tables() };
+		constexpr float scale{ 1.0f / (1 << fill::detail::resample_bits) };
+
+		const fill::detail::ResampleWeights columns{ fill::detail::resample_weights(width, new_width, fill::ResizeFilter::Kaiser) };
+		const fill::detail::ResampleWeights rows{ fill::detail::resample_weights(height, new_height, fill::ResizeFilter::Kaiser) };
+
+		// Horizontal pass into linear floats
+		std::vector<float> intermediate(static_cast<size_t>(new_width) * height * bpp);
+
+		fill::detail::for_each_band(pool, height, 16, [&](size_t begin, size_t end)
+		{
+			for (size_t y{ begin }; y < end; y++)
+			{
+				const std::uint8_t* row{ source + y * width * bpp };
+				float* out{ intermediate.data() + y * new_width * bpp };
+
+				for (size_t x{}; x < new_width; x++)
+				{
+					const std::int16_t* w{ columns.weights.data() + x * columns.stride };
+
+					for (size_t c{}; c < bpp; c++)
+					{
+						float sum{};
+
+						for (size_t k{}; k < columns.taps[x]; k++)
+						{
+							const std::uint8_t value{ row[(columns.first[x] + k) * bpp + c] };
+							sum += w[k] * scale * (is_alpha(c, bpp) ? value / 255.0f : tables.decode[value]);
+						}
+
+						out[x * bpp + c] = sum;
+					}
+				}
+			}
+		});
+
+		// Vertical pass, back to 8 bits
+		fill::detail::for_each_band(pool, new_height, 16, [&](size_t begin, size_t end)
+		{
+			for (size_t y{ begin }; y < end; y++)
+			{
+				const std::int16_t* w{ rows.weights.data() + y * rows.stride };
+				std::uint8_t* out{ destination + y * new_width * bpp };
+
+				for (size_t i{}; i < new_width * bpp; i++)
+				{
+					float sum{};
+
+					for (size_t k{}; k < rows.taps[y]; k++)
+						sum += w[k] * scale * intermediate[(rows.first[y] + k) * new_width * bpp + i];
+
+					out[i] = is_alpha(i % bpp, bpp)
+						? static_cast<std::uint8_t>(std::lround(std::clamp(sum, 0.0f, 1.0f) * 255.0f))
+						: tables.to_srgb(sum);
+				}
+			}
+		});
+	}
+
+	void kaiser_chain(fill::Mipmaps& mipmaps, const fill::MipmapOptions& options)
+	{
+		for (size_t level{ 1 }; level < mipmaps.levels.size(); level++)
+		{
+			const fill::MipLevel& source{ mipmaps.levels[level - 1] };
+			const fill::MipLevel& destination{ mipmaps.levels[level] };
+
+			const std::uint8_t* from{ mipmaps.data.data() + source.offset };
+			std::uint8_t* to{ mipmaps.data.data() + destination.offset };
+
+			if (options.srgb)
+				resample_linear(from, source.width, source.height, to, destination.width, destination.height, mipmaps.bpp, options.pool);
+			else
+				fill::detail::resample(from, static_cast<size_t>(source.width) * mipmaps.bpp, source.width, source.height, to, static_cast<size_t>(destination.width) * mipmaps.bpp, destination.width, destination.height, mipmaps.bpp, fill::ResizeFilter::Kaiser, options.pool);
+		}
+	}
+
+} // namespace
+
+
+// --- Mipmaps
+
+fill::Mipmaps fill::Image::generateMipmaps() const
+{
+	return generateMipmaps(MipmapOptions{});
+}
+
+fill::Mipmaps fill::Image::generateMipmaps(const MipmapOptions& options) const
+{
+	if (bit_depth != 8 || bpp == 0 || bpp > 4)
+		throw std::runtime_error("ERROR::MIPMAP::Only 8 bit images can be reduced");
+	if (size() < size_bytes())
+		throw std::runtime_error("ERROR::MIPMAP::Image holds fewer pixels than its dimensions describe");
+
+	Mipmaps mipmaps{};
+	mipmaps.color_channel = color_channel;
+	mipmaps.bpp = bpp;
+
+	if (width == 0 || height == 0)
+		return mipmaps;
+
+	// Level table first, so that the whole chain is a single allocation
+	size_t total{};
+
+	for (std::uint32_t w{ width }, h{ height };; w = std::max(w / 2, 1u), h = std::max(h / 2, 1u))
+	{
+		const size_t level_size{ static_cast<size_t>(w) * h * bpp };
+
+		mipmaps.levels.push_back(MipLevel{ w, h, total, level_size });
+		total += level_size;
+
+		if (w == 1 && h == 1)
+			break;
+	}
+
+	mipmaps.data.resize(total);
+
+	const size_t width_bytes{ static_cast<size_t>(width) * bpp }; /*levels are packed, the image may not be*/
+	for (std::uint32_t y{}; y < height; y++)
+		std::memcpy(mipmaps.data.data() + y * width_bytes, row(y), width_bytes);
+
+	if (options.filter == MipmapOptions::Filter::Kaiser)
+		kaiser_chain(mipmaps, options);
+	else
+		box_chain(*this, mipmaps, options);
+
+	return mipmaps;
+}
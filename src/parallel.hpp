@@ -0,0 +1,101 @@
+#pragma once // parallel.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// Internal header: splitting loops over a fill::ThreadPool.
+//	- The calling thread takes part: tasks are claimed from a shared counter, by the pool and by the caller alike.
+//	  It only ever waits on tasks already running, so workers can call these too without deadlocking the pool.
+//	- The first exception a task throws is rethrown to the caller, once every task has finished.
+// ===================================================
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+
+#include "thread_pool.hpp"
+
+namespace fill::detail
+{
+
+	// Tasks of one for_each_task call. Shared with the pool's tasks, which may start after the call returned (and find nothing left)
+	struct TaskGroup
+	{
+		std::atomic<size_t> next{}; /*first task not claimed yet*/
+
+		std::mutex mutex{};
+		std::condition_variable finished{};
+		size_t done{};
+		std::exception_ptr failure{};
+	};
+
+	// Claims and runs tasks of group until none are left
+	template <typename Function>
+	void run_claimed(TaskGroup& group, size_t count, const Function& function)
+	{
+		for (size_t task{ group.next++ }; task < count; task = group.next++)
+		{
+			std::exception_ptr failure{};
+
+			try
+			{
+				function(task);
+			}
+			catch (...)
+			{
+				failure = std::current_exception();
+			}
+
+			std::lock_guard lock{ group.mutex };
+
+			if (failure && !group.failure)
+				group.failure = failure;
+
+			if (++group.done == count)
+				group.finished.notify_all();
+		}
+	}
+
+	// Calls function(task) once for every task in [0, count), on the pool and on the calling thread.
+	// Every task has finished when this returns
+	template <typename Function>
+	void for_each_task(ThreadPool& pool, size_t count, const Function& function)
+	{
+		if (count == 0)
+			return;
+
+		const auto group{ std::make_shared<TaskGroup>() };
+		const size_t helpers{ std::min<size_t>(count - 1, pool.size()) };
+
+		for (size_t i{}; i < helpers; i++)
+			pool.submit([group, count, &function]() { run_claimed(*group, count, function); }); /*function is only used while tasks are left*/
+
+		run_claimed(*group, count, function);
+
+		std::unique_lock lock{ group->mutex };
+		group->finished.wait(lock, [&]() { return group->done == count; });
+
+		if (group->failure)
+			std::rethrow_exception(group->failure);
+	}
+
+	// Splits [0, count) in bands of at least min_band, run on the pool when there is one and more than a band.
+	// function(begin, end) is called once per band, and every band has finished when this returns
+	template <typename Function>
+	void for_each_band(ThreadPool* pool, size_t count, size_t min_band, const Function& function)
+	{
+		const size_t bands{ pool ? std::clamp<size_t>(count / std::max<size_t>(min_band, 1), 1, pool->size() * 4) : 1 };
+
+		if (bands == 1)
+			return function(size_t{}, count);
+
+		for_each_task(*pool, bands, [&](size_t band)
+		{
+			function(count * band / bands, count * (band + 1) / bands);
+		});
+	}
+
+} // fill::detail
@@ -0,0 +1,253 @@
+#include "pipeline.hpp"
+#include "stats.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+
+namespace
+{
+
+	constexpr size_t page_bytes{ 4096 }; /*smallest page size of every supported platform*/
+
+}
+
+
+fill::detail::DecodePipeline::DecodePipeline(Inflater& inflater, Inflater::Input input, std::span<std::uint8_t> ring, size_t block_bytes)
+	: payloads{ 64 }
+	, full{ ring.size() / block_bytes }
+	, empty{ ring.size() / block_bytes }
+{
+	if (block_bytes == 0 || ring.size() < block_bytes)
+		throw std::runtime_error("ERROR::PIPELINE::Ring holds no block");
+
+	for (size_t offset{}; offset + block_bytes <= ring.size(); offset += block_bytes)
+		empty.push(ring.data() + offset);
+
+	reader = std::thread{ [this, input = std::move(input)]() mutable { read_chunks(std::move(input)); } };
+
+	try
+	{
+		inflating = std::thread{ [this, &inflater, block_bytes]() { inflate_blocks(inflater, block_bytes); } };
+	}
+	catch (...)
+	{
+		stop();
+		throw;
+	}
+}
+
+fill::detail::DecodePipeline::~DecodePipeline()
+{
+	stop();
+}
+
+
+const std::uint8_t* fill::detail::DecodePipeline::read(size_t size, std::uint8_t* scratch)
+{
+	// Whole in the current block, no copy
+	if (current.size - position >= size)
+	{
+		const std::uint8_t* bytes{ current.data + position };
+		position += size;
+
+		return bytes;
+	}
+
+	// Straddling blocks: gathered in scratch, each block handed back as soon as it is used up
+	for (size_t copied{}; copied < size;)
+	{
+		if (position == current.size)
+		{
+			if (current.data)
+				empty.push(current.data);
+
+			current = {};
+			position = 0;
+
+			if (!full.pop(current))
+			{
+				join(); /*the inflater is done, and stopped the reader*/
+				rethrow(false);
+
+				return nullptr;
+			}
+
+			continue;
+		}
+
+		const size_t piece{ std::min(size - copied, current.size - position) };
+		std::memcpy(scratch + copied, current.data + position, piece);
+
+		copied += piece;
+		position += piece;
+	}
+
+	return scratch;
+}
+
+void fill::detail::DecodePipeline::finish()
+{
+	bool leftover{ position < current.size };
+
+	// The inflater pushes a last, shorter block, maybe empty, before closing
+	for (Block block{}; !leftover && full.pop(block);)
+	{
+		leftover = block.size != 0;
+		empty.push(block.data);
+	}
+
+	if (leftover)
+		stop();
+	else
+		join();
+
+	if (leftover)
+		throw std::runtime_error("ERROR::PNG_DEFLATE::Decompressed data is larger than the image described by IHDR");
+
+	rethrow(true);
+}
+
+void fill::detail::DecodePipeline::collect(DecodeStats& stats) const noexcept
+{
+	count(stats.read_ns, read_ns);
+	count(stats.inflate_ns, inflate_ns);
+	count(stats.pipelined);
+}
+
+
+void fill::detail::DecodePipeline::read_chunks(Inflater::Input input)
+{
+	try
+	{
+		StageClock clock{};
+
+		for (;;)
+		{
+			const std::span<const std::uint8_t> payload{ input() };
+
+			// One byte per page is enough to have the system read it
+			for (size_t offset{}; offset < payload.size(); offset += page_bytes)
+				touched ^= payload[offset];
+
+			clock.lap(read_ns);
+
+			if (payload.empty() || !payloads.push(payload))
+				break;
+
+			clock.restart(); /*waiting for the inflater to catch up*/
+		}
+	}
+	catch (...)
+	{
+		reader_error = std::current_exception();
+	}
+
+	payloads.close();
+}
+
+void fill::detail::DecodePipeline::inflate_blocks(Inflater& inflater, size_t block_bytes)
+{
+	try
+	{
+		StageClock clock{};
+		std::uint64_t waiting_ns{};
+
+		inflater.reset([this, &clock, &waiting_ns]() -> std::span<const std::uint8_t>
+		{
+			std::span<const std::uint8_t> payload{};
+			clock.lap(inflate_ns);
+
+			if (!payloads.pop(payload))
+			{
+				payload = {};
+				starved = true;
+			}
+
+			clock.lap(waiting_ns);
+			return payload;
+		});
+
+		for (;;)
+		{
+			std::uint8_t* block{};
+
+			clock.restart();
+			if (!empty.pop(block))
+				break;
+			clock.lap(waiting_ns);
+
+			const uLong before{ inflater.total_out() };
+			size_t size{};
+
+			try
+			{
+				size = inflater.read(block, block_bytes);
+			}
+			catch (...)
+			{
+				// What was inflated before the error still goes to the caller, who may find an earlier one in it
+				full.push({ block, static_cast<size_t>(inflater.total_out() - before) });
+				throw;
+			}
+
+			clock.lap(inflate_ns);
+
+			if (!full.push({ block, size }))
+				break;
+
+			// A short block ends the stream: it must end there, and properly
+			if (size < block_bytes)
+			{
+				try
+				{
+					clock.restart();
+					inflater.finish();
+					clock.lap(inflate_ns);
+				}
+				catch (...)
+				{
+					end_error = std::current_exception();
+				}
+
+				break;
+			}
+		}
+	}
+	catch (...)
+	{
+		inflater_error = std::current_exception();
+	}
+
+	payloads.cancel();
+	full.close();
+}
+
+
+void fill::detail::DecodePipeline::stop() noexcept
+{
+	full.cancel();
+	empty.close();
+
+	join();
+}
+
+void fill::detail::DecodePipeline::join() noexcept
+{
+	if (inflating.joinable())
+		inflating.join();
+	if (reader.joinable())
+		reader.join();
+}
+
+void fill::detail::DecodePipeline::rethrow(bool at_end) const
+{
+	if (inflater_error)
+		std::rethrow_exception(inflater_error);
+	if (reader_error && starved)
+		std::rethrow_exception(reader_error);
+	if (end_error && at_end)
+		std::rethrow_exception(end_error);
+}
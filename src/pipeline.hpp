@@ -0,0 +1,89 @@
+#pragma once // pipeline.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// Internal header: pipelined PNG decoding, for large images (see DecodeOptions::pipelined).
+//	- A reader thread walks the IDAT chunks and touches their pages, so the file is paged in ahead of zlib.
+//	- An inflater thread inflates the stream into a ring of blocks.
+//	- The calling thread unfilters and expands rows straight out of the blocks, while the next ones are being inflated.
+// Threads are connected by SpscQueues: payloads from reader to inflater, full blocks to the caller, and empty blocks back.
+// Errors on either thread are rethrown on the calling thread, the one found earliest in the stream first (as without a pipeline).
+// ===================================================
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <span>
+#include <thread>
+
+#include "decode_stats.hpp"
+#include "inflater.hpp"
+#include "spsc_queue.hpp"
+
+namespace fill::detail
+{
+
+	class DecodePipeline
+	{
+	public:
+		// input is called on the reader thread, inflater only used on the inflater thread until finish.
+		// ring is split in blocks of block_bytes, and must outlive the pipeline
+		DecodePipeline(Inflater& inflater, Inflater::Input input, std::span<std::uint8_t> ring, size_t block_bytes);
+
+		DecodePipeline(const DecodePipeline&) = delete;
+		DecodePipeline& operator=(const DecodePipeline&) = delete;
+
+		// Stops both threads if they are still running, and joins them
+		~DecodePipeline();
+
+
+		// Next size bytes of the inflated stream, valid until the next call: in place in a block, or copied to scratch when they straddle two.
+		// Returns nullptr if the stream ends first
+		const std::uint8_t* read(size_t size, std::uint8_t* scratch);
+
+		// Checks the stream ends exactly where the caller stopped reading, as Inflater::finish does
+		void finish();
+
+		// Time spent reading and inflating on the other threads, once finished
+		void collect(DecodeStats& stats) const noexcept;
+
+	private:
+		struct Block
+		{
+			std::uint8_t* data{};
+			size_t size{};
+		};
+
+
+		void read_chunks(Inflater::Input input);
+
+		void inflate_blocks(Inflater& inflater, size_t block_bytes);
+
+		// Ends every queue the calling thread is on, then joins
+		void stop() noexcept;
+
+		void join() noexcept;
+
+		// Errors of the other threads, in stream order. The stream's end is only checked once the caller is done
+		void rethrow(bool at_end) const;
+
+
+		SpscQueue<std::span<const std::uint8_t>> payloads;
+		SpscQueue<Block> full;
+		SpscQueue<std::uint8_t*> empty;
+
+		Block current{};  /*block being read by the caller*/
+		size_t position{}; /*in current*/
+
+		std::exception_ptr reader_error{};
+		std::exception_ptr inflater_error{}; /*always before the reader's in the stream: the inflater only had payloads before it*/
+		std::exception_ptr end_error{};      /*from Inflater::finish*/
+		bool starved{};                      /*the inflater asked for more than the reader had, only then does a reader error matter*/
+		std::uint64_t read_ns{}, inflate_ns{};
+		std::uint8_t touched{}; /*keeps page touching from being optimized away*/
+
+		// Last, so they are joined before anything they use is destroyed
+		std::thread reader, inflating;
+	};
+
+} // fill::detail
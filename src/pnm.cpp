@@ -0,0 +1,267 @@
+#include "image.hpp"
+#include "pnm_format.hpp"
+#include "mapped_file.hpp"
+
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+
+// Header parsing
+
+namespace
+{
+
+	bool is_space(std::uint8_t c) noexcept
+	{
+		return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+	}
+
+	// Tokens of a header, whitespace and comments (from # to the end of the line) between them
+	class HeaderReader
+	{
+	public:
+		explicit HeaderReader(std::span<const std::uint8_t> bytes, size_t position) noexcept
+			: bytes{ bytes }
+			, position{ position }
+		{
+		}
+
+		std::string_view word() noexcept
+		{
+			while (position < bytes.size() && (is_space(bytes[position]) || bytes[position] == '#'))
+			{
+				if (bytes[position] == '#')
+					skip_line();
+				else
+					position++;
+			}
+
+			const size_t start{ position };
+			while (position < bytes.size() && !is_space(bytes[position]))
+				position++;
+
+			return { reinterpret_cast<const char*>(bytes.data()) + start, position - start };
+		}
+
+		std::uint32_t number(std::string_view what)
+		{
+			const std::string_view digits{ word() };
+			std::uint64_t value{};
+
+			for (const char digit : digits)
+			{
+				if (digit < '0' || digit > '9' || (value = value * 10 + static_cast<std::uint64_t>(digit - '0')) > std::numeric_limits<std::uint32_t>::max())
+					throw std::runtime_error("ERROR::PNM::Invalid " + std::string{ what } + " in header: " + std::string{ digits });
+			}
+
+			if (digits.empty())
+				throw std::runtime_error("ERROR::PNM::Header ends before its " + std::string{ what });
+
+			return static_cast<std::uint32_t>(value);
+		}
+
+		// Up to and including the next newline
+		void skip_line() noexcept
+		{
+			while (position < bytes.size() && bytes[position++] != '\n');
+		}
+
+		std::span<const std::uint8_t> bytes;
+		size_t position{};
+	};
+
+} // namespace
+
+
+bool fill::detail::is_PNM(std::span<const std::uint8_t> bytes) noexcept
+{
+	return bytes.size() >= 3 && bytes[0] == 'P' && (bytes[1] == '5' || bytes[1] == '6' || bytes[1] == '7') && is_space(bytes[2]);
+}
+
+fill::detail::PnmFormat fill::detail::parse_PNM(std::span<const std::uint8_t> bytes)
+{
+	if (!is_PNM(bytes))
+		throw std::runtime_error("ERROR::WRONG_TYPE::PNM file couldn't be read properly::No proper header");
+
+	PnmFormat format{};
+	HeaderReader header{ bytes, 2 };
+
+	if (bytes[1] == '7')
+	{
+		// Lines of a keyword and its value, in any order, up to ENDHDR
+		format.type = PnmType::PAM;
+		std::uint32_t depth{};
+
+		for (;;)
+		{
+			const std::string_view keyword{ header.word() };
+
+			if (keyword == "ENDHDR")
+			{
+				header.skip_line();
+				break;
+			}
+
+			if (keyword == "TUPLTYPE")
+				header.skip_line(); /*the channel count is DEPTH's*/
+			else if (keyword == "WIDTH")
+				format.width = header.number(keyword);
+			else if (keyword == "HEIGHT")
+				format.height = header.number(keyword);
+			else if (keyword == "DEPTH")
+				depth = header.number(keyword);
+			else if (keyword == "MAXVAL")
+				format.maxval = header.number(keyword);
+			else if (keyword.empty())
+				throw std::runtime_error("ERROR::PNM::Header ends before ENDHDR");
+			else
+				throw std::runtime_error("ERROR::PNM::Unknown header line: " + std::string{ keyword });
+		}
+
+		if (depth == 0 || depth > 4)
+			throw std::runtime_error("ERROR::PNM::Unsupported DEPTH: " + std::to_string(depth));
+
+		format.channels = static_cast<std::uint8_t>(depth);
+	}
+	else
+	{
+		format.type = bytes[1] == '6' ? PnmType::PPM : PnmType::PGM;
+		format.channels = format.type == PnmType::PPM ? 3 : 1;
+
+		format.width = header.number("width");
+		format.height = header.number("height");
+		format.maxval = header.number("maxval");
+
+		// A single whitespace character before the raster
+		if (header.position >= bytes.size() || !is_space(bytes[header.position]))
+			throw std::runtime_error("ERROR::PNM::Raster doesn't follow the header");
+
+		header.position++;
+	}
+
+	if (format.width == 0 || format.height == 0)
+		throw std::runtime_error("ERROR::PNM::Image has no pixels");
+	if (format.maxval == 0 || format.maxval > 65535)
+		throw std::runtime_error("ERROR::PNM::Invalid MAXVAL: " + std::to_string(format.maxval));
+
+	format.bit_depth = format.maxval > 255 ? 16 : 8;
+
+	// Anything after the raster (e.g. a second image) is ignored
+	const std::span<const std::uint8_t> raster{ bytes.subspan(std::min(header.position, bytes.size())) };
+	const size_t pixel_bytes{ static_cast<size_t>(format.channels) * (format.bit_depth / 8) };
+
+	if (format.width > std::numeric_limits<size_t>::max() / pixel_bytes || format.height > raster.size() / format.row_bytes())
+		throw std::runtime_error("ERROR::PNM::File ends before the last row of the image");
+
+	format.raster = raster.first(format.row_bytes() * format.height);
+
+	return format;
+}
+
+std::string fill::detail::PNM_header(const ImageView& source, PnmType type)
+{
+	const std::uint8_t channels{ source.getColorChannel() };
+
+	if (source.getBitDepth() != 8 && source.getBitDepth() != 16)
+		throw std::runtime_error("ERROR::PNM_ENCODE::Unsupported bit depth: " + std::to_string(source.getBitDepth()));
+	if (source.empty())
+		throw std::runtime_error("ERROR::PNM_ENCODE::A PNM image can't be empty");
+
+	const std::string width{ std::to_string(source.getWidth()) }, height{ std::to_string(source.getHeight()) };
+	const std::string maxval{ source.getBitDepth() == 16 ? "65535" : "255" };
+
+	switch (type)
+	{
+	case PnmType::PAM:
+	{
+		constexpr const char* tuple_types[4]{ "GRAYSCALE", "GRAYSCALE_ALPHA", "RGB", "RGB_ALPHA" };
+
+		if (channels == 0 || channels > 4)
+			throw std::runtime_error("ERROR::PNM_ENCODE::No PAM tuple type has " + std::to_string(channels) + " channels");
+
+		return "P7\nWIDTH " + width + "\nHEIGHT " + height + "\nDEPTH " + std::to_string(channels) + "\nMAXVAL " + maxval +
+			"\nTUPLTYPE " + tuple_types[channels - 1] + "\nENDHDR\n";
+	}
+	case PnmType::PPM:
+		if (channels != 3)
+			throw std::runtime_error("ERROR::PNM_ENCODE::PPM images have 3 channels, not " + std::to_string(channels) + ": save as PAM");
+
+		return "P6\n" + width + ' ' + height + '\n' + maxval + '\n';
+
+	case PnmType::PGM:
+		if (channels != 1)
+			throw std::runtime_error("ERROR::PNM_ENCODE::PGM images have 1 channel, not " + std::to_string(channels) + ": save as PAM");
+
+		return "P5\n" + width + ' ' + height + '\n' + maxval + '\n';
+
+	default:
+		throw std::runtime_error("ERROR::PNM_ENCODE::Unknown PNM type");
+	}
+}
+
+
+// --- Saving
+
+void fill::Image::saveToPNM(const std::filesystem::path& path_pnm, PnmType type) const
+{
+	if (size() < size_bytes())
+		throw std::runtime_error("ERROR::PNM_ENCODE::Image holds fewer pixels than its dimensions describe");
+
+	saveToPNM(view(), path_pnm, type);
+}
+
+void fill::Image::saveToPNM(const ImageView& source, const std::filesystem::path& path_pnm, PnmType type)
+{
+	const std::string header{ detail::PNM_header(source, type) };
+	const size_t row_bytes{ static_cast<size_t>(source.getWidth()) * source.getBytesPerPixel() };
+
+	std::ofstream file{ path_pnm, std::ios::binary | std::ios::trunc };
+	bool written{ file && file.write(header.data(), static_cast<std::streamsize>(header.size())) };
+
+	// Samples are stored as the file wants them: straight out of the pixels, in one write when rows are packed
+	if (source.contiguous())
+		written = written && file.write(reinterpret_cast<const char*>(source.data()), static_cast<std::streamsize>(row_bytes * source.getHeight()));
+	else
+		for (std::uint32_t y{}; y < source.getHeight() && written; y++)
+			written = static_cast<bool>(file.write(reinterpret_cast<const char*>(source.row(y)), static_cast<std::streamsize>(row_bytes)));
+
+	if (!written)
+		throw std::runtime_error("ERROR::FILE::Couldn't write file: " + path_pnm.string());
+}
+
+std::vector<std::uint8_t> fill::Image::encodePNM(const ImageView& source, PnmType type)
+{
+	const std::string header{ detail::PNM_header(source, type) };
+	const size_t row_bytes{ static_cast<size_t>(source.getWidth()) * source.getBytesPerPixel() };
+
+	std::vector<std::uint8_t> pnm(header.begin(), header.end());
+	pnm.reserve(header.size() + row_bytes * source.getHeight());
+
+	for (std::uint32_t y{}; y < source.getHeight(); y++)
+		pnm.insert(pnm.end(), source.row(y), source.row(y) + row_bytes);
+
+	return pnm;
+}
+
+
+// --- Mapped images
+
+fill::MappedImage::MappedImage(const std::filesystem::path& path_to_file)
+	: file{ std::make_unique<detail::MappedFile>(path_to_file) }
+{
+	const detail::PnmFormat format{ detail::parse_PNM(file->bytes()) };
+
+	if (!format.full_range())
+		throw std::runtime_error("ERROR::PNM::Samples of MAXVAL " + std::to_string(format.maxval) + " need scaling, load them into a fill::Image: " + path_to_file.string());
+
+	pixels = ImageView{ format.raster.data(), format.width, format.height, format.row_bytes(), format.channels, format.bit_depth };
+}
+
+fill::MappedImage::MappedImage(MappedImage&&) noexcept = default;
+
+fill::MappedImage& fill::MappedImage::operator=(MappedImage&&) noexcept = default;
+
+fill::MappedImage::~MappedImage() = default;
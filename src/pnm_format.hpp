@@ -0,0 +1,48 @@
+#pragma once // pnm_format.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// Internal header: headers of binary Netpbm files, PAM (P7), PPM (P6) and PGM (P5), see pnm.hpp.
+//	- The raster is never copied nor scanned: it is a span into the file's bytes, right after the header.
+//	- Samples are bytes up to MAXVAL 255, big endian 16 bit words above it -- as FILL stores them when MAXVAL is 255 or 65535.
+// ===================================================
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+#include "image_view.hpp"
+#include "pnm.hpp"
+
+namespace fill::detail
+{
+
+	struct PnmFormat
+	{
+		PnmType type{};
+
+		std::uint32_t width{}, height{};
+		std::uint8_t channels{};  /*DEPTH of a PAM*/
+		std::uint32_t maxval{};
+		std::uint8_t bit_depth{}; /*8 up to MAXVAL 255, 16 above*/
+
+		std::span<const std::uint8_t> raster{}; /*rows one after the other, no padding, exactly height rows long*/
+
+		size_t row_bytes() const noexcept { return static_cast<size_t>(width) * channels * (bit_depth / 8); }
+
+		// Samples span their whole range, and can be used as they are
+		bool full_range() const noexcept { return maxval == 255 || maxval == 65535; }
+	};
+
+
+	// "P5", "P6" or "P7", then whitespace
+	bool is_PNM(std::span<const std::uint8_t> bytes) noexcept;
+
+	// Throws on invalid headers, and rasters shorter than the header says
+	PnmFormat parse_PNM(std::span<const std::uint8_t> bytes);
+
+	// Header of a binary file holding source's pixels (8 or 16 bit). PPM and PGM only hold 3 and 1 channels
+	std::string PNM_header(const ImageView& source, PnmType type);
+
+} // fill::detail
@@ -0,0 +1,121 @@
+#include "probe.hpp"
+#include "mapped_file.hpp"
+#include "parallel.hpp"
+
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+
+namespace
+{
+
+	// Signature (8), then IHDR's length (4), type (4), data (13) and CRC (4)
+	constexpr size_t header_size{ 33 };
+
+	constexpr std::uint8_t signature[8]{ 0x89, 0x50, 0x4e, 0x47, 0xd, 0xa, 0x1a, 0xa };
+
+
+	std::uint32_t read_uint32(const std::uint8_t* bytes) noexcept
+	{
+		return
+			static_cast<std::uint32_t>(bytes[0]) << 24 |
+			static_cast<std::uint32_t>(bytes[1]) << 16 |
+			static_cast<std::uint32_t>(bytes[2]) << 8 |
+			static_cast<std::uint32_t>(bytes[3]);
+	}
+
+	// Samples per pixel, 0 for an unknown color type
+	std::uint8_t channels_of(std::uint8_t color_type) noexcept
+	{
+		switch (color_type)
+		{
+		case 0: return 1;
+		case 2: return 3;
+		case 3: return 1;
+		case 4: return 2;
+		case 6: return 4;
+		default: return 0;
+		}
+	}
+
+	// Same checks loading does on IHDR (see PNG spec, section 11.2.2)
+	bool allowed_bit_depth(std::uint8_t color_type, std::uint8_t bit_depth) noexcept
+	{
+		switch (color_type)
+		{
+		case 0: return bit_depth == 1 || bit_depth == 2 || bit_depth == 4 || bit_depth == 8 || bit_depth == 16;
+		case 3: return bit_depth == 1 || bit_depth == 2 || bit_depth == 4 || bit_depth == 8;
+		default: return bit_depth == 8 || bit_depth == 16;
+		}
+	}
+
+	fill::ImageInfo parse_header(std::span<const std::uint8_t> bytes)
+	{
+		if (bytes.size() < sizeof(signature) || std::memcmp(bytes.data(), signature, sizeof(signature)) != 0)
+			throw std::runtime_error("ERROR::WRONG_TYPE::PNG file couldn't be read properly::No proper header");
+
+		if (bytes.size() < header_size || read_uint32(bytes.data() + 8) != 13 || std::memcmp(bytes.data() + 12, "IHDR", 4) != 0)
+			throw std::runtime_error("ERROR::WRONG_TYPE::File doesn't correspond to the PNG standard::No corresponding IHDR chunk");
+
+		const std::uint8_t* ihdr{ bytes.data() + 16 };
+
+		fill::ImageInfo info{};
+		info.width = read_uint32(ihdr);
+		info.height = read_uint32(ihdr + 4);
+		info.bit_depth = ihdr[8];
+		info.color_type = ihdr[9];
+		info.channels = channels_of(info.color_type);
+		info.interlaced = ihdr[12] == 1;
+
+		if (info.width == 0 || info.height == 0)
+			throw std::runtime_error("ERROR::PNG::Image has no pixels");
+		if (info.channels == 0)
+			throw std::runtime_error("ERROR::PNG::Unknown color type: " + std::to_string(info.color_type));
+		if (!allowed_bit_depth(info.color_type, info.bit_depth))
+			throw std::runtime_error("ERROR::PNG::Invalid bit depth " + std::to_string(info.bit_depth) + " for color type " + std::to_string(info.color_type));
+		if (ihdr[12] > 1)
+			throw std::runtime_error("ERROR::PNG::Unknown interlace method: " + std::to_string(ihdr[12]));
+
+		return info;
+	}
+
+} // namespace
+
+
+fill::ImageInfo fill::probe(const std::filesystem::path& path_to_file)
+{
+	std::array<std::uint8_t, header_size> header{};
+	const size_t read{ detail::read_file_head(path_to_file, header) };
+
+	return parse_header({ header.data(), read });
+}
+
+fill::ImageInfo fill::probe(std::span<const std::byte> file_bytes)
+{
+	return parse_header({ reinterpret_cast<const std::uint8_t*>(file_bytes.data()), file_bytes.size() });
+}
+
+std::vector<fill::ImageInfo> fill::probe(std::span<const std::filesystem::path> paths, ThreadPool* pool)
+{
+	std::vector<ImageInfo> infos(paths.size());
+
+	// A probe is only an open and a 33 byte read, a band needs a few files to be worth a task
+	detail::for_each_band(pool, paths.size(), 16, [&](size_t begin, size_t end)
+	{
+		for (size_t i{ begin }; i < end; i++)
+		{
+			try
+			{
+				infos[i] = probe(paths[i]);
+			}
+			catch (...)
+			{
+				/*left default constructed*/
+			}
+		}
+	});
+
+	return infos;
+}
@@ -0,0 +1,35 @@
+#include "reduce.hpp"
+
+
+// Scalar kernel
+
+namespace
+{
+
+	void reduce(const std::uint8_t* top, const std::uint8_t* bottom, std::uint8_t* destination, size_t destination_width, size_t bpp)
+	{
+		for (size_t x{}; x < destination_width; x++)
+			for (size_t c{}; c < bpp; c++)
+				destination[x * bpp + c] = static_cast<std::uint8_t>((top[2 * x * bpp + c] + top[(2 * x + 1) * bpp + c] + bottom[2 * x * bpp + c] + bottom[(2 * x + 1) * bpp + c] + 2) >> 2);
+	}
+
+} // namespace
+
+
+// Dispatch
+
+fill::detail::ReduceKernel fill::detail::reduce_kernel(SimdLevel level, size_t bpp) noexcept
+{
+#if defined(FILL_X86_SIMD)
+	if (level >= SimdLevel::AVX2)
+	{
+		if (const ReduceKernel specialized{ avx2_reduce_kernel(bpp) })
+			return specialized;
+	}
+#else
+	(void)level;
+	(void)bpp;
+#endif
+
+	return reduce;
+}
@@ -0,0 +1,32 @@
+#pragma once // reduce.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// Internal header: 2x2 box reduction of 8 bit rows, the building block of box filtered mip chains.
+// ===================================================
+
+#include <cstddef>
+#include <cstdint>
+
+#include "simd.hpp"
+
+namespace fill::detail
+{
+
+	// Destination pixel x is the rounded average of pixels 2x and 2x + 1 of both top and bottom
+	using ReduceKernel = void (*)(const std::uint8_t* top, const std::uint8_t* bottom, std::uint8_t* destination, size_t destination_width, size_t bpp);
+
+
+	// Kernel for a given instruction set, falling back to the scalar one where there is no specialization for bpp.
+	ReduceKernel reduce_kernel(SimdLevel level, size_t bpp) noexcept;
+
+	// Kernel for the running machine.
+	inline ReduceKernel reduce_kernel(size_t bpp) noexcept { return reduce_kernel(detect_simd_level(), bpp); }
+
+
+	// Per instruction set overrides, nullptr where there is no specialization
+#if defined(FILL_X86_SIMD)
+	ReduceKernel avx2_reduce_kernel(size_t bpp) noexcept;
+#endif
+
+} // fill::detail
@@ -0,0 +1,56 @@
+#include "reduce.hpp"
+
+#if defined(FILL_X86_SIMD)
+
+#include <immintrin.h>
+
+// AVX2 kernels
+// 4 bytes per pixel: 16 source pixels of each row per step. Even and odd pixels are split into the low and high
+// halves of each 128 bit lane, widened to 16 bits and summed, then packed back into 8 destination pixels.
+
+namespace
+{
+
+	// (p0 + p1, p2 + p3 | p4 + p5, p6 + p7) of 8 pixels, in 16 bit lanes
+	__m256i pair_sums(__m256i pixels) noexcept
+	{
+		const __m256i zero{ _mm256_setzero_si256() };
+		const __m256i split{ _mm256_shuffle_epi32(pixels, _MM_SHUFFLE(3, 1, 2, 0)) }; /*p0 p2 p1 p3 per lane*/
+
+		return _mm256_add_epi16(_mm256_unpacklo_epi8(split, zero), _mm256_unpackhi_epi8(split, zero));
+	}
+
+	void reduce4(const std::uint8_t* top, const std::uint8_t* bottom, std::uint8_t* destination, size_t destination_width, size_t)
+	{
+		const __m256i two{ _mm256_set1_epi16(2) };
+		size_t x{};
+
+		for (; x + 8 <= destination_width; x += 8)
+		{
+			const auto load{ [](const std::uint8_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); } };
+
+			const __m256i low{ _mm256_add_epi16(pair_sums(load(top + x * 8)), pair_sums(load(bottom + x * 8))) };
+			const __m256i high{ _mm256_add_epi16(pair_sums(load(top + x * 8 + 32)), pair_sums(load(bottom + x * 8 + 32))) };
+
+			const __m256i average_low{ _mm256_srli_epi16(_mm256_add_epi16(low, two), 2) };
+			const __m256i average_high{ _mm256_srli_epi16(_mm256_add_epi16(high, two), 2) };
+
+			// Lanes come out as (q0 q1 q4 q5 | q2 q3 q6 q7)
+			const __m256i packed{ _mm256_packus_epi16(average_low, average_high) };
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + x * 4), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+		}
+
+		for (; x < destination_width; x++)
+			for (size_t c{}; c < 4; c++)
+				destination[x * 4 + c] = static_cast<std::uint8_t>((top[x * 8 + c] + top[x * 8 + 4 + c] + bottom[x * 8 + c] + bottom[x * 8 + 4 + c] + 2) >> 2);
+	}
+
+} // namespace
+
+
+fill::detail::ReduceKernel fill::detail::avx2_reduce_kernel(size_t bpp) noexcept
+{
+	return bpp == 4 ? reduce4 : nullptr;
+}
+
+#endif
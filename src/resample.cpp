@@ -0,0 +1,342 @@
+#include "resample.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+#include <stdexcept>
+#include <string>
+
+
+// Weight tables
+
+namespace
+{
+
+	double sinc(double x) noexcept
+	{
+		if (x == 0.0)
+			return 1.0;
+
+		x *= std::numbers::pi;
+		return std::sin(x) / x;
+	}
+
+	double filter_support(fill::ResizeFilter filter) noexcept
+	{
+		switch (filter)
+		{
+		case fill::ResizeFilter::Box: return 0.5;
+		case fill::ResizeFilter::Lanczos3: return 3.0;
+		case fill::ResizeFilter::Kaiser: return 3.0;
+		default: return 1.0;
+		}
+	}
+
+	// Modified Bessel function of the first kind, order 0 (series, converges quickly for the alpha used here)
+	double bessel_i0(double x) noexcept
+	{
+		double sum{ 1.0 }, term{ 1.0 };
+
+		for (int k{ 1 }; k < 32; k++)
+		{
+			term *= (x / (2 * k)) * (x / (2 * k));
+			sum += term;
+		}
+
+		return sum;
+	}
+
+	double filter_weight(fill::ResizeFilter filter, double x) noexcept
+	{
+		switch (filter)
+		{
+		case fill::ResizeFilter::Box:
+			return (x > -0.5 && x <= 0.5) ? 1.0 : 0.0;
+
+		case fill::ResizeFilter::Lanczos3:
+			return (x > -3.0 && x < 3.0) ? sinc(x) * sinc(x / 3.0) : 0.0;
+
+		case fill::ResizeFilter::Kaiser:
+		{
+			constexpr double alpha{ 4.0 }, width{ 3.0 };
+
+			const double t{ x / width };
+			return (t > -1.0 && t < 1.0) ? sinc(x) * bessel_i0(alpha * std::sqrt(1.0 - t * t)) / bessel_i0(alpha) : 0.0;
+		}
+
+		default:
+			x = std::abs(x);
+			return x < 1.0 ? 1.0 - x : 0.0;
+		}
+	}
+
+} // namespace
+
+
+fill::detail::ResampleWeights fill::detail::resample_weights(std::uint32_t source_size, std::uint32_t destination_size, ResizeFilter filter)
+{
+	const double scale{ static_cast<double>(source_size) / destination_size };
+	const double filter_scale{ std::max(scale, 1.0) }; /*downscaling widens the filter so that every source pixel counts*/
+	const double support{ filter_support(filter) * filter_scale };
+
+	ResampleWeights table{};
+	table.first.resize(destination_size);
+	table.taps.resize(destination_size);
+	table.stride = (static_cast<size_t>(std::ceil(support)) * 2 + 1 + 3) & ~size_t{ 3 };
+	table.weights.assign(table.stride * destination_size, 0);
+
+	std::vector<double> weights(table.stride);
+
+	for (std::uint32_t i{}; i < destination_size; i++)
+	{
+		const double center{ (i + 0.5) * scale };
+
+		const auto first{ static_cast<std::int64_t>(std::max(std::floor(center - support + 0.5), 0.0)) };
+		const auto last{ std::min(static_cast<std::int64_t>(std::floor(center + support + 0.5)), static_cast<std::int64_t>(source_size)) };
+		const auto taps{ static_cast<size_t>(std::clamp<std::int64_t>(last - first, 1, static_cast<std::int64_t>(table.stride))) };
+
+		double sum{};
+		for (size_t k{}; k < taps; k++)
+		{
+			weights[k] = filter_weight(filter, (first + k - center + 0.5) / filter_scale);
+			sum += weights[k];
+		}
+
+		// Normalize in fixed point, then hand the rounding error to the largest weight so brightness is kept exactly
+		std::int16_t* fixed{ table.weights.data() + i * table.stride };
+		int fixed_sum{};
+		size_t largest{};
+
+		for (size_t k{}; k < taps; k++)
+		{
+			fixed[k] = static_cast<std::int16_t>(std::lround(sum != 0.0 ? weights[k] / sum * (1 << resample_bits) : (k == 0) << resample_bits));
+			fixed_sum += fixed[k];
+
+			if (fixed[k] > fixed[largest])
+				largest = k;
+		}
+
+		fixed[largest] = static_cast<std::int16_t>(fixed[largest] + (1 << resample_bits) - fixed_sum);
+
+		table.first[i] = static_cast<std::uint32_t>(first);
+		table.taps[i] = static_cast<std::uint32_t>(taps);
+	}
+
+	return table;
+}
+
+
+// Scalar kernels
+
+namespace
+{
+
+	std::uint8_t round_and_clamp(std::int32_t value) noexcept
+	{
+		value = (value + (1 << (fill::detail::resample_bits - 1))) >> fill::detail::resample_bits;
+		return static_cast<std::uint8_t>(std::clamp(value, 0, 255));
+	}
+
+	template <size_t BPP>
+	void horizontal(const std::uint8_t* source, std::uint8_t* destination, size_t, const fill::detail::ResampleWeights& weights, size_t)
+	{
+		for (size_t i{}; i < weights.first.size(); i++)
+		{
+			const std::uint8_t* pixel{ source + weights.first[i] * BPP };
+			const std::int16_t* w{ weights.weights.data() + i * weights.stride };
+
+			std::int32_t sum[BPP]{};
+
+			for (size_t k{}; k < weights.taps[i]; k++)
+				for (size_t c{}; c < BPP; c++)
+					sum[c] += pixel[k * BPP + c] * w[k];
+
+			for (size_t c{}; c < BPP; c++)
+				destination[i * BPP + c] = round_and_clamp(sum[c]);
+		}
+	}
+
+	void vertical(const std::uint8_t* source, size_t pitch, const std::int16_t* weights, size_t taps, std::uint8_t* destination, size_t width_bytes)
+	{
+		for (size_t x{}; x < width_bytes; x++)
+		{
+			std::int32_t sum{};
+
+			for (size_t k{}; k < taps; k++)
+				sum += source[k * pitch + x] * weights[k];
+
+			destination[x] = round_and_clamp(sum);
+		}
+	}
+
+} // namespace
+
+
+// Dispatch
+
+fill::detail::ResampleKernels fill::detail::resample_kernels(SimdLevel level, size_t bpp) noexcept
+{
+	ResampleKernels kernels{ nullptr, vertical };
+
+	switch (bpp)
+	{
+	case 1: kernels.horizontal = horizontal<1>; break;
+	case 2: kernels.horizontal = horizontal<2>; break;
+	case 3: kernels.horizontal = horizontal<3>; break;
+	case 4: kernels.horizontal = horizontal<4>; break;
+	}
+
+#if defined(FILL_X86_SIMD)
+	if (level >= SimdLevel::AVX2)
+		avx2_resample_kernels(kernels, bpp);
+#else
+	(void)level;
+#endif
+
+	return kernels;
+}
+
+
+// --- Resize
+
+namespace
+{
+
+	// Index of the source pixel whose center is closest to the center of destination pixel i
+	std::vector<std::uint32_t> nearest_table(std::uint32_t source_size, std::uint32_t destination_size)
+	{
+		std::vector<std::uint32_t> table(destination_size);
+
+		for (std::uint32_t i{}; i < destination_size; i++)
+			table[i] = static_cast<std::uint32_t>(std::min<std::uint64_t>((2 * std::uint64_t{ i } + 1) * source_size / (2 * std::uint64_t{ destination_size }), source_size - 1));
+
+		return table;
+	}
+
+} // namespace
+
+void fill::detail::resample(const std::uint8_t* source, size_t source_pitch, std::uint32_t width, std::uint32_t height, std::uint8_t* destination, size_t destination_pitch, std::uint32_t new_width, std::uint32_t new_height, size_t bpp, ResizeFilter filter, ThreadPool* pool)
+{
+	if (new_width == 0 || new_height == 0)
+		return;
+	if (width == 0 || height == 0)
+		throw std::runtime_error("ERROR::RESIZE::Cannot resample an empty image");
+
+	const size_t pitch{ static_cast<size_t>(new_width) * bpp };
+	constexpr size_t band_bytes{ 64 * 1024 }; /*smallest amount of output a band is worth*/
+
+	if (filter == ResizeFilter::Nearest)
+	{
+		const std::vector<std::uint32_t> columns{ nearest_table(width, new_width) };
+		const std::vector<std::uint32_t> rows{ nearest_table(height, new_height) };
+
+		for_each_band(pool, new_height, band_bytes / pitch, [&](size_t begin, size_t end)
+		{
+			for (size_t y{ begin }; y < end; y++)
+			{
+				std::uint8_t* row{ destination + y * destination_pitch };
+
+				// Rows picked twice (upscaling) are only gathered once
+				if (y != begin && rows[y] == rows[y - 1])
+				{
+					std::memcpy(row, row - destination_pitch, pitch);
+					continue;
+				}
+
+				const std::uint8_t* source_row{ source + rows[y] * source_pitch };
+
+				for (size_t x{}; x < new_width; x++)
+					std::memcpy(row + x * bpp, source_row + columns[x] * bpp, bpp);
+			}
+		});
+
+		return;
+	}
+
+	const ResampleKernels kernels{ resample_kernels(bpp) };
+
+	const bool horizontal{ new_width != width };
+	const bool vertical{ new_height != height };
+
+	if (!horizontal && !vertical)
+	{
+		for (size_t y{}; y < new_height; y++)
+			std::memcpy(destination + y * destination_pitch, source + y * source_pitch, pitch);
+		return;
+	}
+
+	ResampleWeights rows{};
+	std::uint32_t first_row{}, last_row{ height }; /*source rows the vertical pass reads*/
+
+	if (vertical)
+	{
+		rows = resample_weights(height, new_height, filter);
+		first_row = rows.first.front();
+		last_row = rows.first.back() + rows.taps.back();
+	}
+
+	// Horizontal pass: straight into the destination, or into the rows the vertical pass needs
+	std::vector<std::uint8_t> intermediate{};
+	const std::uint8_t* columns_source{ source };
+	size_t columns_pitch{ source_pitch };
+
+	if (horizontal)
+	{
+		const ResampleWeights columns{ resample_weights(width, new_width, filter) };
+
+		std::uint8_t* horizontal_destination{ destination };
+		size_t horizontal_pitch{ destination_pitch };
+
+		if (vertical)
+		{
+			intermediate.resize((last_row - first_row) * pitch);
+			horizontal_destination = intermediate.data();
+			horizontal_pitch = pitch;
+			columns_source = intermediate.data();
+			columns_pitch = pitch;
+		}
+
+		for_each_band(pool, last_row - first_row, band_bytes / pitch, [&](size_t begin, size_t end)
+		{
+			for (size_t y{ begin }; y < end; y++)
+				kernels.horizontal(source + (first_row + y) * source_pitch, horizontal_destination + y * horizontal_pitch, width, columns, bpp);
+		});
+
+		if (!vertical)
+			return;
+	}
+	else
+		columns_source = source + first_row * source_pitch;
+
+	// Vertical pass: row bands of the destination
+	for_each_band(pool, new_height, band_bytes / pitch, [&](size_t begin, size_t end)
+	{
+		for (size_t y{ begin }; y < end; y++)
+		{
+			kernels.vertical(columns_source + (rows.first[y] - first_row) * columns_pitch, columns_pitch,
+				rows.weights.data() + y * rows.stride, rows.taps[y], destination + y * destination_pitch, pitch);
+		}
+	});
+}
+
+fill::Image fill::Image::resize(std::uint32_t new_width, std::uint32_t new_height, ResizeFilter filter, ThreadPool* pool) const
+{
+	if (size() < size_bytes())
+		throw std::runtime_error("ERROR::RESIZE::Image holds fewer pixels than its dimensions describe");
+
+	return resize(view(), new_width, new_height, filter, pool, layout);
+}
+
+fill::Image fill::Image::resize(const ImageView& source, std::uint32_t new_width, std::uint32_t new_height, ResizeFilter filter, ThreadPool* pool, const PixelLayout& layout)
+{
+	if (source.getBitDepth() != 8 || source.getBytesPerPixel() == 0 || source.getBytesPerPixel() > 4)
+		throw std::runtime_error("ERROR::RESIZE::Only 8 bit images can be resampled");
+
+	Image resized{ new_width, new_height, source.getColorChannel(), source.getBitDepth(), layout };
+
+	detail::resample(source.data(), source.getStride(), source.getWidth(), source.getHeight(), resized.data(), resized.getPitch(), new_width, new_height, source.getBytesPerPixel(), filter, pool);
+
+	return resized;
+}
@@ -0,0 +1,68 @@
+#pragma once // resample.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// Internal header: separable resampling kernels used by fill::Image::resize.
+//	- Each axis gets a table of fixed point weights, one run of source pixels per destination pixel.
+//	- Rows are first resampled horizontally, then columns vertically, 8 bits per channel.
+//	- The vertical pass works on whole rows of bytes (any pixel size), the horizontal one is specialized for 3 and 4 bytes per pixel.
+//
+// See: https://en.wikipedia.org/wiki/Lanczos_resampling
+// ===================================================
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "image.hpp"
+#include "simd.hpp"
+
+namespace fill::detail
+{
+
+	// Weights are 2.14 fixed point: they fit a 16 bit lane, and every destination pixel's weights sum to exactly 1 << 14
+	constexpr int resample_bits{ 14 };
+
+	struct ResampleWeights
+	{
+		std::vector<std::uint32_t> first{}; /*first source pixel of each destination pixel*/
+		std::vector<std::uint32_t> taps{};  /*number of source pixels it is made of*/
+
+		std::vector<std::int16_t> weights{}; /*taps of destination pixel i start at i * stride, padded with 0 up to a multiple of 4*/
+		size_t stride{};
+	};
+
+	// Any filter but Nearest, which doesn't need weights
+	ResampleWeights resample_weights(std::uint32_t source_size, std::uint32_t destination_size, ResizeFilter filter);
+
+
+	// One row, source_width pixels to weights.first.size() pixels
+	using HorizontalKernel = void (*)(const std::uint8_t* source, std::uint8_t* destination, size_t source_width, const ResampleWeights& weights, size_t bpp);
+
+	// One row of width_bytes bytes, from taps rows pitch bytes apart starting at source
+	using VerticalKernel = void (*)(const std::uint8_t* source, size_t pitch, const std::int16_t* weights, size_t taps, std::uint8_t* destination, size_t width_bytes);
+
+	struct ResampleKernels
+	{
+		HorizontalKernel horizontal{};
+		VerticalKernel vertical{};
+	};
+
+
+	// Kernels for a given instruction set, falling back to scalar ones where there is no specialization for bpp.
+	ResampleKernels resample_kernels(SimdLevel level, size_t bpp) noexcept;
+
+	// Kernels for the running machine.
+	inline ResampleKernels resample_kernels(size_t bpp) noexcept { return resample_kernels(detect_simd_level(), bpp); }
+
+
+	// Resamples a width x height image of bpp bytes per pixel into destination, rows of each pitch bytes apart, see fill::Image::resize
+	void resample(const std::uint8_t* source, size_t source_pitch, std::uint32_t width, std::uint32_t height, std::uint8_t* destination, size_t destination_pitch, std::uint32_t new_width, std::uint32_t new_height, size_t bpp, ResizeFilter filter, ThreadPool* pool);
+
+
+	// Per instruction set kernel tables, only filled where a specialization exists.
+#if defined(FILL_X86_SIMD)
+	void avx2_resample_kernels(ResampleKernels& kernels, size_t bpp) noexcept;
+#endif
+
+} // fill::detail
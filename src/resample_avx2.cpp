@@ -0,0 +1,142 @@
+#include "resample.hpp"
+
+#if defined(FILL_X86_SIMD)
+
+#include <cstring>
+
+#include <immintrin.h>
+
+// AVX2 kernels
+// Both passes multiply 16 bit pixels by 16 bit weights two taps at a time (pmaddwd), accumulating in 32 bits.
+// Vertical: 32 bytes of a row per step, whatever the pixel size. Horizontal: one destination pixel per step,
+// four taps per pmaddwd pair, the two 128 bit lanes each holding two source pixels with their channels interleaved.
+
+namespace
+{
+
+	constexpr int rounding{ 1 << (fill::detail::resample_bits - 1) };
+
+	void vertical(const std::uint8_t* source, size_t pitch, const std::int16_t* weights, size_t taps, std::uint8_t* destination, size_t width_bytes)
+	{
+		size_t x{};
+
+		for (; x + 32 <= width_bytes; x += 32)
+		{
+			__m256i sum0{ _mm256_set1_epi32(rounding) }, sum1{ sum0 }, sum2{ sum0 }, sum3{ sum0 };
+
+			for (size_t k{}; k < taps; k += 2)
+			{
+				const std::uint8_t* row0{ source + k * pitch + x };
+				const std::uint8_t* row1{ k + 1 < taps ? row0 + pitch : row0 }; /*an odd last tap pairs with itself, at weight 0*/
+
+				const std::int32_t pair{ static_cast<std::uint16_t>(weights[k]) | static_cast<std::int32_t>(k + 1 < taps ? weights[k + 1] : 0) << 16 };
+				const __m256i w{ _mm256_set1_epi32(pair) };
+
+				const __m256i a{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row0)) };
+				const __m256i b{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row1)) };
+
+				// Bytes interleaved with zeros, then rows interleaved: (a, b) pairs of 16 bit values
+				const __m256i zero{ _mm256_setzero_si256() };
+				const __m256i a_low{ _mm256_unpacklo_epi8(a, zero) }, a_high{ _mm256_unpackhi_epi8(a, zero) };
+				const __m256i b_low{ _mm256_unpacklo_epi8(b, zero) }, b_high{ _mm256_unpackhi_epi8(b, zero) };
+
+				sum0 = _mm256_add_epi32(sum0, _mm256_madd_epi16(_mm256_unpacklo_epi16(a_low, b_low), w));
+				sum1 = _mm256_add_epi32(sum1, _mm256_madd_epi16(_mm256_unpackhi_epi16(a_low, b_low), w));
+				sum2 = _mm256_add_epi32(sum2, _mm256_madd_epi16(_mm256_unpacklo_epi16(a_high, b_high), w));
+				sum3 = _mm256_add_epi32(sum3, _mm256_madd_epi16(_mm256_unpackhi_epi16(a_high, b_high), w));
+			}
+
+			// Every unpack stayed within its 128 bit lane, so packing back in the same order restores the byte order
+			const __m256i low{ _mm256_packs_epi32(_mm256_srai_epi32(sum0, fill::detail::resample_bits), _mm256_srai_epi32(sum1, fill::detail::resample_bits)) };
+			const __m256i high{ _mm256_packs_epi32(_mm256_srai_epi32(sum2, fill::detail::resample_bits), _mm256_srai_epi32(sum3, fill::detail::resample_bits)) };
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + x), _mm256_packus_epi16(low, high));
+		}
+
+		for (; x < width_bytes; x++)
+		{
+			std::int32_t sum{ rounding };
+
+			for (size_t k{}; k < taps; k++)
+				sum += source[k * pitch + x] * weights[k];
+
+			sum >>= fill::detail::resample_bits;
+			destination[x] = static_cast<std::uint8_t>(sum < 0 ? 0 : sum > 255 ? 255 : sum);
+		}
+	}
+
+	template <size_t BPP>
+	__m128i load_pixel(const std::uint8_t* p) noexcept
+	{
+		std::uint32_t pixel{};
+		std::memcpy(&pixel, p, BPP);
+
+		return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(static_cast<int>(pixel)));
+	}
+
+	template <size_t BPP>
+	void horizontal(const std::uint8_t* source, std::uint8_t* destination, size_t source_width, const fill::detail::ResampleWeights& weights, size_t)
+	{
+		// Lane 0 takes pixels 0 and 1 of the 16 bytes loaded, lane 1 pixels 2 and 3: (c of pixel 0, c of pixel 1) pairs per channel
+		const __m256i spread{ BPP == 4
+			? _mm256_setr_epi8(
+				0, -1, 4, -1, 1, -1, 5, -1, 2, -1, 6, -1, 3, -1, 7, -1,
+				8, -1, 12, -1, 9, -1, 13, -1, 10, -1, 14, -1, 11, -1, 15, -1)
+			: _mm256_setr_epi8(
+				0, -1, 3, -1, 1, -1, 4, -1, 2, -1, 5, -1, -1, -1, -1, -1,
+				6, -1, 9, -1, 7, -1, 10, -1, 8, -1, 11, -1, -1, -1, -1, -1) };
+
+		const __m256i lanes{ _mm256_setr_epi32(0, 0, 0, 0, 1, 1, 1, 1) };
+		const size_t row_bytes{ source_width * BPP };
+
+		for (size_t i{}; i < weights.first.size(); i++)
+		{
+			const size_t first{ weights.first[i] };
+			const size_t taps{ weights.taps[i] };
+			const std::int16_t* w{ weights.weights.data() + i * weights.stride };
+
+			__m256i sum{ _mm256_setzero_si256() };
+			size_t k{};
+
+			// Weights are zero padded to a multiple of 4: only the 16 byte load has to stay within the row
+			for (; k < taps && (first + k) * BPP + 16 <= row_bytes; k += 4)
+			{
+				const __m256i pixels{ _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + (first + k) * BPP))), spread) };
+				const __m256i pairs{ _mm256_permutevar8x32_epi32(_mm256_castsi128_si256(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(w + k))), lanes) };
+
+				sum = _mm256_add_epi32(sum, _mm256_madd_epi16(pixels, pairs));
+			}
+
+			__m128i total{ _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1)) };
+
+			for (; k < taps; k++)
+				total = _mm_add_epi32(total, _mm_mullo_epi32(load_pixel<BPP>(source + (first + k) * BPP), _mm_set1_epi32(w[k])));
+
+			total = _mm_srai_epi32(_mm_add_epi32(total, _mm_set1_epi32(rounding)), fill::detail::resample_bits);
+			total = _mm_packus_epi16(_mm_packs_epi32(total, total), total);
+
+			const auto pixel{ static_cast<std::uint32_t>(_mm_cvtsi128_si32(total)) };
+			std::memcpy(destination + i * BPP, &pixel, BPP);
+		}
+	}
+
+} // namespace
+
+
+void fill::detail::avx2_resample_kernels(ResampleKernels& kernels, size_t bpp) noexcept
+{
+	kernels.vertical = vertical;
+
+	switch (bpp)
+	{
+	case 3:
+		kernels.horizontal = horizontal<3>;
+		break;
+
+	case 4:
+		kernels.horizontal = horizontal<4>;
+		break;
+	}
+}
+
+#endif
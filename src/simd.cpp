@@ -0,0 +1,85 @@
+#include "simd.hpp"
+
+#if defined(FILL_X86_SIMD) && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+
+namespace
+{
+
+	fill::detail::SimdLevel query_simd_level() noexcept
+	{
+		using fill::detail::SimdLevel;
+
+#if defined(FILL_X86_SIMD) && (defined(__GNUC__) || defined(__clang__))
+		__builtin_cpu_init();
+
+		if (__builtin_cpu_supports("avx2"))
+			return SimdLevel::AVX2;
+		if (__builtin_cpu_supports("ssse3"))
+			return SimdLevel::SSSE3;
+		if (__builtin_cpu_supports("sse2"))
+			return SimdLevel::SSE2;
+
+#elif defined(FILL_X86_SIMD) && defined(_MSC_VER)
+		int info[4]{};
+
+		__cpuid(info, 0);
+		const int max_leaf{ info[0] };
+
+		__cpuid(info, 1);
+		const bool sse2{ (info[3] & (1 << 26)) != 0 };
+		const bool ssse3{ (info[2] & (1 << 9)) != 0 };
+		const bool os_avx{ (info[2] & (1 << 27)) != 0 /*OSXSAVE*/ && (info[2] & (1 << 28)) != 0 /*AVX*/ };
+
+		bool avx2{};
+		if (max_leaf >= 7 && os_avx && (_xgetbv(0) & 0x6) == 0x6 /*XMM and YMM state enabled by the OS*/)
+		{
+			__cpuidex(info, 7, 0);
+			avx2 = (info[1] & (1 << 5)) != 0;
+		}
+
+		if (avx2)
+			return SimdLevel::AVX2;
+		if (ssse3)
+			return SimdLevel::SSSE3;
+		if (sse2)
+			return SimdLevel::SSE2;
+#endif
+
+		return SimdLevel::Scalar;
+	}
+
+	bool query_clmul() noexcept
+	{
+#if defined(FILL_X86_SIMD) && (defined(__GNUC__) || defined(__clang__))
+		__builtin_cpu_init();
+
+		return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse2");
+
+#elif defined(FILL_X86_SIMD) && defined(_MSC_VER)
+		int info[4]{};
+
+		__cpuid(info, 1);
+		return (info[2] & (1 << 1)) != 0 /*PCLMULQDQ*/ && (info[3] & (1 << 26)) != 0 /*SSE2*/;
+#else
+		return false;
+#endif
+	}
+
+} // namespace
+
+
+fill::detail::SimdLevel fill::detail::detect_simd_level() noexcept
+{
+	static const SimdLevel level{ query_simd_level() };
+	return level;
+}
+
+bool fill::detail::detect_clmul() noexcept
+{
+	static const bool clmul{ query_clmul() };
+	return clmul;
+}
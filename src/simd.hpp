@@ -0,0 +1,30 @@
+#pragma once // simd.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// Internal header: runtime detection of the x86 instruction sets FILL has kernels for.
+// Kernels for each set live in their own translation unit (*_sse2.cpp, *_ssse3.cpp, *_avx2.cpp, *_pclmul.cpp), compiled with matching flags
+// and only called once detect_simd_level() (or detect_clmul()) says the CPU supports them.
+// ===================================================
+
+#include <cstdint>
+
+namespace fill::detail
+{
+
+	enum class SimdLevel
+		: std::uint8_t
+	{
+		Scalar,
+		SSE2,
+		SSSE3,
+		AVX2
+	};
+
+	// Highest instruction set usable on this machine (and compiled in).
+	SimdLevel detect_simd_level() noexcept;
+
+	// Carry-less multiplication (PCLMULQDQ) is usable on this machine (and compiled in). It comes apart from the levels above
+	bool detect_clmul() noexcept;
+
+} // fill::detail
@@ -0,0 +1,111 @@
+#pragma once // spsc_queue.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// Internal header: bounded lock-free queue between exactly one producer thread and one consumer thread.
+//	- Each side only ever writes its own index: no lock, no compare-and-swap.
+//	- Waiting on a full or empty queue sleeps in std::atomic::wait (a futex on Linux), instead of spinning.
+//	- Either side can end the queue: the producer closes it once done, the consumer cancels it when it gives up.
+// ===================================================
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace fill::detail
+{
+
+	template <typename T>
+	class SpscQueue
+	{
+	public:
+		// Capacity is rounded up to a power of two
+		explicit SpscQueue(size_t capacity)
+			: slots(std::bit_ceil(std::max<size_t>(capacity, 1)))
+			, mask{ slots.size() - 1 }
+		{
+		}
+
+		SpscQueue(const SpscQueue&) = delete;
+		SpscQueue& operator=(const SpscQueue&) = delete;
+
+
+		// Producer side. Waits while the queue is full, returns false once the consumer cancelled it
+		bool push(T value)
+		{
+			const size_t tail_index{ tail.load(std::memory_order_relaxed) };
+
+			for (;;)
+			{
+				const size_t head_index{ head.load(std::memory_order_acquire) };
+
+				if (head_index & ended)
+					return false;
+				if (tail_index - head_index < slots.size())
+					break;
+
+				head.wait(head_index, std::memory_order_acquire);
+			}
+
+			slots[tail_index & mask] = std::move(value);
+
+			tail.store(tail_index + 1, std::memory_order_release);
+			tail.notify_one();
+
+			return true;
+		}
+
+		// Consumer side. Waits while the queue is empty, returns false once it is closed and every value was popped
+		bool pop(T& value)
+		{
+			const size_t head_index{ head.load(std::memory_order_relaxed) };
+
+			for (;;)
+			{
+				const size_t tail_index{ tail.load(std::memory_order_acquire) };
+
+				if ((tail_index & ~ended) != head_index)
+					break;
+				if (tail_index & ended)
+					return false;
+
+				tail.wait(tail_index, std::memory_order_acquire);
+			}
+
+			value = std::move(slots[head_index & mask]);
+
+			head.store(head_index + 1, std::memory_order_release);
+			head.notify_one();
+
+			return true;
+		}
+
+		// Producer side: nothing more is coming, the consumer still gets what was pushed
+		void close() noexcept
+		{
+			tail.fetch_or(ended, std::memory_order_release);
+			tail.notify_all();
+		}
+
+		// Consumer side: nothing more is popped, pushes fail from now on
+		void cancel() noexcept
+		{
+			head.fetch_or(ended, std::memory_order_release);
+			head.notify_all();
+		}
+
+	private:
+		static constexpr size_t ended{ ~(~size_t{} >> 1) }; /*top bit of an index, indices never reach it*/
+
+
+		std::vector<T> slots;
+		size_t mask;
+
+		alignas(64) std::atomic<size_t> head{}; /*next value to pop, only written by the consumer*/
+		alignas(64) std::atomic<size_t> tail{}; /*next slot to push to, only written by the producer*/
+	};
+
+} // fill::detail
@@ -0,0 +1,77 @@
+#pragma once // stats.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// Internal header: helpers filling fill::DecodeStats.
+// Everything here compiles to nothing without FILL_DECODE_STATS, callers don't need to check.
+// ===================================================
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "decode_stats.hpp"
+
+namespace fill::detail
+{
+
+	// Splits a run of code into stages: each lap adds the time since the previous one (or since construction) to a counter
+	class StageClock
+	{
+	public:
+		StageClock() noexcept
+		{
+			if constexpr (decode_stats_enabled)
+				last = now();
+		}
+
+		void lap(std::uint64_t& counter) noexcept
+		{
+			if constexpr (decode_stats_enabled)
+			{
+				const std::uint64_t time{ now() };
+				counter += time - last;
+				last = time;
+			}
+		}
+
+		// Drops the time since the last lap, e.g. spent in a user callback
+		void restart() noexcept
+		{
+			if constexpr (decode_stats_enabled)
+				last = now();
+		}
+
+	private:
+		static std::uint64_t now() noexcept
+		{
+			return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+		}
+
+
+		std::uint64_t last{};
+	};
+
+	// Resizes a buffer, counting an allocation when it has to grow
+	template <typename Buffer>
+	void resize_counted(Buffer& buffer, size_t size, DecodeStats& stats)
+	{
+		if constexpr (decode_stats_enabled)
+		{
+			if (size > buffer.capacity())
+			{
+				stats.allocations++;
+				stats.allocated_bytes += size;
+			}
+		}
+
+		buffer.resize(size);
+	}
+
+	inline void count(std::uint64_t& counter, std::uint64_t amount = 1) noexcept
+	{
+		if constexpr (decode_stats_enabled)
+			counter += amount;
+	}
+
+} // fill::detail
@@ -0,0 +1,160 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+
+namespace
+{
+
+	thread_local const fill::ThreadPool* worker_pool{ nullptr };
+	thread_local int worker_index{ -1 };
+
+} // namespace
+
+
+fill::ThreadPool::ThreadPool(unsigned thread_count)
+{
+	if (thread_count == 0)
+		thread_count = std::max(1u, std::thread::hardware_concurrency());
+
+	workers.reserve(thread_count);
+	for (unsigned i{}; i < thread_count; i++)
+		workers.push_back(std::make_unique<Worker>());
+
+	threads.reserve(thread_count);
+	for (unsigned i{}; i < thread_count; i++)
+		threads.emplace_back([this, i]() { run(i); });
+}
+
+fill::ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard lock{ sleep_mutex };
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (auto& thread : threads)
+		thread.join();
+}
+
+
+void fill::ThreadPool::submit(std::function<void()> task)
+{
+	const int self{ current_worker() };
+	const unsigned target{ self >= 0 ? static_cast<unsigned>(self) : next_worker++ % size() };
+
+	unfinished++;
+	queued++; /*counted before it can be taken, so the count never goes below zero*/
+
+	{
+		std::lock_guard lock{ workers[target]->mutex };
+		workers[target]->tasks.push_back(std::move(task));
+	}
+
+	{
+		std::lock_guard lock{ sleep_mutex }; /*a worker may be between its last check and its wait*/
+	}
+	wake.notify_one();
+}
+
+void fill::ThreadPool::wait()
+{
+	std::unique_lock lock{ sleep_mutex };
+	idle.wait(lock, [this]() { return unfinished == 0; });
+
+	if (failure)
+		std::rethrow_exception(std::exchange(failure, nullptr));
+}
+
+int fill::ThreadPool::current_worker() const noexcept
+{
+	return worker_pool == this ? worker_index : -1;
+}
+
+
+void fill::ThreadPool::run(unsigned index)
+{
+	worker_pool = this;
+	worker_index = static_cast<int>(index);
+
+	std::function<void()> task{};
+
+	while (true)
+	{
+		if (try_pop(index, task))
+		{
+			std::exception_ptr error{};
+
+			try
+			{
+				task();
+			}
+			catch (...)
+			{
+				error = std::current_exception(); /*kept for wait(), rather than terminating*/
+			}
+
+			task = nullptr; /*release captures before reporting completion*/
+
+			if (error)
+			{
+				std::lock_guard lock{ sleep_mutex };
+
+				if (!failure)
+					failure = error;
+			}
+
+			if (--unfinished == 0)
+			{
+				std::lock_guard lock{ sleep_mutex };
+				idle.notify_all();
+			}
+
+			continue;
+		}
+
+		std::unique_lock lock{ sleep_mutex };
+		wake.wait(lock, [this]() { return queued > 0 || stopping; });
+
+		if (stopping && queued == 0)
+			return;
+	}
+}
+
+bool fill::ThreadPool::try_pop(unsigned index, std::function<void()>& task)
+{
+	const auto take = [&](Worker& worker, bool own) -> bool
+	{
+		std::lock_guard lock{ worker.mutex };
+
+		if (worker.tasks.empty())
+			return false;
+
+		// Own tasks are taken LIFO (still warm in cache), stolen ones FIFO (the oldest, likely the biggest)
+		if (own)
+		{
+			task = std::move(worker.tasks.back());
+			worker.tasks.pop_back();
+		}
+		else
+		{
+			task = std::move(worker.tasks.front());
+			worker.tasks.pop_front();
+		}
+
+		queued--;
+		return true;
+	};
+
+	if (take(*workers[index], true))
+		return true;
+
+	for (unsigned offset{ 1 }; offset < size(); offset++)
+		if (take(*workers[(index + offset) % size()], false))
+			return true;
+
+	return false;
+}
@@ -0,0 +1,156 @@
+#include "unfilter.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+
+// Scalar kernels
+
+namespace
+{
+
+	std::uint8_t paeth_predictor(std::uint8_t a, std::uint8_t b, std::uint8_t c) noexcept
+	{
+		const int p{ static_cast<int>(a) + b - c };
+		const int pa{ std::abs(p - a) };
+		const int pb{ std::abs(p - b) };
+		const int pc{ std::abs(p - c) };
+
+		if (pa <= pb && pa <= pc)
+			return a;
+		if (pb <= pc)
+			return b;
+		return c;
+	}
+
+	void unfilter_sub(const std::uint8_t* filtered, const std::uint8_t*, std::uint8_t* current, size_t width_bytes, size_t bpp)
+	{
+		const size_t first{ std::min(bpp, width_bytes) }; /*bytes of the first pixel, which have no left neighbour*/
+
+		std::memcpy(current, filtered, first);
+
+		for (size_t i{ first }; i < width_bytes; i++)
+			current[i] = filtered[i] + current[i - bpp];
+	}
+
+	void unfilter_up(const std::uint8_t* filtered, const std::uint8_t* prior, std::uint8_t* current, size_t width_bytes, size_t)
+	{
+		for (size_t i{}; i < width_bytes; i++)
+			current[i] = filtered[i] + prior[i];
+	}
+
+	void unfilter_average(const std::uint8_t* filtered, const std::uint8_t* prior, std::uint8_t* current, size_t width_bytes, size_t bpp)
+	{
+		const size_t first{ std::min(bpp, width_bytes) };
+
+		for (size_t i{}; i < first; i++)
+			current[i] = filtered[i] + (prior[i] >> 1);
+
+		for (size_t i{ first }; i < width_bytes; i++)
+			current[i] = filtered[i] + ((current[i - bpp] + prior[i]) >> 1);
+	}
+
+	void unfilter_paeth(const std::uint8_t* filtered, const std::uint8_t* prior, std::uint8_t* current, size_t width_bytes, size_t bpp)
+	{
+		const size_t first{ std::min(bpp, width_bytes) };
+
+		for (size_t i{}; i < first; i++)
+			current[i] = filtered[i] + prior[i]; /*a = c = 0, so the predictor is b*/
+
+		for (size_t i{ first }; i < width_bytes; i++)
+			current[i] = filtered[i] + paeth_predictor(current[i - bpp], prior[i], prior[i - bpp]);
+	}
+
+	// With no prior row, b = c = 0: Up becomes None, Paeth becomes Sub and Average only depends on a
+	void unfilter_first_row(std::uint8_t filter, const std::uint8_t* filtered, std::uint8_t* current, size_t width_bytes, size_t bpp)
+	{
+		const size_t first{ std::min(bpp, width_bytes) };
+
+		switch (filter)
+		{
+		case 0:
+		case 2:
+			std::memcpy(current, filtered, width_bytes);
+			break;
+
+		case 1:
+		case 4:
+			unfilter_sub(filtered, nullptr, current, width_bytes, bpp);
+			break;
+
+		case 3:
+			std::memcpy(current, filtered, first);
+
+			for (size_t i{ first }; i < width_bytes; i++)
+				current[i] = filtered[i] + (current[i - bpp] >> 1);
+			break;
+
+		default:
+			throw std::runtime_error("ERROR::PNG_UNFILTER::Unknown filter type: " + std::to_string(filter));
+		}
+	}
+
+} // namespace
+
+
+// Dispatch
+
+fill::detail::UnfilterKernels fill::detail::unfilter_kernels(SimdLevel level, size_t bpp) noexcept
+{
+	UnfilterKernels kernels{ unfilter_sub, unfilter_up, unfilter_average, unfilter_paeth };
+
+#if defined(FILL_X86_SIMD)
+	// Each level only overrides what it specializes, on top of the levels below it
+	if (level >= SimdLevel::SSE2)
+		sse2_unfilter_kernels(kernels, bpp);
+	if (level >= SimdLevel::SSSE3)
+		ssse3_unfilter_kernels(kernels, bpp);
+	if (level >= SimdLevel::AVX2)
+		avx2_unfilter_kernels(kernels, bpp);
+#else
+	(void)level;
+	(void)bpp;
+#endif
+
+	return kernels;
+}
+
+void fill::detail::unfilter_row(const UnfilterKernels& kernels, std::uint8_t filter, const std::uint8_t* filtered, const std::uint8_t* prior, std::uint8_t* current, size_t width_bytes, size_t bpp)
+{
+	if (!prior)
+		return unfilter_first_row(filter, filtered, current, width_bytes, bpp);
+
+	switch (filter)
+	{
+	// None
+	case 0:
+		std::memcpy(current, filtered, width_bytes);
+		break;
+
+	// Sub
+	case 1:
+		kernels.sub(filtered, prior, current, width_bytes, bpp);
+		break;
+
+	// Up
+	case 2:
+		kernels.up(filtered, prior, current, width_bytes, bpp);
+		break;
+
+	// Average
+	case 3:
+		kernels.average(filtered, prior, current, width_bytes, bpp);
+		break;
+
+	// Paeth
+	case 4:
+		kernels.paeth(filtered, prior, current, width_bytes, bpp);
+		break;
+
+	default:
+		throw std::runtime_error("ERROR::PNG_UNFILTER::Unknown filter type: " + std::to_string(filter));
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once // unfilter.hpp
+// MIT
+// Allosker - 2025
+// ===================================================
+// Internal header: PNG scanline reconstruction (unfiltering) kernels.
+//	- Every filter type has a scalar kernel, used as the reference and as a fallback.
+//	- On x86, Sub/Average/Paeth are specialized for 3 and 4 bytes per pixel (SSE2, SSSE3, AVX2),
+//	  Up is vectorized for any pixel size.
+//	- The best kernel set is picked once at runtime from CPUID.
+//
+// See: https://www.w3.org/TR/2003/REC-PNG-20031110/#9Filters
+// ===================================================
+
+#include <cstddef>
+#include <cstdint>
+
+#include "simd.hpp"
+
+namespace fill::detail
+{
+
+	// Reconstructs width_bytes bytes of a scanline. prior is never nullptr here.
+	using UnfilterKernel = void (*)(const std::uint8_t* filtered, const std::uint8_t* prior, std::uint8_t* current, size_t width_bytes, size_t bpp);
+
+	struct UnfilterKernels
+	{
+		UnfilterKernel sub{};
+		UnfilterKernel up{};
+		UnfilterKernel average{};
+		UnfilterKernel paeth{};
+	};
+
+
+	// Kernels for a given instruction set, falling back to lower ones where there is no specialization for bpp.
+	UnfilterKernels unfilter_kernels(SimdLevel level, size_t bpp) noexcept;
+
+	// Kernels for the running machine.
+	inline UnfilterKernels unfilter_kernels(size_t bpp) noexcept { return unfilter_kernels(detect_simd_level(), bpp); }
+
+	// Reconstructs one scanline (see PNG spec, section 9.2).
+	// prior is the previous reconstructed scanline, or nullptr for the first one -- in which case every byte of it is treated as 0.
+	void unfilter_row(const UnfilterKernels& kernels, std::uint8_t filter, const std::uint8_t* filtered, const std::uint8_t* prior, std::uint8_t* current, size_t width_bytes, size_t bpp);
+
+
+	// Per instruction set kernel tables, only filled where a specialization exists.
+#if defined(FILL_X86_SIMD)
+	void sse2_unfilter_kernels(UnfilterKernels& kernels, size_t bpp) noexcept;
+	void ssse3_unfilter_kernels(UnfilterKernels& kernels, size_t bpp) noexcept;
+	void avx2_unfilter_kernels(UnfilterKernels& kernels, size_t bpp) noexcept;
+#endif
+
+} // fill::detail
@@ -0,0 +1,82 @@
+#include "unfilter.hpp"
+
+#if defined(FILL_X86_SIMD)
+
+#include <cstring>
+
+#include <immintrin.h>
+
+// AVX2 kernels
+// Only the filters without a pixel-to-pixel dependency across the whole register gain from 32 byte vectors:
+// Up, and Sub on 4 bytes per pixel. Average and Paeth keep the SSSE3/SSE2 kernels.
+
+namespace
+{
+
+	void up(const std::uint8_t* filtered, const std::uint8_t* prior, std::uint8_t* current, size_t width_bytes, size_t)
+	{
+		size_t i{};
+
+		for (; i + 32 <= width_bytes; i += 32)
+		{
+			const __m256i x{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(filtered + i)) };
+			const __m256i b{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prior + i)) };
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(current + i), _mm256_add_epi8(x, b));
+		}
+
+		for (; i < width_bytes; i++)
+			current[i] = filtered[i] + prior[i];
+	}
+
+	// Eight pixels per step: prefix sum inside each 128 bit lane, then the low lane's last pixel is added to the high lane
+	void sub4(const std::uint8_t* filtered, const std::uint8_t*, std::uint8_t* current, size_t width_bytes, size_t)
+	{
+		const __m256i broadcast_last{ _mm256_set1_epi32(7) };
+
+		__m256i carry{ _mm256_setzero_si256() };
+		size_t i{};
+
+		for (; i + 32 <= width_bytes; i += 32)
+		{
+			__m256i x{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(filtered + i)) };
+
+			x = _mm256_add_epi8(x, _mm256_slli_si256(x, 4));
+			x = _mm256_add_epi8(x, _mm256_slli_si256(x, 8));
+
+			const __m256i low_last{ _mm256_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3)) };
+			x = _mm256_add_epi8(x, _mm256_permute2x128_si256(low_last, low_last, 0x08) /*{ 0, low lane }*/);
+			x = _mm256_add_epi8(x, carry);
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(current + i), x);
+
+			carry = _mm256_permutevar8x32_epi32(x, broadcast_last);
+		}
+
+		std::uint32_t last{ static_cast<std::uint32_t>(_mm256_cvtsi256_si32(carry)) };
+
+		for (; i < width_bytes; i += 4)
+		{
+			std::uint32_t pixel{};
+			std::memcpy(&pixel, filtered + i, 4);
+
+			// Bytewise add without carries between bytes
+			pixel = ((pixel & 0x7F7F7F7Fu) + (last & 0x7F7F7F7Fu)) ^ ((pixel ^ last) & 0x80808080u);
+
+			std::memcpy(current + i, &pixel, 4);
+			last = pixel;
+		}
+	}
+
+} // namespace
+
+
+void fill::detail::avx2_unfilter_kernels(UnfilterKernels& kernels, size_t bpp) noexcept
+{
+	kernels.up = up;
+
+	if (bpp == 4)
+		kernels.sub = sub4;
+}
+
+#endif
@@ -0,0 +1,191 @@
+#include "unfilter.hpp"
+
+#if defined(FILL_X86_SIMD)
+
+#include <cstring>
+
+#include <emmintrin.h>
+
+// SSE2 kernels
+// Sub, Average and Paeth depend on the reconstructed pixel to their left, so they work one pixel per step
+// (3 or 4 bytes in the low lanes of a register). Up has no such dependency and works 16 bytes at a time.
+
+namespace
+{
+
+	// 3 byte pixels are moved as 2 + 1 bytes: a 3 byte memcpy through a 4 byte local defeats store forwarding
+	template <size_t BPP>
+	__m128i load_pixel(const std::uint8_t* p) noexcept
+	{
+		std::uint32_t pixel{};
+
+		if constexpr (BPP == 4)
+			std::memcpy(&pixel, p, 4);
+		else
+		{
+			std::uint16_t low{};
+			std::memcpy(&low, p, 2);
+			pixel = low | static_cast<std::uint32_t>(p[2]) << 16;
+		}
+
+		return _mm_cvtsi32_si128(static_cast<int>(pixel));
+	}
+
+	template <size_t BPP>
+	void store_pixel(std::uint8_t* p, __m128i v) noexcept
+	{
+		const auto pixel{ static_cast<std::uint32_t>(_mm_cvtsi128_si32(v)) };
+
+		if constexpr (BPP == 4)
+			std::memcpy(p, &pixel, 4);
+		else
+		{
+			const auto low{ static_cast<std::uint16_t>(pixel) };
+			std::memcpy(p, &low, 2);
+			p[2] = static_cast<std::uint8_t>(pixel >> 16);
+		}
+	}
+
+
+	void up(const std::uint8_t* filtered, const std::uint8_t* prior, std::uint8_t* current, size_t width_bytes, size_t)
+	{
+		size_t i{};
+
+		for (; i + 16 <= width_bytes; i += 16)
+		{
+			const __m128i x{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(filtered + i)) };
+			const __m128i b{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(prior + i)) };
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(current + i), _mm_add_epi8(x, b));
+		}
+
+		for (; i < width_bytes; i++)
+			current[i] = filtered[i] + prior[i];
+	}
+
+	template <size_t BPP>
+	void sub(const std::uint8_t* filtered, const std::uint8_t*, std::uint8_t* current, size_t width_bytes, size_t)
+	{
+		__m128i a{ _mm_setzero_si128() };
+
+		for (size_t i{}; i < width_bytes; i += BPP)
+		{
+			a = _mm_add_epi8(a, load_pixel<BPP>(filtered + i));
+			store_pixel<BPP>(current + i, a);
+		}
+	}
+
+	// Four pixels per step: an in-register prefix sum, then the last pixel of the previous block is carried over
+	void sub4(const std::uint8_t* filtered, const std::uint8_t*, std::uint8_t* current, size_t width_bytes, size_t)
+	{
+		__m128i carry{ _mm_setzero_si128() };
+		size_t i{};
+
+		for (; i + 16 <= width_bytes; i += 16)
+		{
+			__m128i x{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(filtered + i)) };
+
+			x = _mm_add_epi8(x, _mm_slli_si128(x, 4));
+			x = _mm_add_epi8(x, _mm_slli_si128(x, 8));
+			x = _mm_add_epi8(x, carry);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(current + i), x);
+
+			carry = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+		}
+
+		for (; i < width_bytes; i += 4)
+		{
+			carry = _mm_add_epi8(carry, load_pixel<4>(filtered + i));
+			store_pixel<4>(current + i, carry);
+		}
+	}
+
+	// floor((a + b) / 2) on bytes: avg_epu8 rounds up, so remove the carried bit when a + b is odd
+	__m128i average_floor(__m128i a, __m128i b) noexcept
+	{
+		const __m128i odd{ _mm_and_si128(_mm_xor_si128(a, b), _mm_set1_epi8(1)) };
+		return _mm_sub_epi8(_mm_avg_epu8(a, b), odd);
+	}
+
+	template <size_t BPP>
+	void average(const std::uint8_t* filtered, const std::uint8_t* prior, std::uint8_t* current, size_t width_bytes, size_t)
+	{
+		__m128i a{ _mm_setzero_si128() };
+
+		for (size_t i{}; i < width_bytes; i += BPP)
+		{
+			const __m128i b{ load_pixel<BPP>(prior + i) };
+
+			a = _mm_add_epi8(load_pixel<BPP>(filtered + i), average_floor(a, b));
+			store_pixel<BPP>(current + i, a);
+		}
+	}
+
+	__m128i abs_epi16(__m128i x) noexcept
+	{
+		return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+	}
+
+	__m128i if_then_else(__m128i mask, __m128i then_value, __m128i else_value) noexcept
+	{
+		return _mm_or_si128(_mm_and_si128(mask, then_value), _mm_andnot_si128(mask, else_value));
+	}
+
+	// Branchless predictor on 16 bit lanes: p - a = b - c, p - b = a - c, p - c = (b - c) + (a - c)
+	template <size_t BPP>
+	void paeth(const std::uint8_t* filtered, const std::uint8_t* prior, std::uint8_t* current, size_t width_bytes, size_t)
+	{
+		const __m128i zero{ _mm_setzero_si128() };
+
+		__m128i a{ zero }, c{ zero };
+
+		for (size_t i{}; i < width_bytes; i += BPP)
+		{
+			const __m128i b{ _mm_unpacklo_epi8(load_pixel<BPP>(prior + i), zero) };
+
+			const __m128i pa_signed{ _mm_sub_epi16(b, c) };
+			const __m128i pb_signed{ _mm_sub_epi16(a, c) };
+
+			const __m128i pa{ abs_epi16(pa_signed) };
+			const __m128i pb{ abs_epi16(pb_signed) };
+			const __m128i pc{ abs_epi16(_mm_add_epi16(pa_signed, pb_signed)) };
+
+			const __m128i smallest{ _mm_min_epi16(pc, _mm_min_epi16(pa, pb)) };
+
+			const __m128i predictor{
+				if_then_else(_mm_cmpeq_epi16(smallest, pa), a,
+				if_then_else(_mm_cmpeq_epi16(smallest, pb), b, c)) };
+
+			const __m128i x{ _mm_add_epi8(load_pixel<BPP>(filtered + i), _mm_packus_epi16(predictor, predictor)) };
+			store_pixel<BPP>(current + i, x);
+
+			a = _mm_unpacklo_epi8(x, zero);
+			c = b;
+		}
+	}
+
+} // namespace
+
+
+void fill::detail::sse2_unfilter_kernels(UnfilterKernels& kernels, size_t bpp) noexcept
+{
+	kernels.up = up;
+
+	switch (bpp)
+	{
+	case 3:
+		kernels.sub = sub<3>;
+		kernels.average = average<3>;
+		kernels.paeth = paeth<3>;
+		break;
+
+	case 4:
+		kernels.sub = sub4;
+		kernels.average = average<4>;
+		kernels.paeth = paeth<4>;
+		break;
+	}
+}
+
+#endif
@@ -0,0 +1,135 @@
+#include "unfilter.hpp"
+
+#if defined(FILL_X86_SIMD)
+
+#include <cstring>
+
+#include <tmmintrin.h>
+
+// SSSE3 kernels
+// pshufb lets the 3 bytes per pixel Sub carry a pixel across a whole register, and pabsw shortens the Paeth predictor.
+
+namespace
+{
+
+	// 3 byte pixels are moved as 2 + 1 bytes: a 3 byte memcpy through a 4 byte local defeats store forwarding
+	template <size_t BPP>
+	__m128i load_pixel(const std::uint8_t* p) noexcept
+	{
+		std::uint32_t pixel{};
+
+		if constexpr (BPP == 4)
+			std::memcpy(&pixel, p, 4);
+		else
+		{
+			std::uint16_t low{};
+			std::memcpy(&low, p, 2);
+			pixel = low | static_cast<std::uint32_t>(p[2]) << 16;
+		}
+
+		return _mm_cvtsi32_si128(static_cast<int>(pixel));
+	}
+
+	template <size_t BPP>
+	void store_pixel(std::uint8_t* p, __m128i v) noexcept
+	{
+		const auto pixel{ static_cast<std::uint32_t>(_mm_cvtsi128_si32(v)) };
+
+		if constexpr (BPP == 4)
+			std::memcpy(p, &pixel, 4);
+		else
+		{
+			const auto low{ static_cast<std::uint16_t>(pixel) };
+			std::memcpy(p, &low, 2);
+			p[2] = static_cast<std::uint8_t>(pixel >> 16);
+		}
+	}
+
+
+	// Five pixels (15 bytes) per step: an in-register prefix sum, then the last pixel of the previous block is carried over.
+	// The 16th byte written belongs to the next block and is rewritten by it.
+	void sub3(const std::uint8_t* filtered, const std::uint8_t*, std::uint8_t* current, size_t width_bytes, size_t)
+	{
+		const __m128i broadcast_last{ _mm_setr_epi8(12, 13, 14, 12, 13, 14, 12, 13, 14, 12, 13, 14, 12, 13, 14, -1) };
+
+		__m128i carry{ _mm_setzero_si128() };
+		size_t i{};
+
+		for (; i + 16 <= width_bytes; i += 15)
+		{
+			__m128i x{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(filtered + i)) };
+
+			x = _mm_add_epi8(x, _mm_slli_si128(x, 3));
+			x = _mm_add_epi8(x, _mm_slli_si128(x, 6));
+			x = _mm_add_epi8(x, _mm_slli_si128(x, 12));
+			x = _mm_add_epi8(x, carry);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(current + i), x);
+
+			carry = _mm_shuffle_epi8(x, broadcast_last);
+		}
+
+		for (; i < width_bytes; i += 3)
+		{
+			carry = _mm_add_epi8(carry, load_pixel<3>(filtered + i));
+			store_pixel<3>(current + i, carry);
+		}
+	}
+
+	__m128i if_then_else(__m128i mask, __m128i then_value, __m128i else_value) noexcept
+	{
+		return _mm_or_si128(_mm_and_si128(mask, then_value), _mm_andnot_si128(mask, else_value));
+	}
+
+	// Same predictor as the SSE2 kernel, with pabsw instead of max(x, -x)
+	template <size_t BPP>
+	void paeth(const std::uint8_t* filtered, const std::uint8_t* prior, std::uint8_t* current, size_t width_bytes, size_t)
+	{
+		const __m128i zero{ _mm_setzero_si128() };
+
+		__m128i a{ zero }, c{ zero };
+
+		for (size_t i{}; i < width_bytes; i += BPP)
+		{
+			const __m128i b{ _mm_unpacklo_epi8(load_pixel<BPP>(prior + i), zero) };
+
+			const __m128i pa_signed{ _mm_sub_epi16(b, c) };
+			const __m128i pb_signed{ _mm_sub_epi16(a, c) };
+
+			const __m128i pa{ _mm_abs_epi16(pa_signed) };
+			const __m128i pb{ _mm_abs_epi16(pb_signed) };
+			const __m128i pc{ _mm_abs_epi16(_mm_add_epi16(pa_signed, pb_signed)) };
+
+			const __m128i smallest{ _mm_min_epi16(pc, _mm_min_epi16(pa, pb)) };
+
+			const __m128i predictor{
+				if_then_else(_mm_cmpeq_epi16(smallest, pa), a,
+				if_then_else(_mm_cmpeq_epi16(smallest, pb), b, c)) };
+
+			const __m128i x{ _mm_add_epi8(load_pixel<BPP>(filtered + i), _mm_packus_epi16(predictor, predictor)) };
+			store_pixel<BPP>(current + i, x);
+
+			a = _mm_unpacklo_epi8(x, zero);
+			c = b;
+		}
+	}
+
+} // namespace
+
+
+void fill::detail::ssse3_unfilter_kernels(UnfilterKernels& kernels, size_t bpp) noexcept
+{
+	switch (bpp)
+	{
+	case 3:
+		kernels.sub = sub3;
+		kernels.paeth = paeth<3>;
+		break;
+
+	case 4:
+		kernels.paeth = paeth<4>;
+		break;
+	}
+}
+
+#endif
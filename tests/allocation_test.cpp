@@ -0,0 +1,139 @@
+// FILL_test_allocations : a warmed up Decoder loading into an Image of the same size allocates nothing (see decoder.hpp).
+//
+// Replaces the global operator new, counting every call, and decodes the fixtures in tests/data with zlib and with the builtin inflater.
+// Not pipelined: the pipeline starts its threads per image.
+
+#include "image.hpp"
+#include "decoder.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <new>
+#include <string>
+#include <vector>
+
+#if !defined(TEST_DATA)
+#define TEST_DATA "tests/data/"
+#endif
+
+
+namespace
+{
+
+	size_t allocations{};
+
+	void* counted_alloc(std::size_t size, std::size_t alignment = alignof(std::max_align_t))
+	{
+		allocations++;
+
+		// aligned_alloc wants a multiple of the alignment
+		void* memory{ alignment > alignof(std::max_align_t) ? std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment) : std::malloc(size == 0 ? 1 : size) };
+
+		if (!memory)
+			throw std::bad_alloc{};
+
+		return memory;
+	}
+
+} // namespace
+
+
+void* operator new(std::size_t size) { return counted_alloc(size); }
+void* operator new[](std::size_t size) { return counted_alloc(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return counted_alloc(size, static_cast<std::size_t>(alignment)); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return counted_alloc(size, static_cast<std::size_t>(alignment)); }
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+
+
+namespace
+{
+
+	size_t failures{};
+
+	void check(bool condition, const std::string& what)
+	{
+		if (!condition)
+		{
+			failures++;
+			std::cout << "FAILED " << what << '\n';
+		}
+	}
+
+	std::vector<std::byte> read_file(const std::filesystem::path& path)
+	{
+		std::ifstream file{ path, std::ios::binary };
+		const std::vector<char> bytes{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+
+		std::vector<std::byte> file_bytes(bytes.size());
+		for (size_t i{}; i < bytes.size(); i++)
+			file_bytes[i] = static_cast<std::byte>(bytes[i]);
+
+		return file_bytes;
+	}
+
+
+	// Two loads warm the decoder and the image up, the ones after them must not allocate
+	void same_size_loads()
+	{
+		constexpr int warm_up{ 2 }, rounds{ 8 };
+
+		for (const char* name : { "idat_split.png", "idat_empty_first.png", "idat_empty_middle.png" })
+		{
+			const std::vector<std::byte> bytes{ read_file(std::filesystem::path{ TEST_DATA } / name) };
+
+			for (const fill::InflateBackend backend : { fill::InflateBackend::Zlib, fill::InflateBackend::Builtin })
+			{
+				const std::string what{ std::string{ name } + (backend == fill::InflateBackend::Zlib ? " (zlib)" : " (builtin)") };
+
+				try
+				{
+					fill::DecodeOptions options{};
+					options.inflater = backend;
+
+					fill::Decoder decoder{ options };
+					fill::Image image;
+
+					for (int i{}; i < warm_up; i++)
+						image.loadFromMemory(bytes, decoder);
+
+					const size_t before{ allocations };
+
+					for (int i{}; i < rounds; i++)
+						image.loadFromMemory(bytes, decoder);
+
+					const size_t allocated{ allocations - before };
+					check(allocated == 0, what + ": " + std::to_string(allocated) + " allocations over " + std::to_string(rounds) + " loads");
+				}
+				catch (const std::exception& error)
+				{
+					check(false, what + ": " + error.what());
+				}
+			}
+		}
+	}
+
+} // namespace
+
+
+int main()
+{
+	same_size_loads();
+
+	std::cout << (failures == 0 ? "All tests passed\n" : std::to_string(failures) + " failures\n");
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,64 @@
+// FILL_test_crc32 : the PCLMULQDQ CRC-32 kernel against zlib's crc32.
+//
+// Every length from 0 to 200 bytes (the folding loop's tails) and a few large ones, at unaligned offsets,
+// from no CRC and going on from a previous one, in one call and in two.
+
+#include "crc32.hpp"
+#include "simd.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "zlib.h"
+
+
+int main()
+{
+	if (!fill::detail::detect_clmul())
+	{
+		std::cout << "PCLMULQDQ: not supported here, skipped\n";
+		return 0;
+	}
+
+	std::mt19937 rng{ 2025 };
+	const fill::detail::Crc32Kernel kernel{ fill::detail::crc32_kernel(true) };
+
+	std::vector<size_t> lengths{};
+	for (size_t length{}; length <= 200; length++)
+		lengths.push_back(length);
+	for (const size_t length : { 255, 256, 257, 1000, 4096, 65536 + 13, (1 << 20) + 7 })
+		lengths.push_back(length);
+
+	std::vector<std::uint8_t> bytes(lengths.back() + 64);
+	for (std::uint8_t& byte : bytes)
+		byte = static_cast<std::uint8_t>(rng());
+
+	size_t checked{}, failed{};
+
+	for (const size_t length : lengths)
+	{
+		for (const size_t offset : { size_t{}, size_t{ 1 }, size_t{ 7 }, size_t{ 13 }, size_t{ 33 } })
+		{
+			const std::uint8_t* data{ bytes.data() + offset };
+			const std::uint32_t previous{ static_cast<std::uint32_t>(rng()) };
+
+			const auto expected{ [&](std::uint32_t crc) { return static_cast<std::uint32_t>(::crc32(crc, data, static_cast<uInt>(length))); } };
+			const size_t split{ length / 3 };
+
+			for (const std::uint32_t crc : { std::uint32_t{}, previous })
+			{
+				checked++;
+
+				if ((kernel(crc, data, length) != expected(crc) || kernel(kernel(crc, data, split), data + split, length - split) != expected(crc)) && failed++ < 20)
+					std::cout << "MISMATCH length " << length << " offset " << offset << (crc ? " (going on)" : "") << '\n';
+			}
+		}
+	}
+
+	std::cout << checked << " CRCs checked, " << failed << " mismatches\n";
+
+	return failed == 0 ? 0 : 1;
+}
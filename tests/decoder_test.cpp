@@ -0,0 +1,516 @@
+// FILL_test_decoder : decoding regressions, on the fixtures in tests/data.
+//
+// Every test decodes with zlib, with the builtin inflater and pipelined, and checks the pixels against what they should be.
+
+#include "image.hpp"
+#include "decoder.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if !defined(TEST_DATA)
+#define TEST_DATA "tests/data/"
+#endif
+
+
+namespace
+{
+
+	size_t failures{};
+
+	void check(bool condition, const std::string& what)
+	{
+		if (!condition)
+		{
+			failures++;
+			std::cout << "FAILED " << what << '\n';
+		}
+	}
+
+	// Each backend a decoder can use, the pipeline even for small images
+	fill::DecodeOptions backend_options(int backend)
+	{
+		fill::DecodeOptions options{};
+		options.inflater = backend == 1 ? fill::InflateBackend::Builtin : fill::InflateBackend::Zlib;
+		options.pipelined = backend == 2;
+		options.pipeline_min_bytes = 0;
+
+		return options;
+	}
+
+	constexpr const char* backend_names[3]{ "zlib", "builtin", "pipelined" };
+
+
+	// 61x47 RGB, its image data split over three IDATs, with an empty one before them or between the first two.
+	// Empty IDATs are valid, and must not read as the end of the data
+	void empty_idat()
+	{
+		for (const char* name : { "idat_split.png", "idat_empty_first.png", "idat_empty_middle.png" })
+		{
+			for (int backend{}; backend < 3; backend++)
+			{
+				const std::string what{ std::string{ name } + " (" + backend_names[backend] + ")" };
+
+				try
+				{
+					fill::Decoder decoder{ backend_options(backend) };
+					const fill::Image image{ decoder.decode(std::filesystem::path{ TEST_DATA } / name) };
+
+					check(image.getWidth() == 61 && image.getHeight() == 47 && image.getColorChannel() == 3, what + ": size");
+
+					bool same{ true };
+
+					for (std::uint32_t y{}; y < image.getHeight(); y++)
+					{
+						for (std::uint32_t x{}; x < image.getWidth(); x++)
+						{
+							const std::uint8_t* pixel{ image.row(y) + x * 3 };
+							same = same && pixel[0] == ((x * 5 + y * 3) & 255) && pixel[1] == ((x * y) & 255) && pixel[2] == ((x ^ y) & 255);
+						}
+					}
+
+					check(same, what + ": pixels");
+				}
+				catch (const std::exception& error)
+				{
+					check(false, what + ": " + error.what());
+				}
+			}
+		}
+	}
+
+
+
+	// --- Expansion of every colour type and bit depth
+
+	// The fixtures' samples, written by a script: periodic (11 x 7 pixels) so that tRNS keys match more than one pixel,
+	// each row filtered with filter type y % 5
+	struct Fixture
+	{
+		std::uint8_t color_type{}, bit_depth{};
+		bool trns{};
+
+		std::string name() const { return "ct" + std::to_string(color_type) + '_' + std::to_string(bit_depth) + (trns ? "_trns" : "") + ".png"; }
+	};
+
+	std::uint8_t file_channels(std::uint8_t color_type) noexcept
+	{
+		constexpr std::uint8_t channels[7]{ 1, 0, 3, 1, 2, 0, 4 };
+		return channels[color_type];
+	}
+
+	std::uint32_t palette_size(std::uint8_t bit_depth) noexcept
+	{
+		return bit_depth == 1 ? 2 : bit_depth == 2 ? 4 : bit_depth == 4 ? 13 : 200;
+	}
+
+	std::uint32_t file_sample(std::uint8_t color_type, std::uint8_t bit_depth, std::uint32_t x, std::uint32_t y, std::uint32_t c)
+	{
+		const std::uint32_t u{ x % 11 }, v{ y % 7 };
+
+		if (color_type == 3)
+			return (u * 5 + v * 3 + u * v) % palette_size(bit_depth);
+		if (bit_depth == 16)
+			return (u * 2311 + v * 4099 + c * 977 + u * v * 31) & 0xFFFF;
+
+		return (u * 23 + v * 41 + c * 67 + u * v * 5) & ((1u << bit_depth) - 1);
+	}
+
+	// Palette entries are RGB from i, the tRNS chunk gives every entry but the last one an alpha
+	std::array<std::uint32_t, 4> palette_entry(std::uint32_t i, std::uint32_t size, bool trns)
+	{
+		return { (i * 37 + 11) & 255, (i * 91 + 7) & 255, (i * 151 + 3) & 255, trns && i + 1 < size ? (i * 53 + 17) & 255 : 255 };
+	}
+
+	// Bytes of pixel (x, y) as the decoder should give them
+	std::vector<std::uint8_t> expected_pixel(const Fixture& fixture, fill::PixelFormat format, std::uint32_t x, std::uint32_t y)
+	{
+		std::vector<std::uint32_t> samples{};
+		std::uint32_t depth{ fixture.bit_depth };
+
+		if (fixture.color_type == 3)
+		{
+			const auto entry{ palette_entry(file_sample(3, depth, x, y, 0), palette_size(depth), fixture.trns) };
+			samples.assign(entry.begin(), entry.begin() + (fixture.trns || format == fill::PixelFormat::RGBA8 ? 4 : 3));
+			depth = 8;
+		}
+		else
+		{
+			bool key{ fixture.trns };
+
+			for (std::uint32_t c{}; c < file_channels(fixture.color_type); c++)
+			{
+				samples.push_back(file_sample(fixture.color_type, fixture.bit_depth, x, y, c));
+				key = key && samples.back() == file_sample(fixture.color_type, fixture.bit_depth, 3, 2, c); /*the key is pixel (3, 2)*/
+			}
+
+			if (depth < 8)
+			{
+				samples[0] = samples[0] * 255 / ((1u << depth) - 1);
+				depth = 8;
+			}
+
+			if (fixture.trns)
+				samples.push_back(key ? 0 : (depth == 16 ? 0xFFFF : 0xFF));
+
+			if (format == fill::PixelFormat::RGBA8)
+			{
+				if (depth == 16)
+					for (std::uint32_t& sample : samples)
+						sample >>= 8;
+
+				depth = 8;
+
+				if (samples.size() <= 2)
+					samples = { samples[0], samples[0], samples[0], samples.size() == 2 ? samples[1] : 255 };
+				else if (samples.size() == 3)
+					samples.push_back(255);
+			}
+		}
+
+		std::vector<std::uint8_t> bytes{};
+
+		for (const std::uint32_t sample : samples)
+		{
+			if (depth == 16)
+				bytes.push_back(static_cast<std::uint8_t>(sample >> 8));
+
+			bytes.push_back(static_cast<std::uint8_t>(sample));
+		}
+
+		return bytes;
+	}
+
+	// Format and pixels of image against expected_pixel
+	void check_pixels(const fill::Image& image, const Fixture& fixture, fill::PixelFormat format, std::uint32_t width, std::uint32_t height, const std::string& what)
+	{
+		const std::vector<std::uint8_t> first{ expected_pixel(fixture, format, 0, 0) };
+		const std::uint8_t depth{ static_cast<std::uint8_t>(format == fill::PixelFormat::Native && fixture.bit_depth == 16 ? 16 : 8) };
+
+		if (image.getWidth() != width || image.getHeight() != height || image.getBitDepth() != depth || image.getBytesPerPixel() != first.size())
+		{
+			check(false, what + ": format " + std::to_string(image.getWidth()) + 'x' + std::to_string(image.getHeight()) + ", " +
+				std::to_string(image.getColorChannel()) + " channels of " + std::to_string(image.getBitDepth()) + " bits");
+			return;
+		}
+
+		for (std::uint32_t y{}; y < height; y++)
+		{
+			for (std::uint32_t x{}; x < width; x++)
+			{
+				const std::vector<std::uint8_t> pixel{ expected_pixel(fixture, format, x, y) };
+
+				if (!std::equal(pixel.begin(), pixel.end(), image.row(y) + x * pixel.size()))
+				{
+					check(false, what + ": pixel (" + std::to_string(x) + ", " + std::to_string(y) + ')');
+					return;
+				}
+			}
+		}
+	}
+
+	constexpr Fixture fixtures[]{
+		{ 0, 1 }, { 0, 2 }, { 0, 4 }, { 0, 8 }, { 0, 16 }, { 0, 1, true }, { 0, 2, true }, { 0, 4, true }, { 0, 8, true }, { 0, 16, true },
+		{ 2, 8 }, { 2, 16 }, { 2, 8, true }, { 2, 16, true },
+		{ 3, 1 }, { 3, 2 }, { 3, 4 }, { 3, 8 }, { 3, 1, true }, { 3, 2, true }, { 3, 4, true }, { 3, 8, true },
+		{ 4, 8 }, { 4, 16 },
+		{ 6, 8 }, { 6, 16 }
+	};
+
+	// 37x11, every allowed colour type and bit depth pair, with and without tRNS, in both pixel formats
+	void expansion()
+	{
+		for (const Fixture& fixture : fixtures)
+		{
+			for (const fill::PixelFormat format : { fill::PixelFormat::Native, fill::PixelFormat::RGBA8 })
+			{
+				for (int backend{}; backend < 3; backend++)
+				{
+					const std::string what{ fixture.name() + (format == fill::PixelFormat::Native ? " Native (" : " RGBA8 (") + backend_names[backend] + ")" };
+
+					try
+					{
+						fill::DecodeOptions options{ backend_options(backend) };
+						options.format = format;
+
+						fill::Decoder decoder{ options };
+						check_pixels(decoder.decode(std::filesystem::path{ TEST_DATA } / fixture.name()), fixture, format, 37, 11, what);
+					}
+					catch (const std::exception& error)
+					{
+						check(false, what + ": " + error.what());
+					}
+				}
+			}
+		}
+	}
+
+
+
+	// --- Interlacing
+
+	// Rows of an image against a view of the same format, padding left out
+	bool same_pixels(const fill::ImageView& expected, const fill::Image& image)
+	{
+		if (expected.getWidth() != image.getWidth() || expected.getHeight() != image.getHeight() ||
+			expected.getColorChannel() != image.getColorChannel() || expected.getBitDepth() != image.getBitDepth())
+			return false;
+
+		const size_t row_bytes{ static_cast<size_t>(expected.getWidth()) * expected.getBytesPerPixel() };
+
+		for (std::uint32_t y{}; y < expected.getHeight(); y++)
+			if (!std::equal(expected.row(y), expected.row(y) + row_bytes, image.row(y)))
+				return false;
+
+		return true;
+	}
+
+	// Passes with at least one pixel, in order (see PNG spec, section 8.2)
+	std::vector<std::uint32_t> non_empty_passes(std::uint32_t width, std::uint32_t height)
+	{
+		constexpr std::uint32_t first_x[7]{ 0, 4, 0, 2, 0, 1, 0 }, first_y[7]{ 0, 0, 4, 0, 2, 0, 1 };
+
+		std::vector<std::uint32_t> passes{};
+		for (std::uint32_t pass{}; pass < 7; pass++)
+			if (first_x[pass] < width && first_y[pass] < height)
+				passes.push_back(pass + 1);
+
+		return passes;
+	}
+
+	// Adam7 images against the same pixels written without interlacing: under 8x8 (some passes empty), odd sizes, sub-byte depths.
+	// on_pass must be called once per non-empty pass
+	void interlacing()
+	{
+		struct Size
+		{
+			std::uint32_t width, height;
+		};
+
+		for (const Size size : { Size{ 1, 1 }, Size{ 3, 2 }, Size{ 5, 7 }, Size{ 37, 11 } })
+		{
+			for (const char* type : { "ct0_1", "ct3_2", "ct0_4", "ct2_8", "ct6_16" })
+			{
+				const std::string dimensions{ std::to_string(size.width) + 'x' + std::to_string(size.height) + '_' + type + ".png" };
+
+				for (const fill::PixelFormat format : { fill::PixelFormat::Native, fill::PixelFormat::RGBA8 })
+				{
+					for (int backend{}; backend < 3; backend++)
+					{
+						const std::string what{ "adam7_" + dimensions + (format == fill::PixelFormat::Native ? " Native (" : " RGBA8 (") + backend_names[backend] + ")" };
+
+						try
+						{
+							fill::DecodeOptions options{ backend_options(backend) };
+							options.format = format;
+
+							std::vector<std::uint32_t> passes{};
+							options.on_pass = [&](const fill::Image&, std::uint32_t pass) { passes.push_back(pass); };
+
+							fill::Decoder decoder{ options };
+							const fill::Image interlaced{ decoder.decode(std::filesystem::path{ TEST_DATA } / ("adam7_" + dimensions)) };
+							const fill::Image plain{ decoder.decode(std::filesystem::path{ TEST_DATA } / ("plain_" + dimensions)) };
+
+							check(same_pixels(interlaced, plain), what + ": pixels");
+							check(passes == non_empty_passes(size.width, size.height), what + ": " + std::to_string(passes.size()) + " on_pass calls");
+						}
+						catch (const std::exception& error)
+						{
+							check(false, what + ": " + error.what());
+						}
+					}
+				}
+			}
+		}
+	}
+
+
+
+	// --- Regions
+
+	std::vector<std::byte> read_file(const std::filesystem::path& path)
+	{
+		std::ifstream file{ path, std::ios::binary };
+		const std::vector<char> bytes{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+
+		std::vector<std::byte> file_bytes(bytes.size());
+		std::transform(bytes.begin(), bytes.end(), file_bytes.begin(), [](char byte) { return static_cast<std::byte>(byte); });
+
+		return file_bytes;
+	}
+
+	// loadRegion against a crop of the whole image, into rows padded to 64 bytes: regions inside the image, along its edges
+	// and partly outside it, of 8 bit, sub-byte and interlaced PNGs and of a PAM file
+	void regions()
+	{
+		struct Input
+		{
+			std::string name;
+			std::vector<std::byte> bytes;
+		};
+
+		std::vector<Input> inputs{};
+		for (const char* name : { "ct2_8.png", "ct0_1.png", "ct3_4_trns.png", "adam7_37x11_ct3_2.png", "adam7_37x11_ct6_16.png" })
+			inputs.push_back({ name, read_file(std::filesystem::path{ TEST_DATA } / name) });
+
+		{
+			fill::Decoder decoder{};
+			const fill::Image source{ decoder.decode(std::filesystem::path{ TEST_DATA } / "ct6_16.png") };
+			const std::vector<std::uint8_t> pam{ fill::Image::encodePNM(source) };
+
+			inputs.push_back({ "ct6_16.pam", std::vector<std::byte>(reinterpret_cast<const std::byte*>(pam.data()), reinterpret_cast<const std::byte*>(pam.data()) + pam.size()) });
+		}
+
+		constexpr fill::Rect rects[]{
+			{ 0, 0, 37, 11 }, { 5, 3, 9, 4 }, { 30, 6, 7, 5 } /*bottom right corner*/, { 36, 0, 1, 11 }, { 0, 10, 37, 1 },
+			{ 33, 8, 10, 10 } /*partly outside*/, { 0, 0, 100, 100 }
+		};
+
+		for (const Input& input : inputs)
+		{
+			for (const fill::PixelFormat format : { fill::PixelFormat::Native, fill::PixelFormat::RGBA8 })
+			{
+				for (int backend{}; backend < 3; backend++)
+				{
+					fill::DecodeOptions options{ backend_options(backend) };
+					options.format = format;
+
+					fill::Decoder full_decoder{ options };
+					options.layout.row_alignment = 64;
+					fill::Decoder decoder{ options };
+
+					for (const fill::Rect& rect : rects)
+					{
+						const std::string what{ input.name + " region " + std::to_string(rect.x) + ',' + std::to_string(rect.y) + ' ' + std::to_string(rect.width) + 'x' +
+							std::to_string(rect.height) + (format == fill::PixelFormat::Native ? " Native (" : " RGBA8 (") + backend_names[backend] + ")" };
+
+						try
+						{
+							fill::Image full{};
+							full.loadFromMemory(input.bytes, full_decoder);
+
+							fill::Image region{};
+							region.loadRegion(input.bytes, rect, decoder);
+
+							check(same_pixels(full.view().crop(rect), region), what + ": pixels");
+							check(region.getPitch() % 64 == 0, what + ": pitch " + std::to_string(region.getPitch()));
+						}
+						catch (const std::exception& error)
+						{
+							check(false, what + ": " + error.what());
+						}
+					}
+				}
+			}
+		}
+	}
+
+
+
+	// --- Chunk CRCs
+
+	// Offset of the data of the first chunk of type in a PNG file, and its length
+	std::pair<size_t, size_t> find_chunk(const std::vector<std::byte>& png, const char* type)
+	{
+		const auto byte{ [&](size_t i) { return static_cast<size_t>(std::to_integer<std::uint8_t>(png[i])); } };
+
+		for (size_t offset{ 8 }; offset + 12 <= png.size();)
+		{
+			const size_t length{ byte(offset) << 24 | byte(offset + 1) << 16 | byte(offset + 2) << 8 | byte(offset + 3) };
+
+			if (std::equal(type, type + 4, png.begin() + offset + 4, [](char a, std::byte b) { return a == static_cast<char>(b); }))
+				return { offset + 8, length };
+
+			offset += 12 + length;
+		}
+
+		return { 0, 0 };
+	}
+
+	// Corrupt IDAT data or CRC, or a corrupt CRC on an ancillary chunk (tRNS), under each CrcCheck mode:
+	// checked chunks throw, the others are decoded as if nothing were wrong
+	void chunk_crcs()
+	{
+		const Fixture fixture{ 2, 8, true };
+		const std::vector<std::byte> png{ read_file(std::filesystem::path{ TEST_DATA } / fixture.name()) };
+
+		const auto [idat, idat_length] { find_chunk(png, "IDAT") };
+		const auto [trns, trns_length] { find_chunk(png, "tRNS") };
+
+		struct Corruption
+		{
+			const char* name;
+			size_t offset;
+			bool critical;
+			bool harmless; /*pixels are unaffected*/
+		};
+
+		const Corruption corruptions[]{
+			{ "IDAT data", idat + idat_length / 2, true, false },
+			{ "IDAT CRC", idat + idat_length, true, true },
+			{ "tRNS CRC", trns + trns_length + 3, false, true }
+		};
+
+		for (const Corruption& corruption : corruptions)
+		{
+			std::vector<std::byte> corrupt{ png };
+			corrupt[corruption.offset] ^= std::byte{ 0x10 };
+
+			for (const fill::CrcCheck mode : { fill::CrcCheck::All, fill::CrcCheck::Critical, fill::CrcCheck::None })
+			{
+				const bool checked{ mode == fill::CrcCheck::All || (mode == fill::CrcCheck::Critical && corruption.critical) };
+
+				for (int backend{}; backend < 3; backend++)
+				{
+					constexpr const char* mode_names[3]{ "All", "Critical", "None" };
+					const std::string what{ std::string{ corruption.name } + " corrupt, CrcCheck::" + mode_names[static_cast<int>(mode)] + " (" + backend_names[backend] + ")" };
+
+					fill::DecodeOptions options{ backend_options(backend) };
+					options.crc_check = mode;
+
+					try
+					{
+						fill::Decoder decoder{ options };
+						const fill::Image image{ decoder.decode(corrupt) };
+
+						check(!checked, what + ": no error");
+
+						if (corruption.harmless)
+							check_pixels(image, fixture, fill::PixelFormat::Native, 37, 11, what);
+					}
+					catch (const std::exception& error)
+					{
+						// Unchecked corrupt data may still fail to inflate, but never on its CRC
+						const bool crc_error{ std::string{ error.what() }.find("CRC") != std::string::npos };
+						check(checked ? crc_error : !crc_error && !corruption.harmless, what + ": " + error.what());
+					}
+				}
+			}
+		}
+	}
+
+} // namespace
+
+
+int main()
+{
+	empty_idat();
+	expansion();
+	interlacing();
+	regions();
+	chunk_crcs();
+
+	std::cout << (failures == 0 ? "All tests passed\n" : std::to_string(failures) + " failures\n");
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,131 @@
+// FILL_test_encode : images saved to PNG load back as the very same pixels.
+//
+// 1 to 4 channels of 8 and 16 bits, adaptive filtering and each filter on its own, at compression levels 0, 1, 6 and 9,
+// on the calling thread and on a pool cutting the data into several strips, whole images and (at level 1) a crop of one.
+
+#include "image.hpp"
+#include "decoder.hpp"
+#include "encode.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+
+	size_t failures{};
+
+	void check(bool condition, const std::string& what)
+	{
+		if (!condition)
+		{
+			failures++;
+			std::cout << "FAILED " << what << '\n';
+		}
+	}
+
+	// Gradients with noise, so that every filter has something to predict and none of them wins every row
+	fill::Image make_image(std::uint32_t width, std::uint32_t height, std::uint8_t channels, std::uint8_t bit_depth, std::mt19937& rng)
+	{
+		fill::Image image{ width, height, channels, bit_depth };
+		const size_t row_bytes{ static_cast<size_t>(width) * image.getBytesPerPixel() };
+
+		for (std::uint32_t y{}; y < height; y++)
+			for (size_t i{}; i < row_bytes; i++)
+				image.row(y)[i] = static_cast<std::uint8_t>(i / image.getBytesPerPixel() + y * 3 + (y % 4 == 0 ? rng() % 64 : rng() % 4));
+
+		return image;
+	}
+
+	bool same_pixels(const fill::ImageView& expected, const fill::Image& image)
+	{
+		if (expected.getWidth() != image.getWidth() || expected.getHeight() != image.getHeight() ||
+			expected.getColorChannel() != image.getColorChannel() || expected.getBitDepth() != image.getBitDepth())
+			return false;
+
+		const size_t row_bytes{ static_cast<size_t>(expected.getWidth()) * expected.getBytesPerPixel() };
+
+		for (std::uint32_t y{}; y < expected.getHeight(); y++)
+			if (!std::equal(expected.row(y), expected.row(y) + row_bytes, image.row(y)))
+				return false;
+
+		return true;
+	}
+
+	std::string filter_name(fill::EncodeOptions::Filter filter)
+	{
+		constexpr const char* names[6]{ "Adaptive", "None", "Sub", "Up", "Average", "Paeth" };
+		return names[static_cast<int>(filter) + 1];
+	}
+
+	// Encoded, decoded and compared with source
+	void round_trip(const fill::ImageView& source, const fill::EncodeOptions& options, fill::Decoder& decoder, const std::string& what)
+	{
+		try
+		{
+			const std::vector<std::uint8_t> png{ fill::Image::encodePNG(source, options) };
+			check(same_pixels(source, decoder.decode(std::as_bytes(std::span{ png }))), what);
+		}
+		catch (const std::exception& error)
+		{
+			check(false, what + ": " + error.what());
+		}
+	}
+
+} // namespace
+
+
+int main()
+{
+	using Filter = fill::EncodeOptions::Filter;
+
+	std::mt19937 rng{ 2025 };
+	fill::ThreadPool pool{ 4 };
+	fill::Decoder decoder{};
+
+	for (const std::uint8_t bit_depth : { 8, 16 })
+	{
+		for (std::uint8_t channels{ 1 }; channels <= 4; channels++)
+		{
+			// Over 64KB of filtered rows even at 1 byte per pixel: the pool's 32KB strips (their minimum) cut at least 3
+			const fill::Image image{ make_image(331, 211, channels, bit_depth, rng) };
+			const fill::ImageView crop{ image.view().crop(fill::Rect{ 7, 5, 300, 190 }) };
+
+			for (const Filter filter : { Filter::Adaptive, Filter::None, Filter::Sub, Filter::Up, Filter::Average, Filter::Paeth })
+			{
+				for (const int level : { 0, 1, 6, 9 })
+				{
+					for (const bool threaded : { false, true })
+					{
+						fill::EncodeOptions options{};
+						options.filter = filter;
+						options.compression_level = level;
+						options.strip_bytes = 32 * 1024;
+						options.pool = threaded ? &pool : nullptr;
+
+						const std::string what{ std::to_string(channels) + "x" + std::to_string(bit_depth) + " bits, " + filter_name(filter) + ", level " +
+							std::to_string(level) + (threaded ? ", pool" : "") };
+
+						round_trip(image, options, decoder, what);
+
+						if (level == 1) /*rows of a crop only differ in where they start*/
+							round_trip(crop, options, decoder, what + ", cropped");
+					}
+				}
+			}
+		}
+	}
+
+	std::cout << (failures == 0 ? "All tests passed\n" : std::to_string(failures) + " failures\n");
+
+	return failures == 0 ? 0 : 1;
+}
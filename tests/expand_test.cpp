@@ -0,0 +1,117 @@
+// FILL_test_expand : the SIMD expansion kernels against the scalar ones, byte for byte.
+//
+// Palette gathers (AVX2) on random indices into a full 256 entry palette, 16 to 8 bit narrowing (AVX2) and channel
+// conversions (SSSE3), on lengths that are and aren't multiples of the vector widths, at any offset.
+
+#include "convert.hpp"
+#include "expand.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+int main()
+{
+	using fill::detail::SimdLevel;
+
+	std::mt19937 rng{ 2025 };
+	const SimdLevel supported{ fill::detail::detect_simd_level() };
+
+	std::vector<size_t> lengths{};
+	for (size_t length{ 1 }; length <= 80; length++)
+		lengths.push_back(length);
+	for (const size_t length : { 127, 128, 129, 255, 256, 257, 1000, 1023, 4099 })
+		lengths.push_back(length);
+
+	size_t checked{}, failed{};
+
+	const auto compare{ [&](const std::vector<std::uint8_t>& current, const std::vector<std::uint8_t>& expected, const char* kernel, size_t length)
+	{
+		checked++;
+
+		if (current != expected && failed++ < 20)
+			std::cout << "MISMATCH " << kernel << " length " << length << '\n';
+	} };
+
+	if (supported < SimdLevel::AVX2)
+		std::cout << "AVX2: not supported here, gather and narrow skipped\n";
+	else
+	{
+		const fill::detail::ExpandKernels reference{ fill::detail::expand_kernels(SimdLevel::Scalar) };
+		const fill::detail::ExpandKernels kernels{ fill::detail::expand_kernels(SimdLevel::AVX2) };
+
+		std::array<std::uint32_t, 256> palette{};
+		for (std::uint32_t& entry : palette)
+			entry = static_cast<std::uint32_t>(rng());
+
+		for (const size_t pixels : lengths)
+		{
+			const size_t offset{ rng() % 32 };
+
+			std::vector<std::uint8_t> indices(pixels + offset);
+			for (std::uint8_t& index : indices)
+				index = static_cast<std::uint8_t>(rng());
+
+			std::vector<std::uint8_t> expected(pixels * 4 + offset), current(pixels * 4 + offset);
+
+			reference.gather(indices.data() + offset, expected.data() + offset, pixels, palette.data());
+			kernels.gather(indices.data() + offset, current.data() + offset, pixels, palette.data());
+			compare(current, expected, "gather", pixels);
+		}
+
+		for (const size_t samples : lengths)
+		{
+			const size_t offset{ rng() % 32 };
+
+			std::vector<std::uint8_t> wide(samples * 2 + offset);
+			for (std::uint8_t& byte : wide)
+				byte = static_cast<std::uint8_t>(rng());
+
+			std::vector<std::uint8_t> expected(samples + offset), current(samples + offset);
+
+			reference.narrow(wide.data() + offset, expected.data() + offset, samples);
+			kernels.narrow(wide.data() + offset, current.data() + offset, samples);
+			compare(current, expected, "narrow", samples);
+		}
+	}
+
+	if (supported < SimdLevel::SSSE3)
+		std::cout << "SSSE3: not supported here, conversions skipped\n";
+	else
+	{
+		for (std::uint8_t from{ 1 }; from <= 4; from++)
+		{
+			for (std::uint8_t to{ 1 }; to <= 4; to++)
+			{
+				const fill::detail::ConvertKernel reference{ fill::detail::convert_kernel(SimdLevel::Scalar, from, to) };
+				const fill::detail::ConvertKernel kernel{ fill::detail::convert_kernel(SimdLevel::SSSE3, from, to) };
+
+				if (!reference || !kernel)
+					continue;
+
+				for (const size_t pixels : lengths)
+				{
+					const size_t offset{ rng() % 32 };
+
+					std::vector<std::uint8_t> source(pixels * from + offset);
+					for (std::uint8_t& byte : source)
+						byte = static_cast<std::uint8_t>(rng());
+
+					std::vector<std::uint8_t> expected(pixels * to + offset), current(pixels * to + offset);
+
+					reference(source.data() + offset, expected.data() + offset, pixels);
+					kernel(source.data() + offset, current.data() + offset, pixels);
+					compare(current, expected, "convert", pixels);
+				}
+			}
+		}
+	}
+
+	std::cout << checked << " rows checked, " << failed << " mismatches\n";
+
+	return failed == 0 ? 0 : 1;
+}
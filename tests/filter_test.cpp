@@ -0,0 +1,72 @@
+// FILL_test_filter : the SIMD filtering kernels against the scalar ones, byte for byte and cost for cost.
+//
+// Every filter type and every pixel size from 1 to 8 bytes, on random rows: lengths that are and aren't multiples
+// of the vector width, rows starting at any offset.
+
+#include "filter.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+int main()
+{
+	using fill::detail::SimdLevel;
+
+	std::mt19937 rng{ 2025 };
+
+	if (fill::detail::detect_simd_level() < SimdLevel::AVX2)
+	{
+		std::cout << "AVX2: not supported here, skipped\n";
+		return 0;
+	}
+
+	// Pixels, not bytes
+	std::vector<size_t> widths{};
+	for (size_t width{ 1 }; width <= 80; width++)
+		widths.push_back(width);
+	for (const size_t width : { 127, 128, 129, 255, 256, 257, 1000, 1023, 4099 })
+		widths.push_back(width);
+
+	const fill::detail::FilterKernels reference{ fill::detail::filter_kernels(SimdLevel::Scalar) };
+	const fill::detail::FilterKernels kernels{ fill::detail::filter_kernels(SimdLevel::AVX2) };
+
+	size_t checked{}, failed{};
+
+	for (size_t bpp{ 1 }; bpp <= 8; bpp++)
+	{
+		for (const size_t width : widths)
+		{
+			const size_t width_bytes{ width * bpp };
+			const size_t offset{ rng() % 32 };
+
+			std::vector<std::uint8_t> row(width_bytes + offset), prior(width_bytes + offset);
+			std::vector<std::uint8_t> expected(width_bytes + offset), current(width_bytes + offset);
+
+			// Smooth rows, as images mostly are, with noise: costs stay small enough to tell filters apart
+			for (size_t i{ offset }; i < row.size(); i++)
+			{
+				row[i] = static_cast<std::uint8_t>(i / bpp + rng() % 16);
+				prior[i] = static_cast<std::uint8_t>(row[i] + rng() % 8);
+			}
+
+			for (std::uint8_t filter{}; filter <= 4; filter++)
+			{
+				const std::uint64_t expected_cost{ reference[filter](row.data() + offset, prior.data() + offset, expected.data() + offset, width_bytes, bpp) };
+				const std::uint64_t cost{ kernels[filter](row.data() + offset, prior.data() + offset, current.data() + offset, width_bytes, bpp) };
+
+				checked++;
+
+				if ((current != expected || cost != expected_cost) && failed++ < 20)
+					std::cout << "MISMATCH AVX2 filter " << int{ filter } << " bpp " << bpp << " width " << width << (cost != expected_cost ? " (cost)" : "") << '\n';
+			}
+		}
+	}
+
+	std::cout << checked << " rows checked, " << failed << " mismatches\n";
+
+	return failed == 0 ? 0 : 1;
+}
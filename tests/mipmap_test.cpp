@@ -0,0 +1,188 @@
+// FILL_test_mipmap : the 2x2 box reduction and box filtered mip chains against a naive rounded average.
+//
+// The AVX2 kernel against the scalar one at any width and offset, then whole chains (level table and pixels) of 1 to 4
+// channels, 1 pixel wide or high, odd and not multiples of the 64 pixel tiles, on the calling thread and on a pool.
+
+#include "image.hpp"
+#include "mipmap.hpp"
+#include "reduce.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+
+	size_t failures{};
+
+	void check(bool condition, const std::string& what)
+	{
+		if (!condition && failures++ < 20)
+			std::cout << "FAILED " << what << '\n';
+	}
+
+	// Rounded average of the 2x2 block, a side of 1 pixel reusing its only row or column
+	std::vector<std::uint8_t> naive_reduce(const std::uint8_t* source, std::uint32_t width, std::uint32_t height, size_t pitch, std::uint32_t new_width, std::uint32_t new_height, size_t bpp)
+	{
+		std::vector<std::uint8_t> reduced(static_cast<size_t>(new_width) * new_height * bpp);
+
+		for (std::uint32_t y{}; y < new_height; y++)
+		{
+			const std::uint8_t* top{ source + std::min(2 * y, height - 1) * pitch };
+			const std::uint8_t* bottom{ source + std::min(2 * y + 1, height - 1) * pitch };
+
+			for (std::uint32_t x{}; x < new_width; x++)
+			{
+				const size_t left{ std::min(2 * x, width - 1) * bpp };
+				const size_t right{ std::min(2 * x + 1, width - 1) * bpp };
+
+				for (size_t c{}; c < bpp; c++)
+					reduced[(static_cast<size_t>(y) * new_width + x) * bpp + c] = static_cast<std::uint8_t>((top[left + c] + top[right + c] + bottom[left + c] + bottom[right + c] + 2) / 4);
+			}
+		}
+
+		return reduced;
+	}
+
+	void kernels(std::mt19937& rng)
+	{
+		using fill::detail::SimdLevel;
+
+		if (fill::detail::detect_simd_level() < SimdLevel::AVX2)
+		{
+			std::cout << "AVX2: not supported here, kernels skipped\n";
+			return;
+		}
+
+		std::vector<size_t> widths{};
+		for (size_t width{ 1 }; width <= 80; width++)
+			widths.push_back(width);
+		for (const size_t width : { 127, 128, 129, 255, 256, 257, 1000, 1023, 4099 })
+			widths.push_back(width);
+
+		size_t checked{};
+
+		for (size_t bpp{ 1 }; bpp <= 4; bpp++)
+		{
+			const fill::detail::ReduceKernel reference{ fill::detail::reduce_kernel(SimdLevel::Scalar, bpp) };
+			const fill::detail::ReduceKernel kernel{ fill::detail::reduce_kernel(SimdLevel::AVX2, bpp) };
+
+			for (const size_t width : widths)
+			{
+				const size_t offset{ rng() % 32 };
+				const size_t source_bytes{ 2 * width * bpp };
+
+				std::vector<std::uint8_t> source(2 * source_bytes + offset);
+				for (std::uint8_t& byte : source)
+					byte = static_cast<std::uint8_t>(rng());
+
+				const std::uint8_t* top{ source.data() + offset };
+				const std::uint8_t* bottom{ top + source_bytes };
+
+				std::vector<std::uint8_t> expected(width * bpp + offset), current(width * bpp + offset);
+
+				reference(top, bottom, expected.data() + offset, width, bpp);
+				kernel(top, bottom, current.data() + offset, width, bpp);
+
+				const std::vector<std::uint8_t> naive{ naive_reduce(top, static_cast<std::uint32_t>(2 * width), 2, source_bytes, static_cast<std::uint32_t>(width), 1, bpp) };
+
+				checked++;
+				check(current == expected, "AVX2 kernel, bpp " + std::to_string(bpp) + ", width " + std::to_string(width));
+				check(std::equal(naive.begin(), naive.end(), expected.begin() + offset), "scalar kernel, bpp " + std::to_string(bpp) + ", width " + std::to_string(width));
+			}
+		}
+
+		std::cout << checked << " rows checked\n";
+	}
+
+	void chains(std::mt19937& rng)
+	{
+		struct Size
+		{
+			std::uint32_t width, height;
+		};
+
+		constexpr Size sizes[]{
+			{ 1, 1 }, { 1, 37 }, { 37, 1 }, { 1, 300 }, { 300, 1 }, { 2, 3 }, { 64, 64 }, { 63, 65 }, { 129, 97 }, { 200, 131 }, { 333, 70 }, { 257, 3 }, { 5, 190 }
+		};
+
+		fill::ThreadPool pool{ 4 };
+
+		for (std::uint8_t channels{ 1 }; channels <= 4; channels++)
+		{
+			for (const Size size : sizes)
+			{
+				fill::Image image{ size.width, size.height, channels };
+				for (std::uint32_t y{}; y < size.height; y++)
+					for (size_t i{}; i < static_cast<size_t>(size.width) * channels; i++)
+						image.row(y)[i] = static_cast<std::uint8_t>(rng());
+
+				for (fill::ThreadPool* threads : { static_cast<fill::ThreadPool*>(nullptr), &pool })
+				{
+					fill::MipmapOptions options{};
+					options.pool = threads;
+
+					const fill::Mipmaps mipmaps{ image.generateMipmaps(options) };
+					const std::string what{ std::to_string(size.width) + 'x' + std::to_string(size.height) + ", " + std::to_string(channels) + " channels" + (threads ? ", pool" : "") };
+
+					// Level table: halved (rounding down, never under 1) down to 1x1, packed one after the other
+					size_t levels{ 1 }, offset{};
+					for (std::uint32_t side{ std::max(size.width, size.height) }; side > 1; side /= 2)
+						levels++;
+
+					check(mipmaps.levels.size() == levels && mipmaps.bpp == channels && mipmaps.color_channel == channels, what + ": level count");
+					if (mipmaps.levels.size() != levels)
+						continue;
+
+					for (size_t n{}; n < levels; n++)
+					{
+						const fill::MipLevel& level{ mipmaps.levels[n] };
+						const std::uint32_t width{ std::max(size.width >> n, 1u) }, height{ std::max(size.height >> n, 1u) };
+
+						check(level.width == width && level.height == height && level.offset == offset && level.size == static_cast<size_t>(width) * height * channels,
+							what + ": level " + std::to_string(n) + " table");
+						offset += static_cast<size_t>(width) * height * channels;
+					}
+					check(mipmaps.data.size() == offset, what + ": data size");
+
+					// Pixels: level 0 is the image, each level the naive reduction of the one above
+					bool same{ true };
+					for (std::uint32_t y{}; y < size.height; y++)
+						same = same && std::equal(image.row(y), image.row(y) + static_cast<size_t>(size.width) * channels, mipmaps.level(0).data() + static_cast<size_t>(y) * size.width * channels);
+					check(same, what + ": level 0");
+
+					for (size_t n{ 1 }; n < levels; n++)
+					{
+						const fill::MipLevel& above{ mipmaps.levels[n - 1] };
+						const fill::MipLevel& level{ mipmaps.levels[n] };
+
+						const std::vector<std::uint8_t> expected{ naive_reduce(mipmaps.level(n - 1).data(), above.width, above.height, static_cast<size_t>(above.width) * channels, level.width, level.height, channels) };
+
+						check(std::equal(expected.begin(), expected.end(), mipmaps.level(n).begin(), mipmaps.level(n).end()), what + ": level " + std::to_string(n) + " pixels");
+					}
+				}
+			}
+		}
+	}
+
+} // namespace
+
+
+int main()
+{
+	std::mt19937 rng{ 2025 };
+
+	kernels(rng);
+	chains(rng);
+
+	std::cout << (failures == 0 ? "All tests passed\n" : std::to_string(failures) + " failures\n");
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,171 @@
+// FILL_test_resample : the SIMD resampling kernels against the scalar ones, byte for byte, and Image::resize on flat images.
+//
+// Every filter with weights, upscaling and downscaling by whole and odd ratios (tap counts that are and aren't multiples
+// of 4), 3 and 4 byte pixels horizontally and rows of any length vertically. A constant image must stay constant.
+
+#include "resample.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+
+	const char* filter_name(fill::ResizeFilter filter) noexcept
+	{
+		switch (filter)
+		{
+		case fill::ResizeFilter::Nearest: return "Nearest";
+		case fill::ResizeFilter::Bilinear: return "Bilinear";
+		case fill::ResizeFilter::Box: return "Box";
+		case fill::ResizeFilter::Lanczos3: return "Lanczos3";
+		default: return "Kaiser";
+		}
+	}
+
+	struct Scale
+	{
+		std::uint32_t from, to;
+	};
+
+	constexpr Scale scales[]{
+		{ 37, 100 }, { 100, 37 }, { 64, 16 }, { 16, 64 }, { 1000, 333 }, { 333, 1000 }, { 5, 3 }, { 3, 5 }, { 250, 7 }, { 7, 250 }, { 129, 128 }, { 1, 9 }, { 9, 1 }
+	};
+
+	constexpr fill::ResizeFilter weighted_filters[]{ fill::ResizeFilter::Bilinear, fill::ResizeFilter::Box, fill::ResizeFilter::Lanczos3, fill::ResizeFilter::Kaiser };
+
+	size_t failures{};
+
+	void check(bool condition, const std::string& what)
+	{
+		if (!condition && failures++ < 20)
+			std::cout << "FAILED " << what << '\n';
+	}
+
+	void kernels(std::mt19937& rng)
+	{
+		using fill::detail::SimdLevel;
+
+		if (fill::detail::detect_simd_level() < SimdLevel::AVX2)
+		{
+			std::cout << "AVX2: not supported here, kernels skipped\n";
+			return;
+		}
+
+		size_t checked{};
+
+		for (const fill::ResizeFilter filter : weighted_filters)
+		{
+			for (const Scale scale : scales)
+			{
+				const fill::detail::ResampleWeights weights{ fill::detail::resample_weights(scale.from, scale.to, filter) };
+				const std::string what{ std::string{ filter_name(filter) } + ' ' + std::to_string(scale.from) + " to " + std::to_string(scale.to) };
+
+				// Horizontal: one row of from pixels to to pixels
+				for (const size_t bpp : { 3, 4 })
+				{
+					const fill::detail::ResampleKernels reference{ fill::detail::resample_kernels(SimdLevel::Scalar, bpp) };
+					const fill::detail::ResampleKernels simd{ fill::detail::resample_kernels(SimdLevel::AVX2, bpp) };
+
+					std::vector<std::uint8_t> source(scale.from * bpp);
+					for (std::uint8_t& byte : source)
+						byte = static_cast<std::uint8_t>(rng());
+
+					std::vector<std::uint8_t> expected(scale.to * bpp), current(scale.to * bpp);
+
+					reference.horizontal(source.data(), expected.data(), scale.from, weights, bpp);
+					simd.horizontal(source.data(), current.data(), scale.from, weights, bpp);
+
+					checked++;
+					check(current == expected, what + " horizontal, bpp " + std::to_string(bpp));
+				}
+
+				// Vertical: from rows to to rows, of lengths around the vector width
+				const fill::detail::ResampleKernels reference{ fill::detail::resample_kernels(SimdLevel::Scalar, 4) };
+				const fill::detail::ResampleKernels simd{ fill::detail::resample_kernels(SimdLevel::AVX2, 4) };
+
+				for (const size_t width_bytes : { 1, 31, 32, 33, 100, 257 })
+				{
+					const size_t pitch{ width_bytes + rng() % 8 };
+
+					std::vector<std::uint8_t> source(pitch * scale.from);
+					for (std::uint8_t& byte : source)
+						byte = static_cast<std::uint8_t>(rng());
+
+					std::vector<std::uint8_t> expected(width_bytes), current(width_bytes);
+					bool same{ true };
+
+					for (size_t i{}; i < scale.to; i++)
+					{
+						const std::uint8_t* first{ source.data() + weights.first[i] * pitch };
+						const std::int16_t* row_weights{ weights.weights.data() + i * weights.stride };
+
+						reference.vertical(first, pitch, row_weights, weights.taps[i], expected.data(), width_bytes);
+						simd.vertical(first, pitch, row_weights, weights.taps[i], current.data(), width_bytes);
+
+						same = same && current == expected;
+					}
+
+					checked++;
+					check(same, what + " vertical, " + std::to_string(width_bytes) + " bytes");
+				}
+			}
+		}
+
+		std::cout << checked << " kernel runs checked\n";
+	}
+
+	// Weights sum to one: a flat image comes out flat, whatever the filter, size, pixel size or threading
+	void flat_images()
+	{
+		fill::ThreadPool pool{ 4 };
+
+		for (std::uint8_t channels{ 1 }; channels <= 4; channels++)
+		{
+			fill::Image image{ 53, 29, channels };
+			for (std::uint32_t y{}; y < image.getHeight(); y++)
+				for (size_t i{}; i < static_cast<size_t>(image.getWidth()) * channels; i++)
+					image.row(y)[i] = static_cast<std::uint8_t>(40 + 50 * (i % channels)); /*one colour*/
+
+			for (const fill::ResizeFilter filter : { fill::ResizeFilter::Nearest, fill::ResizeFilter::Bilinear, fill::ResizeFilter::Box, fill::ResizeFilter::Lanczos3, fill::ResizeFilter::Kaiser })
+			{
+				for (const Scale scale : { Scale{ 53, 211 }, Scale{ 53, 17 }, Scale{ 53, 1 }, Scale{ 53, 53 } })
+				{
+					for (fill::ThreadPool* threads : { static_cast<fill::ThreadPool*>(nullptr), &pool })
+					{
+						const fill::Image resized{ image.resize(scale.to, scale.to / 2 + 1, filter, threads) };
+						bool flat{ resized.getColorChannel() == channels };
+
+						for (std::uint32_t y{}; y < resized.getHeight() && flat; y++)
+							for (size_t i{}; i < static_cast<size_t>(resized.getWidth()) * channels; i++)
+								flat = flat && resized.row(y)[i] == 40 + 50 * (i % channels);
+
+						check(flat, std::string{ filter_name(filter) } + ' ' + std::to_string(channels) + " channels to " + std::to_string(scale.to) + 'x' +
+							std::to_string(scale.to / 2 + 1) + (threads ? ", pool" : ""));
+					}
+				}
+			}
+		}
+	}
+
+} // namespace
+
+
+int main()
+{
+	std::mt19937 rng{ 2025 };
+
+	kernels(rng);
+	flat_images();
+
+	std::cout << (failures == 0 ? "All tests passed\n" : std::to_string(failures) + " failures\n");
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,124 @@
+// FILL_test_thread_pool : waiting on tasks from inside the pool, and exceptions thrown by tasks.
+//
+// Pools of one and two workers, whose every worker waits on tasks of its own, deadlocked before the caller took part in them.
+
+#include "parallel.hpp"
+#include "thread_pool.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+
+namespace
+{
+
+	size_t failures{};
+
+	void check(bool condition, const std::string& what)
+	{
+		if (!condition)
+		{
+			failures++;
+			std::cout << "FAILED " << what << '\n';
+		}
+	}
+
+
+	// Bands split in bands, from the workers of small pools
+	void nested_bands()
+	{
+		for (const unsigned threads : { 1u, 2u })
+		{
+			fill::ThreadPool pool{ threads };
+			std::atomic<size_t> rows{};
+
+			fill::detail::for_each_band(&pool, 64, 1, [&](size_t begin, size_t end)
+			{
+				fill::detail::for_each_band(&pool, (end - begin) * 64, 1, [&](size_t inner_begin, size_t inner_end)
+				{
+					rows += inner_end - inner_begin;
+				});
+			});
+
+			check(rows == 64 * 64, std::to_string(threads) + " workers: " + std::to_string(rows) + " of " + std::to_string(64 * 64) + " rows");
+
+			// Submitted tasks waiting on bands, while the caller waits on the pool
+			std::atomic<size_t> tasks{};
+
+			for (int i{}; i < 8; i++)
+			{
+				pool.submit([&]()
+				{
+					fill::detail::for_each_band(&pool, 16, 1, [&](size_t begin, size_t end) { tasks += end - begin; });
+				});
+			}
+
+			pool.wait();
+			check(tasks == 8 * 16, std::to_string(threads) + " workers: " + std::to_string(tasks) + " of " + std::to_string(8 * 16) + " submitted rows");
+		}
+	}
+
+	// Rethrown to whoever waits, once every other task has finished
+	void exceptions()
+	{
+		fill::ThreadPool pool{ 4 };
+		std::atomic<size_t> ran{};
+
+		try
+		{
+			fill::detail::for_each_task(pool, 32, [&](size_t task)
+			{
+				ran++;
+
+				if (task == 5)
+					throw std::runtime_error("band");
+			});
+
+			check(false, "for_each_task: nothing thrown");
+		}
+		catch (const std::runtime_error& error)
+		{
+			check(std::string{ error.what() } == "band", std::string{ "for_each_task: threw " } + error.what());
+		}
+
+		check(ran == 32, "for_each_task: " + std::to_string(ran) + " of 32 tasks ran");
+
+		pool.submit([]() { throw std::runtime_error("task"); });
+		pool.submit([]() {});
+
+		try
+		{
+			pool.wait();
+			check(false, "wait: nothing thrown");
+		}
+		catch (const std::runtime_error& error)
+		{
+			check(std::string{ error.what() } == "task", std::string{ "wait: threw " } + error.what());
+		}
+
+		// Rethrown once
+		try
+		{
+			pool.wait();
+		}
+		catch (const std::exception& error)
+		{
+			check(false, std::string{ "wait: threw again: " } + error.what());
+		}
+	}
+
+} // namespace
+
+
+int main()
+{
+	nested_bands();
+	exceptions();
+
+	std::cout << (failures == 0 ? "All tests passed\n" : std::to_string(failures) + " failures\n");
+
+	return failures == 0 ? 0 : 1;
+}
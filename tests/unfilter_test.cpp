@@ -0,0 +1,102 @@
+// FILL_test_unfilter : the SIMD unfiltering kernels against the scalar ones, byte for byte.
+//
+// Every instruction set the machine supports, every filter type and every pixel size from 1 to 8 bytes, on random rows:
+// lengths that are and aren't multiples of the vector widths, rows starting at any offset, with and without a prior row.
+
+#include "unfilter.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+namespace
+{
+
+	const char* level_name(fill::detail::SimdLevel level) noexcept
+	{
+		switch (level)
+		{
+		case fill::detail::SimdLevel::SSE2: return "SSE2";
+		case fill::detail::SimdLevel::SSSE3: return "SSSE3";
+		case fill::detail::SimdLevel::AVX2: return "AVX2";
+		default: return "Scalar";
+		}
+	}
+
+} // namespace
+
+
+int main()
+{
+	using fill::detail::SimdLevel;
+
+	std::mt19937 rng{ 2025 };
+	const SimdLevel supported{ fill::detail::detect_simd_level() };
+
+	// Short rows cover every tail, long ones the main loops. Pixels, not bytes
+	std::vector<size_t> widths{};
+	for (size_t width{ 1 }; width <= 80; width++)
+		widths.push_back(width);
+	for (const size_t width : { 127, 128, 129, 255, 256, 257, 1000, 1023, 4099 })
+		widths.push_back(width);
+
+	size_t checked{}, failed{};
+
+	for (int l{ static_cast<int>(SimdLevel::SSE2) }; l <= static_cast<int>(SimdLevel::AVX2); l++)
+	{
+		const SimdLevel level{ static_cast<SimdLevel>(l) };
+
+		if (level > supported)
+		{
+			std::cout << level_name(level) << ": not supported here, skipped\n";
+			continue;
+		}
+
+		for (size_t bpp{ 1 }; bpp <= 8; bpp++)
+		{
+			const fill::detail::UnfilterKernels reference{ fill::detail::unfilter_kernels(SimdLevel::Scalar, bpp) };
+			const fill::detail::UnfilterKernels kernels{ fill::detail::unfilter_kernels(level, bpp) };
+
+			for (const size_t width : widths)
+			{
+				const size_t width_bytes{ width * bpp };
+				const size_t offset{ rng() % 32 }; /*rows are rarely aligned: they follow the filter byte*/
+
+				std::vector<std::uint8_t> filtered(width_bytes + offset), prior(width_bytes + offset);
+				std::vector<std::uint8_t> expected(width_bytes + offset), current(width_bytes + offset);
+
+				for (std::uint8_t& byte : filtered)
+					byte = static_cast<std::uint8_t>(rng());
+				for (std::uint8_t& byte : prior)
+					byte = static_cast<std::uint8_t>(rng());
+
+				for (std::uint8_t filter{}; filter <= 4; filter++)
+				{
+					for (const bool first_row : { false, true })
+					{
+						const std::uint8_t* above{ first_row ? nullptr : prior.data() + offset };
+
+						fill::detail::unfilter_row(reference, filter, filtered.data() + offset, above, expected.data() + offset, width_bytes, bpp);
+						fill::detail::unfilter_row(kernels, filter, filtered.data() + offset, above, current.data() + offset, width_bytes, bpp);
+
+						checked++;
+
+						if (current != expected)
+						{
+							if (failed++ < 20)
+								std::cout << "MISMATCH " << level_name(level) << " filter " << int{ filter } << " bpp " << bpp << " width " << width
+									<< (first_row ? " (first row)" : "") << '\n';
+						}
+					}
+				}
+			}
+		}
+	}
+
+	std::cout << checked << " rows checked, " << failed << " mismatches\n";
+
+	return failed == 0 ? 0 : 1;
+}